@@ -52,6 +52,7 @@ int main() {
     // -------------------------------
     std::shared_ptr<OrbWrapper> orb = OrbWrapper::create(300, 1.2f, 4, 30, 0, 2, cv::ORB::FAST_SCORE, 32, 30); 
     std::shared_ptr<Feature::FeatureFinder> featureFinder = Feature::FeatureFinder::create(orb);
+    featureFinder->setVerification(true); // only forward-backward consistent tracks reach solvePose2D_GN
     std::shared_ptr<Estimation::Poser::PoseEstimator2d> poseEstimator = Estimation::Poser::PoseEstimator2d::create();
     Estimation::Poser::Pose2D relPose;
     std::vector<Eigen::Vector2d> pts_prev, pts_curr;
@@ -107,7 +108,9 @@ int main() {
                     return poseEstimator->solvePose2D_GN(pts_prev, pts_curr, relPose);
                 });
 
-                std::cout << "[POSE] Δx=" << relPose.pos.x()
+                // relPose is written by the task, wait for it before reading.
+                if (poseFuture.get())
+                    std::cout << "[POSE] Δx=" << relPose.pos.x()
                     << " Δy=" << relPose.pos.y()
                     << " Δθ=" << relPose.pos.z() 
                     << "\n";
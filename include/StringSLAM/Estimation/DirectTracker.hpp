@@ -0,0 +1,198 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+#include "StringSLAM/core/CameraModels.hpp"
+#include "StringSLAM/core/Map.hpp"
+
+namespace StringSLAM::Estimation
+{
+    /**
+     * @brief Outcome of a semi-direct tracking attempt.
+     */
+    struct DirectResult {
+        /// Recovered pose (T_world_camera)
+        SE3 pose;
+
+        /// Reference points inside the image at the finest aligned level
+        int aligned = 0;
+
+        /// Refined features kept by the pose refinement
+        int inliers = 0;
+
+        /// Mean absolute patch residual at the finest aligned level (gray levels)
+        double photometricError = 0.0;
+
+        /// Landmark of every inlier
+        std::vector<int> landmarks;
+
+        /// Refined image position of every inlier (raw pixels)
+        std::vector<cv::Point2f> points;
+    };
+
+    /**
+     * @brief Semi-direct frame-to-keyframe tracking on image intensities.
+     *
+     * The reference points are the keypoints of the last keyframe that carry a
+     * landmark (corners, so high-gradient pixels with a known depth), kept when
+     * their patch gradient is strong enough. For each of them a 4x4 patch is
+     * sampled on every pyramid level, together with its Jacobian w.r.t. the
+     * pose. Both stay constant (inverse compositional), so a frame costs a
+     * gray pyramid and the patch reads only, no features and no descriptors.
+     *
+     * track() then runs, coarse to fine:
+     * - Sparse image alignment: Gauss-Newton on the relative pose minimizing
+     *   the Huber-weighted difference between the reference patches and the
+     *   current image at their warped positions. Patches are compared zero-mean,
+     *   so a per-patch brightness change (auto exposure) does not bias the pose.
+     * - Feature refinement: each point is aligned alone on the finest level with
+     *   an 8x8 patch and a brightness offset, within refineRadius of the aligned
+     *   projection.
+     * - Pose refinement: Gauss-Newton on the reprojection error of the refined
+     *   features, which then count as inliers within reprojError.
+     *
+     * Descriptors are only needed for keyframes and relocalization. Images
+     * must be raw images of the CameraModel, the distortion is applied when
+     * projecting.
+     */
+    class DirectTracker
+    {
+    private:
+        CameraModel cm;
+        int levels;
+        int minLevel;
+        size_t maxPoints;
+
+        // Gauss-Newton iterations per level.
+        int iterations = 30;
+
+        // Photometric Huber threshold (gray levels).
+        float huber = 12.0f;
+
+        // Mean gradient magnitude a reference patch needs (gray levels per pixel).
+        float minGradient = 6.0f;
+
+        // Points and inliers needed to accept a pose.
+        int minPoints = 20;
+
+        // Largest correction of a refined feature (px).
+        float refineRadius = 3.0f;
+
+        // Reprojection threshold of the pose refinement (px).
+        float reprojError = 2.5f;
+
+        // -- Below are private variables not specified but used in class. --
+        static constexpr int PATCH = 4;
+        static constexpr int REFINE_PATCH = 8;
+
+        // Batch projection of the raw images, the scratch is reused across calls.
+        PinholeRadTanModel model;
+        mutable Points3 batchPoints;
+        mutable Points2 batchPixels;
+        mutable ProjectionJacobians batchJacobians;
+        mutable std::vector<uint8_t> batchValid;
+
+        // Reference keyframe pose (T_world_reference).
+        SE3 refPose;
+
+        // A reference point: landmark, position in the reference camera, raw pixel on level 0.
+        struct Point {
+            int landmark;
+            Eigen::Vector3d pos;
+            cv::Point2f center;
+        };
+        std::vector<Point> points;
+
+        // Per level, PATCH * PATCH entries per point.
+        struct LevelPatches {
+            std::vector<float> intensity;
+            std::vector<Eigen::Matrix<float, 6, 1>> jacobian;
+            std::vector<Eigen::Matrix<float, 6, 6>> hessian;
+            std::vector<uint8_t> valid;
+        };
+        std::vector<LevelPatches> patches;
+
+        // Level 0 refinement patches, REFINE_PATCH * REFINE_PATCH entries per point.
+        std::vector<float> refineIntensity, refineGx, refineGy;
+        std::vector<Eigen::Matrix3f> refineHinv;
+        std::vector<uint8_t> refineValid;
+
+        // Gray pyramid of the image being processed.
+        std::vector<cv::Mat> pyramid;
+        cv::Mat gray;
+
+        bool buildPyramid(const cv::Mat &img);
+        void projectPoints(const SE3 &T) const;
+        void alignLevel(int level, SE3 &T, int &visible, double &error) const;
+        bool refineFeature(size_t i, cv::Point2f &u) const;
+        int refinePose(SE3 &T, const std::vector<size_t> &idx, const std::vector<cv::Point2f> &pred, const std::vector<cv::Point2f> &meas,
+            std::vector<uint8_t> &inlier) const;
+
+    public:
+        /**
+         * @brief Construct DirectTracker
+         * @param cm_ CameraModel of the images
+         * @param levels_ Pyramid levels, alignment starts on the coarsest
+         * @param minLevel_ Finest level of the sparse image alignment
+         * @param maxPoints_ Reference points kept, strongest gradient first
+         */
+        explicit DirectTracker(const CameraModel &cm_, int levels_ = 4, int minLevel_ = 1, size_t maxPoints_ = 300);
+        ~DirectTracker() = default;
+
+        /**
+         * @brief Set the reference keyframe.
+         * @param kf Keyframe with image, keypoints and pose
+         * @param kpLandmark Landmark of every keypoint (-1 if none)
+         * @param map Map holding the landmarks
+         * @return Enough reference points to track
+         */
+        bool setReference(const Frame &kf, const std::vector<int> &kpLandmark, const Map &map);
+
+        /**
+         * @brief Track an image against the reference.
+         * @param img Raw image, GRAY8 or BGR
+         * @param prior Pose guess (T_world_camera), e.g. the previous pose
+         * @param res Result, pose valid when true is returned
+         * @return Pose found with at least minPoints inliers
+         */
+        bool track(const cv::Mat &img, const SE3 &prior, DirectResult &res);
+
+        /**
+         * @brief Drop the reference.
+         */
+        void reset();
+
+        /// @brief A reference is set.
+        inline bool hasReference() const { return !points.empty(); }
+
+        /// @brief Reference points.
+        inline size_t getPointCount() const { return points.size(); }
+
+        /// @brief Set the Gauss-Newton iterations per level.
+        inline void setIterations(int iterations_) { iterations = std::max(1, iterations_); }
+
+        /// @brief Set the points and inliers needed to accept a pose.
+        inline void setMinPoints(int minPoints_) { minPoints = minPoints_; }
+
+        /// @brief Set the mean gradient magnitude a reference patch needs (gray levels per pixel).
+        inline void setMinGradient(float minGradient_) { minGradient = minGradient_; }
+
+        /**
+         * @brief Set the feature refinement limits.
+         * @param refineRadius_ Largest correction of a refined feature (px)
+         * @param reprojError_ Reprojection threshold of the pose refinement (px)
+         */
+        inline void setRefinement(float refineRadius_, float reprojError_) {
+            refineRadius = refineRadius_;
+            reprojError = reprojError_;
+        }
+
+        /**
+         * @brief Create Shared Pointer of DirectTracker object
+         * @return Shared Pointer of DirectTracker
+         */
+        static std::shared_ptr<DirectTracker> create(const CameraModel &cm_, int levels_ = 4, int minLevel_ = 1, size_t maxPoints_ = 300) {
+            return std::make_shared<DirectTracker>(cm_, levels_, minLevel_, maxPoints_);
+        }
+    };
+
+} // namespace StringSLAM::Estimation
@@ -0,0 +1,278 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+#include "StringSLAM/Estimation/Poser/PoseEstimator2d.hpp"
+#include <deque>
+#include <mutex>
+#include <string>
+#include <eigen3/Eigen/Eigen>
+
+namespace StringSLAM::Estimation
+{
+    /**
+     * @brief A single IMU sample.
+     */
+    struct ImuMeasurement {
+        /// Timestamp on the same clock as Frame::timestamp
+        std::chrono::system_clock::time_point timestamp;
+
+        /// Linear acceleration (m/s^2) in the IMU frame
+        Eigen::Vector3d acc = Eigen::Vector3d::Zero();
+
+        /// Angular velocity (rad/s) in the IMU frame
+        Eigen::Vector3d gyro = Eigen::Vector3d::Zero();
+    };
+
+    /**
+     * @brief Accelerometer and gyroscope biases.
+     */
+    struct ImuBias {
+        /// Accelerometer bias (m/s^2)
+        Eigen::Vector3d acc = Eigen::Vector3d::Zero();
+
+        /// Gyroscope bias (rad/s)
+        Eigen::Vector3d gyro = Eigen::Vector3d::Zero();
+    };
+
+    /**
+     * @brief Continuous-time IMU noise densities, defaults are the EuRoC ADIS16448 values.
+     */
+    struct ImuNoise {
+        /// Gyroscope white noise (rad/s/sqrt(Hz))
+        double gyro = 1.6968e-04;
+
+        /// Accelerometer white noise (m/s^2/sqrt(Hz))
+        double acc = 2.0e-03;
+
+        /// Gyroscope random walk (rad/s^2/sqrt(Hz))
+        double gyroWalk = 1.9393e-05;
+
+        /// Accelerometer random walk (m/s^3/sqrt(Hz))
+        double accWalk = 3.0e-03;
+    };
+
+    /**
+     * @brief Navigation state of the IMU body in the world frame.
+     */
+    struct ImuState {
+        /// Body -> world rotation
+        SO3 R;
+
+        /// Position in world
+        Eigen::Vector3d p = Eigen::Vector3d::Zero();
+
+        /// Velocity in world
+        Eigen::Vector3d v = Eigen::Vector3d::Zero();
+
+        /// Biases used when integrating
+        ImuBias bias;
+    };
+
+    /**
+     * @brief A thread-safe queue of IMU samples, consumed frame interval by frame interval.
+     */
+    class ImuQueue
+    {
+    private:
+        std::deque<ImuMeasurement> queue;
+        mutable std::mutex mtx;
+
+    public:
+        ImuQueue() = default;
+        ~ImuQueue() = default;
+
+        /**
+         * @brief Append a sample, samples must arrive in timestamp order.
+         * @param m IMU sample
+         */
+        void push(const ImuMeasurement &m);
+
+        /**
+         * @brief Get the samples covering [t0, t1].
+         *
+         * Returns the last sample at or before t0 followed by every sample up to t1.
+         * Samples that can no longer be needed are removed.
+         * @param t0 Previous frame timestamp
+         * @param t1 Current frame timestamp
+         * @param out Samples covering the interval
+         * @return The queue already reaches t1
+         */
+        bool getInterval(const std::chrono::system_clock::time_point &t0, const std::chrono::system_clock::time_point &t1,
+            std::vector<ImuMeasurement> &out);
+
+        /// @brief Samples currently queued.
+        size_t size() const;
+
+        /**
+         * @brief Load a EuRoC imu0/data.csv file into the queue.
+         * @param path CSV path (timestamp [ns], w_xyz [rad/s], a_xyz [m/s^2])
+         * @return Samples loaded
+         */
+        size_t loadEuRoC(const std::string &path);
+
+        /**
+         * @brief Create Shared Pointer of ImuQueue object
+         * @return Shared Pointer of ImuQueue
+         */
+        static std::shared_ptr<ImuQueue> create() {
+            return std::make_shared<ImuQueue>();
+        }
+    };
+
+    /**
+     * @brief On-manifold preintegrated IMU motion between two frames.
+     *
+     * Holds the relative rotation, velocity and position deltas in the frame of the
+     * first IMU pose, their covariance (order: rotation, velocity, position) and the
+     * first order bias Jacobians so small bias updates do not need a re-integration.
+     */
+    struct ImuPreintegration {
+        /// Bias the deltas were integrated with
+        ImuBias bias;
+
+        /// Integrated time (s)
+        double dt = 0.0;
+
+        /// Rotation delta
+        SO3 dR;
+
+        /// Velocity delta
+        Eigen::Vector3d dV = Eigen::Vector3d::Zero();
+
+        /// Position delta
+        Eigen::Vector3d dP = Eigen::Vector3d::Zero();
+
+        /// Covariance of (dR, dV, dP)
+        Eigen::Matrix<double, 9, 9> cov = Eigen::Matrix<double, 9, 9>::Zero();
+
+        /// Bias Jacobians
+        Eigen::Matrix3d JRg = Eigen::Matrix3d::Zero();
+        Eigen::Matrix3d JVg = Eigen::Matrix3d::Zero();
+        Eigen::Matrix3d JVa = Eigen::Matrix3d::Zero();
+        Eigen::Matrix3d JPg = Eigen::Matrix3d::Zero();
+        Eigen::Matrix3d JPa = Eigen::Matrix3d::Zero();
+
+        /**
+         * @brief Clear the deltas.
+         * @param b Bias for the next integration
+         */
+        void reset(const ImuBias &b = ImuBias());
+
+        /**
+         * @brief Integrate one sample held constant over dt_.
+         * @param acc Measured acceleration
+         * @param gyro Measured angular velocity
+         * @param dt_ Duration (s)
+         * @param noise Noise densities
+         */
+        void integrate(const Eigen::Vector3d &acc, const Eigen::Vector3d &gyro, double dt_, const ImuNoise &noise);
+
+        /**
+         * @brief Rotation delta corrected for a new gyroscope bias.
+         * @param b New bias
+         * @return Corrected rotation delta
+         */
+        SO3 getDeltaR(const ImuBias &b) const;
+
+        /**
+         * @brief Predict the state at the end of the interval.
+         * @param s State at the start of the interval
+         * @param gravity Gravity in world
+         * @return Predicted state
+         */
+        ImuState predict(const ImuState &s, const Eigen::Vector3d &gravity) const;
+    };
+
+    /**
+     * @brief Builds IMU motion priors for visual tracking.
+     *
+     * Preintegrates the IMU between two frame timestamps and turns the result into
+     * the priors the vision front end consumes: a camera rotation, keypoint
+     * predictions to seed FeatureFinder::matchFramesLK(), and a Pose2D prior for
+     * PoseEstimator2d::solvePose2D_GN_Prior().
+     */
+    class ImuPreintegrator
+    {
+    private:
+        ImuNoise noise;
+
+        // Camera -> IMU rotation.
+        SO3 R_imu_cam;
+
+        ImuBias bias;
+
+    public:
+        /**
+         * @brief Construct a ImuPreintegrator.
+         * @param noise_ IMU noise densities
+         * @param R_imu_cam_ Camera -> IMU rotation
+         */
+        ImuPreintegrator(const ImuNoise &noise_ = ImuNoise(), const SO3 &R_imu_cam_ = SO3());
+        ~ImuPreintegrator() = default;
+
+        /**
+         * @brief Preintegrate every sample between two frames.
+         * @param queue IMU samples
+         * @param t0 Previous frame timestamp
+         * @param t1 Current frame timestamp
+         * @param out Preintegrated motion
+         * @return The IMU covers the interval
+         */
+        bool integrate(ImuQueue &queue, const std::chrono::system_clock::time_point &t0,
+            const std::chrono::system_clock::time_point &t1, ImuPreintegration &out) const;
+
+        /**
+         * @brief Rotation of the current camera expressed in the previous camera.
+         * @param pi Preintegrated motion
+         * @return R_prev_cur
+         */
+        SO3 getCameraRotation(const ImuPreintegration &pi) const;
+
+        /**
+         * @brief Seed the pose of the current frame from the previous one.
+         *
+         * Only the rotation is propagated, translation needs a velocity estimate
+         * and is left to the visual solve (use ImuPreintegration::predict() with a full state).
+         * @param T_world_prev Pose of the previous frame
+         * @param pi Preintegrated motion
+         * @return Predicted T_world_cur
+         */
+        SE3 predictCameraPose(const SE3 &T_world_prev, const ImuPreintegration &pi) const;
+
+        /**
+         * @brief Predict where keypoints move, assuming rotation dominates between frames.
+         * @param cI Camera intrinsics
+         * @param R_prev_cur Camera rotation from getCameraRotation()
+         * @param kp Keypoints of the previous frame
+         * @param predicted Predicted positions in the current frame
+         */
+        void predictKeypoints(const CameraIntrinsic &cI, const SO3 &R_prev_cur,
+            const std::vector<cv::KeyPoint> &kp, std::vector<cv::Point2f> &predicted) const;
+
+        /**
+         * @brief Predict the image-plane motion estimated by PoseEstimator2d.
+         * @param cI Camera intrinsics
+         * @param R_prev_cur Camera rotation from getCameraRotation()
+         * @return Pose2D prior (previous -> current pixels)
+         */
+        Poser::Pose2D predictPose2D(const CameraIntrinsic &cI, const SO3 &R_prev_cur) const;
+
+        /**
+         * @brief Set the bias used for integration (e.g. from an estimator).
+         * @param bias_ Bias
+         */
+        inline void setBias(const ImuBias &bias_) { bias = bias_; }
+
+        /// @brief Bias used for integration.
+        inline ImuBias getBias() const { return bias; }
+
+        /**
+         * @brief Create Shared Pointer of ImuPreintegrator object
+         * @return Shared Pointer of ImuPreintegrator
+         */
+        static std::shared_ptr<ImuPreintegrator> create(const ImuNoise &noise_ = ImuNoise(), const SO3 &R_imu_cam_ = SO3()) {
+            return std::make_shared<ImuPreintegrator>(noise_, R_imu_cam_);
+        }
+    };
+
+} // namespace StringSLAM::Estimation
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+#include "StringSLAM/core/Map.hpp"
+#include "StringSLAM/Utils/ThreadPool.hpp"
+#include <chrono>
+
+namespace StringSLAM::Estimation
+{
+    /**
+     * @brief Outcome of a monocular initialization.
+     */
+    struct InitResult {
+        /// Pose of the current frame in the reference frame (T_ref_cur), median depth is 1
+        SE3 T_ref_cur;
+
+        /// Triangulated points in the reference camera frame
+        std::vector<cv::Point3f> points;
+
+        /// Index into the input matches of every point
+        std::vector<int> matchIdx;
+
+        /// Landmark IDs of every point, filled when a Map was given
+        std::vector<int> landmarkIds;
+
+        /// The homography model was selected (planar or low-parallax scene)
+        bool homography = false;
+
+        /// Parallax reached by the weakest of the minTriangulated best points (deg)
+        double parallax = 0.0;
+
+        /// Hypotheses drawn per model
+        int iterations = 0;
+    };
+
+    /**
+     * @brief Bootstraps a 3D Map from two monocular frames.
+     *
+     * An essential matrix (5-point solver) and a homography (4-point solver) are
+     * estimated side by side with PROSAC: matches are ordered by descriptor
+     * distance and the samples grow from the best matches towards the whole set.
+     * Each batch of hypotheses is scored on a ThreadPool with a symmetric
+     * chi-square score, and sampling stops once the best model of each kind
+     * reaches the requested confidence or the time budget runs out.
+     *
+     * The model with the larger share of the score is decomposed into motion
+     * candidates. Every candidate is triangulated, and points failing
+     * cheirality, reprojection or parallax checks are rejected. The winning
+     * candidate must clearly beat the others, and enough points must see
+     * sufficient parallax. Otherwise the frames are rejected and the caller
+     * tries again with a later frame.
+     *
+     * Keypoints are read through Frame::undistorted(), so either the image or
+     * the keypoints must be undistorted (MonoTracker::undistort()).
+     */
+    class Initializer
+    {
+    private:
+        CameraIntrinsic cI;
+        std::shared_ptr<Utils::ThreadPool> pool;
+
+        // Hypotheses drawn per model at most.
+        int maxIterations = 200;
+
+        // Wall-clock budget of initialize(), one frame at 30 fps.
+        std::chrono::microseconds timeBudget{33000};
+
+        // Keypoint noise (px).
+        double sigma = 1.0;
+
+        // Confidence used for early termination.
+        double confidence = 0.99;
+
+        // Parallax the minTriangulated best points must reach (deg).
+        double minParallax = 1.0;
+
+        // Points needed to accept an initialization.
+        int minTriangulated = 50;
+
+        // Homography is selected when its share of the combined score is above this.
+        double homographyRatio = 0.45;
+
+        // Hypotheses per batch, 0 uses two per pool thread.
+        size_t batchSize = 0;
+
+        // Seed of the PROSAC sampler, results are reproducible for a given seed.
+        uint64_t seed = 0x5eedULL;
+
+    public:
+        /**
+         * @brief Construct Initializer
+         * @param cI_ Intrinsics of the (undistorted) camera
+         * @param pool_ Pool hypotheses are scored on, nullptr creates one
+         */
+        Initializer(const CameraIntrinsic &cI_, std::shared_ptr<Utils::ThreadPool> pool_ = nullptr);
+        ~Initializer() = default;
+
+        /**
+         * @brief Recover the relative motion and structure of two frames.
+         * @param ref Reference frame, its pose anchors the map
+         * @param cur Current frame, its pose is set on success
+         * @param matches queryIdx indexes ref.kp, trainIdx cur.kp, lower distance is better
+         * @param result Motion and triangulated points
+         * @return Initialization accepted
+         */
+        bool initialize(const Frame &ref, Frame &cur, const std::vector<cv::DMatch> &matches, InitResult &result) const;
+
+        /**
+         * @brief Initialize and insert both frames as keyframes and the points as landmarks.
+         *
+         * Landmarks take their descriptor from the reference keyframe.
+         * @param ref Reference frame, its pose anchors the map
+         * @param cur Current frame, its pose is set on success
+         * @param matches queryIdx indexes ref.kp, trainIdx cur.kp, lower distance is better
+         * @param map Map to fill
+         * @param result Motion, triangulated points and their landmark IDs
+         * @return Initialization accepted
+         */
+        bool initialize(const Frame &ref, Frame &cur, const std::vector<cv::DMatch> &matches, Map &map, InitResult &result) const;
+
+        /**
+         * @brief Set the hypotheses drawn per model at most.
+         * @param maxIterations_ Iterations
+         */
+        inline void setMaxIterations(int maxIterations_) { maxIterations = std::max(1, maxIterations_); }
+
+        /**
+         * @brief Set the wall-clock budget, sampling stops early to stay within it.
+         * @param timeBudget_ Budget (e.g. one frame time)
+         */
+        inline void setTimeBudget(std::chrono::microseconds timeBudget_) { timeBudget = timeBudget_; }
+
+        /**
+         * @brief Set the keypoint noise the inlier thresholds are derived from.
+         * @param sigma_ Standard deviation (px)
+         */
+        inline void setSigma(double sigma_) { sigma = sigma_; }
+
+        /**
+         * @brief Set the acceptance criteria.
+         * @param minTriangulated_ Points needed
+         * @param minParallax_ Parallax the minTriangulated best points must reach (deg)
+         */
+        inline void setAcceptance(int minTriangulated_, double minParallax_) {
+            minTriangulated = std::max(1, minTriangulated_);
+            minParallax = minParallax_;
+        }
+
+        /**
+         * @brief Set the hypotheses scored per parallel batch.
+         * @param batchSize_ Hypotheses, 0 uses two per pool thread
+         */
+        inline void setBatchSize(size_t batchSize_) { batchSize = batchSize_; }
+
+        /**
+         * @brief Set the seed of the PROSAC sampler.
+         * @param seed_ Seed
+         */
+        inline void setSeed(uint64_t seed_) { seed = seed_; }
+
+        /**
+         * @brief Create Shared Pointer of Initializer object
+         * @return Shared Pointer of Initializer
+         */
+        static std::shared_ptr<Initializer> create(const CameraIntrinsic &cI_, std::shared_ptr<Utils::ThreadPool> pool_ = nullptr) {
+            return std::make_shared<Initializer>(cI_, pool_);
+        }
+    };
+
+} // namespace StringSLAM::Estimation
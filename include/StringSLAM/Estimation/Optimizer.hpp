@@ -0,0 +1,171 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+#include "StringSLAM/core/Map.hpp"
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <eigen3/Eigen/Eigen>
+#include <eigen3/Eigen/SparseCholesky>
+
+namespace StringSLAM::Estimation
+{
+    /**
+     * @brief A relative pose constraint between two keyframes.
+     */
+    struct PoseGraphEdge {
+        /// Keyframe IDs
+        int from = -1, to = -1;
+
+        /// Measured T_from_to
+        Sim3 measurement;
+
+        /// Information of the residual (translation, rotation, log scale)
+        Eigen::Matrix<double, 7, 7> information = Eigen::Matrix<double, 7, 7>::Identity();
+
+        /// Loop closure (true) or odometry (false)
+        bool loop = false;
+    };
+
+    /**
+     * @brief SE(3)/Sim(3) pose-graph optimization over keyframe poses.
+     *
+     * Vertices are T_world_keyframe, edges relative constraints from odometry and
+     * loop closures. Gauss-Newton runs on a sparse block Cholesky (SimplicialLDLT).
+     * This is a batch solver: every iteration rebuilds the system and factorizes
+     * it in full. Only the symbolic analysis is kept between iterations and
+     * solves while the block pattern is unchanged, a new loop edge links two new
+     * blocks and so triggers a full symbolic and numeric factorization. Every
+     * solve is warm started from the last estimate, which keeps the iteration
+     * count low after a single loop closure.
+     *
+     * optimizeAsync() solves a snapshot on a background thread. Tracking may keep
+     * adding vertices and edges meanwhile, vertices added after the snapshot are
+     * moved with the correction of the newest optimized vertex.
+     */
+    class PoseGraph
+    {
+    private:
+        struct Vertex {
+            Sim3 pose;
+            bool fixed = false;
+        };
+
+        struct Problem {
+            std::map<int, Vertex> vertices;
+            std::vector<PoseGraphEdge> edges;
+        };
+
+        // Optimize scale too (Sim(3)) or keep it at 1 (SE(3)).
+        bool estimateScale;
+
+        Problem graph;
+        mutable std::mutex mtx;
+
+        // -- Below are private variables not specified but used in class. --
+        // Solver state, only touched by the thread currently solving.
+        Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver;
+        std::vector<std::pair<int, int>> pattern;
+        std::mutex solveMtx;
+
+        std::thread worker;
+        std::atomic<bool> running{false};
+
+        int solve(Problem &p, int iterations);
+        void publish(const Problem &p);
+
+    public:
+        /**
+         * @brief Construct PoseGraph
+         * @param estimateScale_ Optimize scale as well (monocular), SE(3) otherwise
+         */
+        explicit PoseGraph(bool estimateScale_ = false);
+        ~PoseGraph();
+
+        PoseGraph(const PoseGraph &) = delete;
+        PoseGraph &operator=(const PoseGraph &) = delete;
+
+        /**
+         * @brief Add or update a keyframe pose.
+         * @param id Keyframe ID
+         * @param pose T_world_keyframe
+         * @param fixed Hold the pose constant (gauge)
+         */
+        void addVertex(int id, const SE3 &pose, bool fixed = false);
+
+        /**
+         * @brief Add an odometry constraint.
+         * @param from Keyframe ID
+         * @param to Keyframe ID
+         * @param T_from_to Relative pose
+         * @param information 6x6 information of (translation, rotation)
+         */
+        void addOdometryEdge(int from, int to, const SE3 &T_from_to,
+            const Eigen::Matrix<double, 6, 6> &information = Eigen::Matrix<double, 6, 6>::Identity());
+
+        /**
+         * @brief Add a loop closure constraint.
+         * @param from Keyframe ID
+         * @param to Keyframe ID
+         * @param S_from_to Relative similarity, scale is ignored without estimateScale
+         * @param information 7x7 information of (translation, rotation, log scale)
+         */
+        void addLoopEdge(int from, int to, const Sim3 &S_from_to,
+            const Eigen::Matrix<double, 7, 7> &information = Eigen::Matrix<double, 7, 7>::Identity());
+
+        /**
+         * @brief Add every keyframe of a Map, linked to its spanning tree parent (or the previous keyframe).
+         * @param map Map
+         */
+        void addKeyframes(const Map &map);
+
+        /**
+         * @brief Optimize on the calling thread.
+         * @param iterations Maximum Gauss-Newton iterations
+         * @return Iterations run (0 when there is nothing to optimize)
+         */
+        int optimize(int iterations = 10);
+
+        /**
+         * @brief Optimize a snapshot on a background thread.
+         * @param iterations Maximum Gauss-Newton iterations
+         * @param done Called on the worker thread once the result is published
+         * @return Started (false while a previous run is still going)
+         */
+        bool optimizeAsync(int iterations = 10, std::function<void()> done = nullptr);
+
+        /// @brief A background optimization is running.
+        inline bool isOptimizing() const { return running; }
+
+        /// @brief Block until the background optimization finished.
+        void wait();
+
+        /**
+         * @brief Get an optimized keyframe pose.
+         * @param id Keyframe ID
+         * @param pose T_world_keyframe
+         * @return Keyframe exists
+         */
+        bool getPose(int id, Sim3 &pose) const;
+
+        /**
+         * @brief Write the optimized poses back into a Map.
+         *
+         * Keyframe poses are replaced, landmarks move with the correction of the
+         * first keyframe observing them.
+         * @param map Map
+         */
+        void apply(Map &map) const;
+
+        /**
+         * @brief Create Shared Pointer of PoseGraph object
+         * @return Shared Pointer of PoseGraph
+         */
+        static std::shared_ptr<PoseGraph> create(bool estimateScale_ = false) {
+            return std::make_shared<PoseGraph>(estimateScale_);
+        }
+    };
+
+} // namespace StringSLAM::Estimation
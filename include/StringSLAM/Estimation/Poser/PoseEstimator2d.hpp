@@ -1,4 +1,5 @@
 #pragma once
+#include "StringSLAM/core/Lie.hpp"
 #include "opencv2/core/types.hpp"
 #include <eigen3/Eigen/Eigen>
 #include <eigen3/Eigen/src/Core/Matrix.h>
@@ -10,7 +11,7 @@ namespace StringSLAM::Estimation::Poser
      */
     struct Pose2D {
         /// @brief Vector for holding the: X, & Y coordinate, aswell as theta.
-        Eigen::Vector3f pos;
+        Eigen::Vector3d pos = Eigen::Vector3d::Zero();
 
         /**
          * @brief Return theta
@@ -21,15 +22,14 @@ namespace StringSLAM::Estimation::Poser
             return pos.z();
         }
         
+        /// @brief Return our position as a SE2 transform
+        SE2 toSE2() const {
+            return SE2(pos.z(), pos.head<2>());
+        }
+
         /// @brief Return our position as a matrix
         Eigen::Matrix3d matrix() const {
-            Eigen::Matrix3d T = Eigen::Matrix3d::Identity();
-            double c = cos(pos.z());
-            double s = sin(pos.z());
-
-            T(0,0) = c; T(0,1) = -s; T(0,2) = pos.x();
-            T(1,0) = s; T(1,1) =  c; T(1,2) = pos.y();
-            return T;
+            return toSE2().matrix();
         }
     };
 
@@ -40,6 +40,13 @@ namespace StringSLAM::Estimation::Poser
      */
     class PoseEstimator2d
     {
+        private:
+        // Shared solver, prior is optional (nullptr).
+        bool solve(const std::vector<Eigen::Vector2d> &pts_p, const std::vector<Eigen::Vector2d> &pts_q,
+            const Pose2D *prior, const Eigen::Vector3d &priorInfo,
+            Pose2D &pose, int max_iters, double tol, bool useLM, double init_damping
+        );
+
         public:
         PoseEstimator2d() = default;
         ~PoseEstimator2d() = default;
@@ -76,6 +83,19 @@ namespace StringSLAM::Estimation::Poser
             bool useLM = true, double init_damping = 1e-3
         );
         
+        /**
+         * @brief Gauss-Newton with a motion prior (loose fusion, e.g. from ImuPreintegrator).
+         *
+         * Adds the residual priorInfo * (pose - prior) to the point residuals.
+         * pose is used as the initial guess, seeding it with the prior converges fastest.
+         * @param priorInfo Diagonal information (inverse variance) of x, y, theta
+         */
+        bool solvePose2D_GN_Prior(const std::vector<Eigen::Vector2d> &pts_p, const std::vector<Eigen::Vector2d> &pts_q,
+            const Pose2D &prior, const Eigen::Vector3d &priorInfo,
+            Pose2D &pose, int max_iters = 50, double tol = 1e-6, 
+            bool useLM = true, double init_damping = 1e-3
+        );
+
         /**
          * @brief Create Shared Pointer of PoseEstimator2d object
          * @return Shared Pointer of PoseEstimator2d
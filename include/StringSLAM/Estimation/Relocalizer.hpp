@@ -0,0 +1,115 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+#include "StringSLAM/core/Map.hpp"
+#include "StringSLAM/Utils/ThreadPool.hpp"
+#include <atomic>
+#include <mutex>
+
+namespace StringSLAM::Estimation
+{
+    /**
+     * @brief Outcome of a relocalization attempt.
+     */
+    struct RelocResult {
+        /// Keyframe the frame was localized against (-1 if none)
+        int keyframeId = -1;
+
+        /// Recovered pose (T_world_camera)
+        SE3 pose;
+
+        /// PnP inliers after refinement
+        int inliers = 0;
+    };
+
+    /**
+     * @brief Recovers the camera pose against a Map after tracking is lost.
+     *
+     * The frame descriptors are looked up in the Map's landmark word index, and
+     * the landmarks they hit vote for the keyframes observing them, so the cost
+     * does not grow with the map. The best keyframes are then verified in
+     * parallel: the frame is matched against each keyframe's landmarks, a RANSAC
+     * PnP solve is run, and the inliers are refined with LM.
+     * The first candidate that reaches the inlier threshold wins, and the
+     * remaining candidates are skipped.
+     *
+     * The Map must not be modified during relocalize().
+     */
+    class Relocalizer
+    {
+    private:
+        std::shared_ptr<Map> map;
+        CameraIntrinsic cI;
+        std::shared_ptr<Utils::ThreadPool> pool;
+
+        // Keyframes verified per attempt.
+        size_t maxCandidates = 8;
+
+        // Inliers needed to accept a pose.
+        int minInliers = 30;
+
+        // RANSAC iterations per candidate.
+        int ransacIterations = 100;
+
+        // RANSAC reprojection threshold (px).
+        float reprojError = 4.0f;
+
+        // Descriptor matching thresholds.
+        int maxDistance = 64;
+        float ratio = 0.8f;
+
+        // -- Below are private variables not specified but used in class. --
+        // Verify one candidate keyframe, returns true when the pose is accepted.
+        bool verify(const Frame &f, int kfId, RelocResult &out) const;
+
+    public:
+        /**
+         * @brief Construct Relocalizer
+         * @param map_ Map to localize against
+         * @param cI_ Intrinsics of the (undistorted) camera
+         * @param pool_ Pool candidates are verified on, nullptr creates one with 2 workers
+         */
+        Relocalizer(std::shared_ptr<Map> map_, const CameraIntrinsic &cI_, std::shared_ptr<Utils::ThreadPool> pool_ = nullptr);
+        ~Relocalizer() = default;
+
+        /**
+         * @brief Localize a frame against the map.
+         * @param f Frame with keypoints and descriptors, its pose is set on success
+         * @param result Details of the accepted pose
+         * @return Pose recovered
+         */
+        bool relocalize(Frame &f, RelocResult &result) const;
+
+        /**
+         * @brief Set how many keyframes are verified per attempt.
+         * @param maxCandidates_ Keyframes
+         */
+        inline void setMaxCandidates(size_t maxCandidates_) { maxCandidates = maxCandidates_; }
+
+        /**
+         * @brief Set the inliers needed to accept a pose.
+         * @param minInliers_ Inliers
+         */
+        inline void setMinInliers(int minInliers_) { minInliers = minInliers_; }
+
+        /**
+         * @brief Set RANSAC parameters.
+         * @param iterations RANSAC iterations per candidate
+         * @param reprojError_ Reprojection threshold (px)
+         */
+        inline void setRansac(int iterations, float reprojError_) {
+            ransacIterations = iterations;
+            reprojError = reprojError_;
+        }
+
+        /**
+         * @brief Create Shared Pointer of Relocalizer object
+         * @return Shared Pointer of Relocalizer
+         */
+        static std::shared_ptr<Relocalizer> create(std::shared_ptr<Map> map_, const CameraIntrinsic &cI_,
+            std::shared_ptr<Utils::ThreadPool> pool_ = nullptr) {
+            return std::make_shared<Relocalizer>(map_, cI_, pool_);
+        }
+    };
+
+} // namespace StringSLAM::Estimation
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "StringSLAM/core.hpp"
+#include "StringSLAM/core/Pipeline.hpp"
 namespace StringSLAM::Feature
 {
     /**
@@ -8,25 +9,38 @@ namespace StringSLAM::Feature
      * 
      * A Class Utility meant to be used to find keypoints and descriptors in a frame.
      * Also, to match descriptors between 2 frames
+     *
+     * Runtime-configurable wrapper of Pipeline<Policy::OrbRuntime, Policy::BruteForce>,
+     * use Pipeline directly to fix the configuration at compile time.
      */
     class FeatureFinder
     {
     private:
-        // ORB object specified in contructor
-        std::shared_ptr<OrbWrapper> orb;
+        // Extraction and descriptor matching, built from the OrbWrapper specified in constructor
+        Pipeline<Policy::OrbRuntime, Policy::BruteForce> core;
 
         // -- Below are private variables not specified but used in class. --
 
-        // ---- Description Matcher ----
-        // Fast matching class provided by OpenCV
-        cv::Ptr<cv::BFMatcher> matcher;
-
-        // List of "KnnMatch", if your not familiar refer to google.
-        std::vector<std::vector<cv::DMatch>> knnMatches;
-
         // List of matches filtered from Knn.
         std::vector<cv::DMatch> matches;
 
+        // Forward-backward verification of LK tracks, see setVerification().
+        bool verify = false;
+        float maxRoundTrip = 0.5f;
+        float maxResidual = 20.0f;
+        float snapRadius = 2.0f;
+
+        // Pyramids shared by the forward and backward flow, snapping grid over f2 keypoints.
+        std::vector<cv::Mat> pyrPrev, pyrNext;
+        std::vector<int> gridStart, gridItems;
+
+        // Shared LK matcher, predicted is the optional initial flow.
+        const std::vector<cv::DMatch> matchLK(Frame &f1, Frame &f2, const std::vector<cv::Point2f> *predicted, cv::Size winSize, int maxLevel);
+
+        // Verified LK, appends the surviving tracks to matches.
+        void verifiedLK(Frame &f1, Frame &f2, const std::vector<cv::Point2f> &pointsPrev, std::vector<cv::Point2f> &pointsNext, int flags,
+            cv::Size winSize, int maxLevel, const cv::TermCriteria &criteria);
+
     public:
         /**
          * @brief Create constructor for FeatureFinder
@@ -65,6 +79,50 @@ namespace StringSLAM::Feature
          */
         const std::vector<cv::DMatch> matchFramesLK(Frame &f1, Frame &f2, cv::Size winSize = cv::Size(21, 21), int maxLevel = 3);
 
+        /**
+         * @brief Match descriptors from 2 frames using Lucas–Kanade seeded with predicted positions
+         *
+         * With a motion prior (e.g. ImuPreintegrator::predictKeypoints) the search starts
+         * close to the answer, so a smaller window and fewer pyramid levels suffice.
+         * @param f1 Frame 1
+         * @param f2 Frame 2
+         * @param predicted Predicted position in f2 of every keypoint of f1
+         * @param winSize ROI for matches.
+         * @param maxLevel Amount of pyramid levels applied to frames
+         */
+        const std::vector<cv::DMatch> matchFramesLK(Frame &f1, Frame &f2, const std::vector<cv::Point2f> &predicted,
+            cv::Size winSize = cv::Size(11, 11), int maxLevel = 1);
+
+        /**
+         * @brief Verify LK tracks before they become matches.
+         *
+         * By default matchFramesLK() keeps every point the flow reports as found
+         * and snaps it to the nearest f2 keypoint, however far. When enabled:
+         * - Both pyramids are built once and shared by a forward (f1 to f2) and
+         *   a backward (f2 to f1) flow over the forward survivors.
+         * - A track is dropped when it does not come back within maxRoundTrip_
+         *   of its origin, or when either direction's LK residual (mean absolute
+         *   window difference) exceeds maxResidual_.
+         * - The survivors snap to the nearest f2 keypoint within snapRadius_,
+         *   one track per keypoint.
+         *
+         * Fewer but clean correspondences, which is what solvePose2D_GN and the
+         * other outlier-free solvers expect.
+         * @param enabled Verify
+         * @param maxRoundTrip_ Largest forward-backward distance (px)
+         * @param maxResidual_ Largest LK residual (gray levels)
+         * @param snapRadius_ Largest snapping distance (px)
+         */
+        inline void setVerification(bool enabled, float maxRoundTrip_ = 0.5f, float maxResidual_ = 20.0f, float snapRadius_ = 2.0f) {
+            verify = enabled;
+            maxRoundTrip = maxRoundTrip_;
+            maxResidual = maxResidual_;
+            snapRadius = snapRadius_;
+        }
+
+        /// @brief LK tracks are forward-backward verified.
+        inline bool isVerifying() const { return verify; }
+
         /**
          * @brief Draw matches between 2 frames
          * @param frame1 Frame 1
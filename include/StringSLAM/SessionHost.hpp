@@ -0,0 +1,239 @@
+#pragma once
+
+#include "StringSLAM/System.hpp"
+#include <map>
+
+namespace StringSLAM
+{
+    /**
+     * @brief Read-only assets shared by every session of a process.
+     *
+     * Each asset is built once, on first request, and then handed out as a
+     * shared_ptr to const. Sessions with the same camera therefore share one
+     * UndistortLUT, and large assets such as vocabularies are loaded once
+     * instead of once per session.
+     */
+    class SharedAssets
+    {
+    private:
+        mutable std::mutex mtx;
+
+        // -- Below are private variables not specified but used in class. --
+        struct LutEntry {
+            CameraModel cm;
+            int step;
+            std::shared_ptr<const UndistortLUT> lut;
+        };
+
+        std::vector<LutEntry> luts;
+        std::map<std::string, std::shared_ptr<const void>> assets;
+
+    public:
+        SharedAssets() = default;
+        ~SharedAssets() = default;
+
+        /**
+         * @brief Get the keypoint undistortion table of a camera, building it on first use.
+         * @param cm CameraModel, capSize is the raw image size
+         * @param step LUT grid spacing (pixels)
+         * @return Table shared by every caller with the same model
+         */
+        std::shared_ptr<const UndistortLUT> getUndistortLUT(const CameraModel &cm, int step = 8);
+
+        /**
+         * @brief Get a named asset, building it on first use.
+         *
+         * make() runs once, under the cache lock, so concurrent sessions asking
+         * for the same asset wait for one load. A key always names the same type.
+         * @param key Asset name, e.g. the vocabulary path
+         * @param make Callable returning std::shared_ptr<T>
+         * @return Shared asset
+         */
+        template <class T, class F>
+        std::shared_ptr<const T> get(const std::string &key, F &&make) {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = assets.find(key);
+            if (it == assets.end()) it = assets.emplace(key, std::shared_ptr<const T>(make())).first;
+            return std::static_pointer_cast<const T>(it->second);
+        }
+
+        /// @brief Number of cached assets, tables included.
+        size_t size() const;
+
+        /**
+         * @brief Create Shared Pointer of SharedAssets object
+         * @return Shared Pointer of SharedAssets
+         */
+        static std::shared_ptr<SharedAssets> create() { return std::make_shared<SharedAssets>(); }
+    };
+
+    /**
+     * @brief Counters of one hosted session.
+     */
+    struct SessionStats {
+        /// Frames read from the source
+        uint64_t frames = 0;
+
+        /// Frames with a pose
+        uint64_t tracked = 0;
+
+        /// Time spent tracking (ms)
+        double busyMs = 0.0;
+
+        /// Source is exhausted
+        bool finished = false;
+
+        /// Session stopped on an exception
+        bool failed = false;
+    };
+
+    /**
+     * @brief Runs many independent tracking sessions in one process over one ThreadPool.
+     *
+     * A session is a System fed by a FrameSource. Sessions never share map
+     * state, only the read-only SharedAssets and the pool. Every session runs as
+     * a chain of small tasks: one task tracks up to `quantum` frames and then
+     * queues the next one behind the tasks of the other sessions. A long session
+     * therefore cannot starve a short one, a session is never tracked on two
+     * threads at once, and idle workers steal queued sessions, so aggregate
+     * throughput grows with the core count. The pool is also used by each
+     * System for initialization and relocalization, so one process uses one set
+     * of threads.
+     *
+     * @code
+     * SessionHost host;
+     * for (auto &log : logs) {
+     *     auto replay = Tracker::ReplayTracker::create(log, Tracker::ReplayTracker::Playback::MAX_SPEED);
+     *     replay->open();
+     *     host.addSession(replay->getCameraModel(0), [replay](Frame &f) { return replay->read(f); });
+     * }
+     * host.run();
+     * @endcode
+     */
+    class SessionHost
+    {
+    public:
+        /// Fills the next frame, false when the session is over
+        using FrameSource = std::function<bool(Frame &)>;
+
+        /// Receives every result with its session id, called concurrently from pool threads
+        using ResultSink = std::function<void(int, const TrackResult &)>;
+
+    private:
+        std::shared_ptr<Utils::ThreadPool> pool;
+        std::shared_ptr<SharedAssets> assets;
+
+        // -- Below are private variables not specified but used in class. --
+        struct Session {
+            int id;
+            std::shared_ptr<System> system;
+            FrameSource source;
+            Frame frame;
+            SessionStats stats;
+            bool scheduled = false;
+        };
+
+        // unique_ptr keeps a Session in place while its tasks run.
+        std::vector<std::unique_ptr<Session>> sessions;
+        mutable std::mutex mtx;
+        std::condition_variable doneCv;
+        size_t running = 0;
+        int quantum = 1;
+        ResultSink sink;
+
+        void schedule(Session &s);
+        void step(Session &s);
+
+    public:
+        /**
+         * @brief Construct SessionHost
+         * @param pool_ Pool shared by every session, nullptr creates one with every core
+         * @param assets_ Asset cache, nullptr creates one
+         * @param serialOpenCV Run OpenCV functions single threaded, the sessions already use every core
+         */
+        explicit SessionHost(std::shared_ptr<Utils::ThreadPool> pool_ = nullptr, std::shared_ptr<SharedAssets> assets_ = nullptr,
+            bool serialOpenCV = true);
+        ~SessionHost();
+
+        SessionHost(const SessionHost &) = delete;
+        SessionHost &operator=(const SessionHost &) = delete;
+
+        /**
+         * @brief Add a session, it starts with the next start().
+         * @param cm CameraModel of the source, the undistortion table comes from the shared assets
+         * @param source Frame source, called from pool threads but never concurrently for one session
+         * @param features ORB features per frame
+         * @return Session id
+         */
+        int addSession(const CameraModel &cm, FrameSource source, int features = 1000);
+
+        /**
+         * @brief Set the function receiving every result.
+         * @param sink_ Sink, must be thread safe
+         */
+        void setResultSink(ResultSink sink_);
+
+        /**
+         * @brief Set how many frames a session tracks before yielding to the others.
+         * @param frames Frames per task (at least 1)
+         */
+        void setQuantum(int frames);
+
+        /**
+         * @brief Start every session added since the last start().
+         */
+        void start();
+
+        /**
+         * @brief Block until every started session finished.
+         */
+        void wait();
+
+        /**
+         * @brief Start all sessions and wait for them.
+         */
+        inline void run() {
+            start();
+            wait();
+        }
+
+        /**
+         * @brief Counters of a session.
+         * @param id Session id
+         * @return Counters, empty for unknown ids
+         */
+        SessionStats getSessionStats(int id) const;
+
+        /**
+         * @brief Counters summed over every session, finished is true when all are.
+         * @return Counters
+         */
+        SessionStats getTotalStats() const;
+
+        /**
+         * @brief Get the System of a session, read its map only once the session finished.
+         * @param id Session id
+         * @return System, nullptr for unknown ids
+         */
+        std::shared_ptr<System> getSystem(int id) const;
+
+        /// @brief Number of sessions.
+        size_t getSessionCount() const;
+
+        /// @brief Shared asset cache.
+        inline std::shared_ptr<SharedAssets> getAssets() const { return assets; }
+
+        /// @brief Shared pool.
+        inline std::shared_ptr<Utils::ThreadPool> getPool() const { return pool; }
+
+        /**
+         * @brief Create Shared Pointer of SessionHost object
+         * @return Shared Pointer of SessionHost
+         */
+        static std::shared_ptr<SessionHost> create(std::shared_ptr<Utils::ThreadPool> pool_ = nullptr,
+            std::shared_ptr<SharedAssets> assets_ = nullptr, bool serialOpenCV = true) {
+            return std::make_shared<SessionHost>(pool_, assets_, serialOpenCV);
+        }
+    };
+
+} // namespace StringSLAM
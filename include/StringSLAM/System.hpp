@@ -0,0 +1,390 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+#include "StringSLAM/core/Map.hpp"
+#include "StringSLAM/core/MapExporter.hpp"
+#include "StringSLAM/core/MemoryRegistry.hpp"
+#include "StringSLAM/core/UndistortLUT.hpp"
+#include "StringSLAM/Estimation/DirectTracker.hpp"
+#include "StringSLAM/Estimation/Initializer.hpp"
+#include "StringSLAM/Estimation/Relocalizer.hpp"
+#include "StringSLAM/Feature/FeatureFinder.hpp"
+#include "StringSLAM/Tracker/MotionGate.hpp"
+#include "StringSLAM/Utils/Evaluation.hpp"
+#include "StringSLAM/Utils/ThreadPool.hpp"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace StringSLAM
+{
+    /**
+     * @brief Outcome of a tracked frame.
+     */
+    enum class TrackingState {
+        /// Map not initialized yet, no pose
+        INITIALIZING,
+        /// Pose tracked against the local map
+        TRACKING,
+        /// Tracking was lost and the pose was recovered by relocalization
+        RELOCALIZED,
+        /// No pose
+        LOST,
+        /// Frame was discarded by the submit() backpressure and never processed
+        DROPPED
+    };
+
+    /**
+     * @brief Result of one frame.
+     */
+    struct TrackResult {
+        /// ID assigned to the frame by the System
+        int frameId = -1;
+
+        /// Timestamp of the frame
+        std::chrono::system_clock::time_point timestamp;
+
+        /// Outcome
+        TrackingState state = TrackingState::LOST;
+
+        /// T_world_camera, valid when ok()
+        SE3 pose;
+
+        /// PnP inliers
+        int inliers = 0;
+
+        /// Frame was inserted as keyframe
+        bool keyframe = false;
+
+        /// Frame was skipped by the motion gate, state and pose repeat the last processed frame
+        bool skipped = false;
+
+        /// @brief The frame has a pose.
+        inline bool ok() const { return state == TrackingState::TRACKING || state == TrackingState::RELOCALIZED; }
+    };
+
+    /**
+     * @brief How frames between keyframes are tracked.
+     */
+    enum class TrackingMode {
+        /// ORB features on every frame, matched against the local map
+        FEATURES,
+        /// Sparse image alignment against the last keyframe, ORB only for keyframes and relocalization
+        SEMI_DIRECT
+    };
+
+    /**
+     * @brief What submit() does when the queue is full.
+     */
+    enum class Backpressure {
+        /// Wait for space, the caller is throttled to the tracking rate
+        BLOCK,
+        /// Discard the oldest queued frame, latency stays bounded
+        DROP_OLDEST,
+        /// Discard the submitted frame, the queued ones are kept
+        DROP_NEWEST
+    };
+
+    /**
+     * @brief Counters of the submit() queue.
+     */
+    struct SystemStats {
+        /// Frames waiting in the queue
+        size_t queueDepth = 0;
+
+        /// Queue capacity
+        size_t queueCapacity = 0;
+
+        /// Largest queue depth seen
+        size_t peakQueueDepth = 0;
+
+        /// Frames handed to submit()
+        uint64_t submitted = 0;
+
+        /// Frames tracked by the worker
+        uint64_t processed = 0;
+
+        /// Queued frames discarded for a newer one (DROP_OLDEST)
+        uint64_t droppedOldest = 0;
+
+        /// Submitted frames discarded because the queue was full (DROP_NEWEST)
+        uint64_t droppedNewest = 0;
+
+        /// Submitted frames skipped by the motion gate, queued without pixels
+        uint64_t skipped = 0;
+    };
+
+    /**
+     * @brief Monocular SLAM front door.
+     *
+     * Combines the library components: ORB features, Initializer, PnP
+     * tracking against the covisible local map, keyframe insertion with
+     * two-view triangulation, and Relocalizer when tracking is lost.
+     *
+     * In TrackingMode::SEMI_DIRECT, frames between keyframes are tracked by an
+     * Estimation::DirectTracker on image intensities instead. Features and
+     * descriptors are then extracted only for new keyframes, and for frames the
+     * direct tracker loses, which go through the feature path and become the
+     * next keyframe.
+     *
+     * Frames are either tracked synchronously with track(), or handed to
+     * submit(), which returns immediately. A worker thread then tracks them in
+     * order and reports every result through the returned future and the
+     * optional callback. When the worker falls behind, the Backpressure policy
+     * decides which frames are discarded. Discarded frames resolve their
+     * future with TrackingState::DROPPED, so a future is never left broken.
+     */
+    class System
+    {
+    private:
+        CameraModel cm;
+        std::shared_ptr<Utils::ThreadPool> pool;
+
+        // -- Below are private variables not specified but used in class. --
+        cv::Mat K;
+        bool distorted = false;
+
+        // Keypoint undistortion, built from the first frame size unless one was shared.
+        std::shared_ptr<const UndistortLUT> lut;
+
+        std::shared_ptr<OrbWrapper> orb;
+        std::shared_ptr<Feature::FeatureFinder> finder;
+        std::shared_ptr<Map> map = Map::create();
+        std::shared_ptr<Estimation::Initializer> initializer;
+        std::shared_ptr<Estimation::Relocalizer> relocalizer;
+        std::shared_ptr<Estimation::DirectTracker> direct;
+        TrackingMode mode = TrackingMode::FEATURES;
+        std::shared_ptr<Utils::LatencyRecorder> latency;
+
+        // Serializes track(), the worker and map queries.
+        mutable std::mutex trackMtx;
+        std::atomic<int> nextId{0};
+
+        // Optional low-power gate and the result repeated for skipped frames.
+        std::shared_ptr<Tracker::MotionGate> gate;
+        mutable std::mutex gateMtx;
+        TrackResult lastResult;
+
+        bool initialized = false;
+        Frame reference;
+        int referenceAge = -1;
+
+        // Last keyframe and the landmark of each of its keypoints (-1 if none).
+        Frame keyframe;
+        std::vector<int> keyframeLandmarks;
+        size_t keyframeTracked = 0;
+
+        // False while keyframe is only a tracking reference kept out of a full map.
+        bool keyframeInMap = false;
+        int sinceKeyframe = 0;
+
+        // Landmarks tracked in the previous frame.
+        std::vector<int> tracked;
+        SE3 lastPose;
+
+        // submit() queue and its worker.
+        struct Pending {
+            Frame frame;
+            size_t bytes = 0;
+
+            // Skipped by the motion gate, frame holds no pixels.
+            bool skipped = false;
+            std::promise<TrackResult> result;
+        };
+
+        std::deque<Pending> queue;
+        mutable std::mutex queueMtx;
+        std::condition_variable queueCv, spaceCv, idleCv;
+        std::thread worker;
+        bool running = false;
+        bool busy = false;
+        Backpressure backpressure = Backpressure::DROP_OLDEST;
+        size_t capacity = 2;
+        std::function<void(const TrackResult &)> callback;
+        std::function<void()> threadInit;
+        SystemStats stats;
+
+        // Memory accounting of the map and of the queued frames.
+        MemoryAccount mapAccount, queueAccount;
+        size_t queuedBytes = 0;
+
+        // Optional incremental map export, updated after every processed frame.
+        std::shared_ptr<MapExporter> exporter;
+
+        void extract(Frame &f);
+        void setKeyframe(const Frame &f, const std::vector<int> &kpLandmark, bool inMap = true);
+        bool initialize(Frame &f);
+        bool trackLocalMap(Frame &f, std::vector<int> &kpLandmark, int &inliers);
+        bool insertKeyframe(Frame &f, std::vector<int> &kpLandmark);
+        void accountMap();
+        bool queueFull(size_t bytes) const;
+        bool trackDirect(Frame &f, TrackResult &res);
+        TrackResult process(Frame &f);
+        TrackResult run(Frame &f, bool gated, bool skipped = false);
+        bool skip(const Frame &f);
+        TrackResult repeatLast(const Frame &f) const;
+        void workerLoop();
+        static void discard(Pending &p);
+
+    public:
+        /**
+         * @brief Construct System
+         * @param cm_ CameraModel, keypoints are undistorted when it has distortion
+         * @param pool_ Pool shared by initialization and relocalization, nullptr creates one
+         * @param features ORB features per frame
+         */
+        System(const CameraModel &cm_, std::shared_ptr<Utils::ThreadPool> pool_ = nullptr, int features = 1000);
+        ~System();
+
+        System(const System &) = delete;
+        System &operator=(const System &) = delete;
+
+        /**
+         * @brief Track a frame on the calling thread.
+         * @param f Frame, its id, keypoints and pose are set
+         * @return Result
+         */
+        TrackResult track(Frame &f);
+
+        /**
+         * @brief Queue a frame for the worker thread and return immediately.
+         *
+         * The pixels are copied, so the capture buffer can be reused right away.
+         * Only Backpressure::BLOCK can wait, and only while the queue is full.
+         * The worker is started on first use.
+         * @param f Captured frame
+         * @return Future of the result, TrackingState::DROPPED if discarded
+         */
+        std::future<TrackResult> submit(const Frame &f);
+
+        /**
+         * @brief Set a function called on the worker thread with the result of every processed frame.
+         *
+         * It must return quickly, the next frame waits for it. Dropped frames are
+         * only reported through their future and getStats().
+         * @param callback_ Callback, nullptr to remove
+         */
+        void setCallback(std::function<void(const TrackResult &)> callback_);
+
+        /**
+         * @brief Enable the low-power mode: frames the gate finds static skip the pipeline.
+         *
+         * Skipped frames cost only the gate check. They report the state and pose
+         * of the last processed frame with TrackResult::skipped set. Through
+         * submit() their pixels are not copied, they take a queue entry without
+         * pixels so frame ids and results keep the submission order. The
+         * callback is not called for them.
+         * @param gate_ Gate, nullptr processes every frame
+         */
+        void setMotionGate(std::shared_ptr<Tracker::MotionGate> gate_);
+
+        /// @brief Motion gate, nullptr when every frame is processed.
+        std::shared_ptr<Tracker::MotionGate> getMotionGate() const;
+
+        /// @brief Counters of the motion gate, empty without one.
+        Tracker::MotionGateStats getMotionGateStats() const;
+
+        /**
+         * @brief Set a function run first on the worker thread, e.g. Accelerator::threadInit(Stage::TRACKING).
+         * @param init Hook, applies to the next worker start
+         */
+        void setThreadInit(std::function<void()> init);
+
+        /**
+         * @brief Set what submit() does when the queue is full.
+         * @param mode Policy
+         * @param capacity_ Frames waiting at most (at least 1)
+         */
+        void setBackpressure(Backpressure mode, size_t capacity_ = 2);
+
+        /**
+         * @brief Block until every submitted frame was processed or dropped.
+         */
+        void drain();
+
+        /**
+         * @brief Stop the worker, frames still queued resolve as dropped.
+         */
+        void stop();
+
+        /// @brief Queue counters.
+        SystemStats getStats() const;
+
+        /// @brief Frames waiting in the queue.
+        size_t getQueueDepth() const;
+
+        /**
+         * @brief Set how frames between keyframes are tracked.
+         * @param mode_ Mode, SEMI_DIRECT takes the current keyframe as reference right away
+         */
+        void setTrackingMode(TrackingMode mode_);
+
+        /// @brief How frames between keyframes are tracked.
+        TrackingMode getTrackingMode() const;
+
+        /**
+         * @brief Record per-stage latencies (features, initialization, tracking, direct, relocalization, mapping).
+         * @param latency_ Recorder, nullptr to stop
+         */
+        void setLatencyRecorder(std::shared_ptr<Utils::LatencyRecorder> latency_);
+
+        /**
+         * @brief Use a prebuilt keypoint undistortion table, e.g. one shared by several Systems.
+         * @param lut_ Table for this camera model and image size, nullptr builds one from the first frame
+         */
+        void setUndistortLUT(std::shared_ptr<const UndistortLUT> lut_);
+
+        /**
+         * @brief Report memory to a registry and apply its budgets.
+         *
+         * Two subsystems are reported:
+         * - "map": Map::getMemoryUsage(), after every keyframe. Before a keyframe
+         *   is inserted, Map::estimateInsertion() bounds what it adds with its
+         *   landmarks. When that would exceed the budget, the map switches to
+         *   MapStorage::COMPACT (keyframe images and descriptor copies are
+         *   dropped). If it still does not fit, no keyframe is inserted until it
+         *   does (e.g. after the budget was raised). Tracking goes on against the
+         *   existing map.
+         * - "queue": pixels of the frames waiting in the submit() queue. A frame
+         *   that does not fit counts as a full queue for the Backpressure policy,
+         *   an empty queue always takes one frame.
+         * @param registry Registry, nullptr to stop reporting
+         */
+        void setMemoryRegistry(std::shared_ptr<MemoryRegistry> registry);
+
+        /**
+         * @brief Stream map changes after every processed frame.
+         *
+         * MapExporter::update() runs on the tracking thread, where the map may be
+         * read, its cost is the number of changes. Use MapExporter::setMinInterval()
+         * to cap the batch rate. The exporter owns the Map change log while it is
+         * attached, detaching or replacing it disables the log.
+         * @param exporter_ Opened exporter, nullptr to stop
+         */
+        void setMapExporter(std::shared_ptr<MapExporter> exporter_);
+
+        /// @brief Keyframes in the map.
+        size_t getKeyframeCount() const;
+
+        /// @brief Landmarks in the map.
+        size_t getLandmarkCount() const;
+
+        /**
+         * @brief Get the map, not synchronized with the worker: read it after drain() or stop().
+         * @return Map
+         */
+        inline std::shared_ptr<Map> getMap() const { return map; }
+
+        /**
+         * @brief Create Shared Pointer of System object
+         * @return Shared Pointer of System
+         */
+        static std::shared_ptr<System> create(const CameraModel &cm_, std::shared_ptr<Utils::ThreadPool> pool_ = nullptr, int features = 1000) {
+            return std::make_shared<System>(cm_, pool_, features);
+        }
+    };
+
+} // namespace StringSLAM
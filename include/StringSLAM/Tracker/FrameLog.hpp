@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+
+namespace StringSLAM::Tracker::FrameLog
+{
+    /*
+     * On-disk layout of a frame log, shared by FrameRecorder and ReplayTracker.
+     *
+     *  FileHeader
+     *  CameraRecord x views
+     *  { ChunkHeader, { FrameRecord, { ImageRecord, pixels } x views } x count } ...
+     *  IndexEntry x frames
+     *  Footer
+     *
+     * Every record is a multiple of 8 bytes and pixel data is padded to DATA_ALIGN
+     * so a memory-mapped log can be handed out without copying. A log that was not
+     * closed has no index/footer, ReplayTracker rebuilds the index from the chunks.
+     */
+
+    /// Format version written to FileHeader
+    constexpr uint32_t VERSION = 1;
+
+    /// Pixel data alignment inside the log
+    constexpr uint64_t DATA_ALIGN = 16;
+
+    /// Magic of a ChunkHeader ("CHNK")
+    constexpr uint32_t CHUNK_MAGIC = 0x4B4E4843;
+
+    /// Magic of the FileHeader
+    constexpr char FILE_MAGIC[8] = {'S', 'S', 'L', 'A', 'M', 'L', 'O', 'G'};
+
+    /// Magic of the Footer
+    constexpr char INDEX_MAGIC[8] = {'S', 'S', 'L', 'A', 'M', 'I', 'D', 'X'};
+
+    /// @brief Start of the file.
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t views;
+    };
+
+    /// @brief CameraModel of one view.
+    struct CameraRecord {
+        double fx, fy, cx, cy;
+        double k1, k2, k3, k4, k5, k6, p1, p2;
+        int32_t width, height;
+    };
+
+    /// @brief Group of frames written at once by the writer thread.
+    struct ChunkHeader {
+        uint32_t magic;
+        uint32_t count;
+        uint64_t bytes;
+    };
+
+    /// @brief One captured frame set (1 view for mono, 2 for stereo).
+    struct FrameRecord {
+        int64_t timestampNs;
+        int32_t id;
+        uint32_t views;
+    };
+
+    /// @brief One image of a FrameRecord, followed by its pixels.
+    struct ImageRecord {
+        int32_t rows;
+        int32_t cols;
+        int32_t type;
+        uint32_t step;
+        uint64_t bytes;
+    };
+
+    /// @brief Location of a FrameRecord.
+    struct IndexEntry {
+        uint64_t offset;
+        int64_t timestampNs;
+        int32_t id;
+        uint32_t reserved;
+    };
+
+    /// @brief End of a cleanly closed file.
+    struct Footer {
+        uint64_t indexOffset;
+        uint64_t count;
+        char magic[8];
+    };
+
+    /// Round n up to DATA_ALIGN.
+    inline uint64_t align(uint64_t n) { return (n + DATA_ALIGN - 1) & ~(DATA_ALIGN - 1); }
+
+} // namespace StringSLAM::Tracker::FrameLog
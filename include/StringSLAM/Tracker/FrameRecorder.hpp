@@ -0,0 +1,136 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+#include "StringSLAM/Tracker/FrameLog.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace StringSLAM::Tracker
+{
+    /**
+     * @brief Appends captured frames to a chunked, indexed log on a writer thread.
+     *
+     * record() only queues a copy of the pixels, all disk I/O happens on the writer
+     * thread so the capture loop never waits on storage. When the writer falls
+     * behind by more than maxQueue frames new frames are dropped and counted.
+     * The log is replayed with ReplayTracker.
+     */
+    class FrameRecorder
+    {
+    private:
+        std::string path;
+        std::vector<CameraModel> cms;
+        size_t chunkSize;
+        size_t maxQueue;
+
+        // -- Below are private variables not specified but used in class. --
+        struct Entry {
+            int64_t timestampNs;
+            int id;
+            std::vector<cv::Mat> views;
+        };
+
+        FILE *file = nullptr;
+        uint64_t offset = 0;
+
+        // Frames waiting for the writer thread.
+        std::deque<Entry> queue;
+        std::mutex mtx;
+        std::condition_variable queueCv;
+        std::thread writer;
+        std::function<void()> threadInit;
+        bool running = false;
+
+        std::atomic<size_t> recorded{0};
+        std::atomic<size_t> dropped{0};
+
+        // Latched by the first short write, the log is truncated from there on.
+        std::atomic<bool> failed{false};
+
+        // Written on the writer thread, flushed into the footer on close().
+        std::vector<uint8_t> chunk;
+        std::vector<FrameLog::IndexEntry> index;
+        size_t chunkCount = 0;
+
+        bool enqueue(Entry &&e);
+        void writerLoop();
+        void appendEntry(const Entry &e);
+        void flushChunk();
+        bool writeRaw(const void *data, size_t bytes);
+        void pad(std::vector<uint8_t> &buf, uint64_t base);
+
+    public:
+        /**
+         * @brief Construct a FrameRecorder.
+         * @param path_ Output log file
+         * @param cms_ CameraModel of every view (1 for mono, 2 for stereo)
+         * @param chunkSize_ Frames written per chunk
+         * @param maxQueue_ Frames buffered before new frames are dropped
+         */
+        FrameRecorder(const std::string &path_, const std::vector<CameraModel> &cms_, size_t chunkSize_ = 32, size_t maxQueue_ = 64);
+        ~FrameRecorder();
+
+        FrameRecorder(const FrameRecorder &) = delete;
+        FrameRecorder &operator=(const FrameRecorder &) = delete;
+
+        /**
+         * @brief Open the log and start the writer thread.
+         * @return Log opened succesfully
+         */
+        bool open();
+
+        /**
+         * @brief Set a function run first on the writer thread, e.g. Accelerator::threadInit(Stage::IO).
+         * @param init Hook, call before open()
+         */
+        inline void setThreadInit(std::function<void()> init) { threadInit = std::move(init); }
+
+        /**
+         * @brief Drain the queue, write the index and close the log.
+         * @return Log is complete, false if a write failed (no index is written then)
+         */
+        bool close();
+
+        /**
+         * @brief Queue a mono Frame.
+         * @param f Captured frame
+         * @return Frame was queued (false if dropped, a write failed or the log has more views)
+         */
+        bool record(const Frame &f);
+
+        /**
+         * @brief Queue both views of a StereoFrame.
+         * @param sf Captured stereo frame
+         * @return Frame was queued (false if dropped, a write failed or the log is not stereo)
+         */
+        bool record(const StereoFrame &sf);
+
+        /// @brief Frames queued so far.
+        inline size_t getRecorded() const { return recorded; }
+
+        /// @brief Frames dropped because the writer fell behind.
+        inline size_t getDropped() const { return dropped; }
+
+        /// @brief A write failed (e.g. disk full), later frames are not recorded.
+        inline bool hasFailed() const { return failed; }
+
+        /// @brief Log is open.
+        inline bool isOpen() const { return file != nullptr; }
+
+        /**
+         * @brief Create Shared Pointer of FrameRecorder object
+         * @return Shared Pointer of FrameRecorder
+         */
+        static std::shared_ptr<FrameRecorder> create(const std::string &path_, const std::vector<CameraModel> &cms_, size_t chunkSize_ = 32, size_t maxQueue_ = 64) {
+            return std::make_shared<FrameRecorder>(path_, cms_, chunkSize_, maxQueue_);
+        }
+    };
+
+} // namespace StringSLAM::Tracker
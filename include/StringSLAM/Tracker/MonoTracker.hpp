@@ -1,6 +1,9 @@
 #pragma once
 
 #include "StringSLAM/core.hpp"
+#include "StringSLAM/core/MemoryRegistry.hpp"
+#include "StringSLAM/core/UndistortLUT.hpp"
+#include "StringSLAM/Tracker/FrameRecorder.hpp"
 #include <opencv2/videoio.hpp>
 
 namespace StringSLAM::Tracker
@@ -10,6 +13,17 @@ namespace StringSLAM::Tracker
      */
     class MonoTracker
     {
+    public:
+        /**
+         * @brief Where undistortion is applied.
+         */
+        enum class Undistortion {
+            /// Remap the whole image before feature extraction.
+            IMAGE,
+            /// Extract on the raw image and undistort only the keypoints (UndistortLUT).
+            KEYPOINTS
+        };
+
     private:
         int id;        
         CameraModel cm;
@@ -20,6 +34,17 @@ namespace StringSLAM::Tracker
 
         // Optimized maps for undistortion in real time.
         cv::Mat m1, m2, kD;
+
+        // Optional recorder every captured frame is handed to.
+        std::shared_ptr<FrameRecorder> recorder;
+
+        // Undistortion mode and the lookup table of KEYPOINTS, built on first use.
+        Undistortion undistortion = Undistortion::IMAGE;
+        std::shared_ptr<UndistortLUT> lut;
+
+        // Undistortion maps and LUT report here, shared by copies of this tracker.
+        std::shared_ptr<MemoryAccount> account;
+        void accountUndistortion();
     public:
         /**
          * @brief Constructs a MonoTracker
@@ -48,10 +73,65 @@ namespace StringSLAM::Tracker
 
         /**
          * @brief Get undistorted frame based off CameraModel
+         *
+         * In Undistortion::KEYPOINTS mode the raw frame is returned, call
+         * undistortKeypoints() after feature extraction.
          * @return Undistorted Frame
          */
         void readUndistorted(Frame &f);
+
+        /**
+         * @brief Undistort an already captured frame based off CameraModel
+         *
+         * Lets capture and undistortion run on different threads. Does nothing in
+         * Undistortion::KEYPOINTS mode.
+         * @param f Frame captured by read()
+         */
+        void undistort(Frame &f);
+
+        /**
+         * @brief Fill Frame::kpUndistorted from keypoints extracted on the raw frame.
+         *
+         * Does nothing in Undistortion::IMAGE mode, the keypoints already are undistorted.
+         * @param f Frame with keypoints
+         */
+        void undistortKeypoints(Frame &f);
+
+        /**
+         * @brief Choose where undistortion is applied.
+         * @param mode Undistortion mode
+         * @param step LUT grid spacing for Undistortion::KEYPOINTS (pixels)
+         */
+        void setUndistortion(Undistortion mode, int step = 8);
+
+        /**
+         * @brief Get the keypoint undistortion table, built on first use.
+         * @return UndistortLUT of this camera
+         */
+        std::shared_ptr<UndistortLUT> getUndistortLUT();
         
+        /**
+         * @brief Report the undistortion buffers to a MemoryRegistry.
+         *
+         * When the budget is exceeded:
+         * - Undistortion::IMAGE drops the remap tables and undistorts every frame
+         *   with cv::undistort, which builds them a band of rows at a time (slower,
+         *   only with an identity rectification).
+         * - Undistortion::KEYPOINTS doubles the LUT grid spacing, up to 64 pixels.
+         * @param registry Registry, nullptr to stop reporting
+         * @param name Subsystem name
+         */
+        void setMemoryRegistry(std::shared_ptr<MemoryRegistry> registry, const std::string &name = "undistortion");
+
+        /// @brief Bytes of the undistortion maps and LUT.
+        size_t getMemoryUsage() const;
+
+        /**
+         * @brief Record every frame returned by read() (nullptr to stop).
+         * @param recorder_ Opened FrameRecorder with 1 view
+         */
+        inline void setRecorder(std::shared_ptr<FrameRecorder> recorder_) { recorder = recorder_; }
+
         /**
          * @brief Get FPS of tracker camera
          * @return FPS of capture device
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+
+namespace StringSLAM::Tracker
+{
+    /**
+     * @brief Counters of a MotionGate.
+     */
+    struct MotionGateStats {
+        /// Frames checked
+        uint64_t frames = 0;
+
+        /// Frames passed to the pipeline
+        uint64_t processed = 0;
+
+        /// Frames skipped as static
+        uint64_t skipped = 0;
+
+        /// Current processing interval while static (1 = every frame)
+        int interval = 1;
+
+        /// Difference score of the last frame (gray levels)
+        double lastScore = 0.0;
+
+        /// @brief Fraction of frames skipped.
+        inline double skipRatio() const { return frames ? double(skipped) / double(frames) : 0.0; }
+    };
+
+    /**
+     * @brief Low-power gate deciding whether a frame is worth the full pipeline.
+     *
+     * Every frame is reduced to a small thumbnail by sampling a sparse grid of
+     * pixels (a few hundred reads, no allocation). The thumbnail is compared to
+     * the thumbnail of the last processed frame, after removing the global
+     * brightness change so auto exposure does not count as motion.
+     *
+     * While the score stays under the threshold the camera counts as static and
+     * the processing interval doubles on every processed frame, up to
+     * maxInterval: the pipeline still sees an occasional frame, but CPU use
+     * decays towards the cost of the gate. The first frame that moves resets
+     * the interval to 1.
+     */
+    class MotionGate
+    {
+    private:
+        double threshold;
+        int maxInterval;
+        cv::Size thumbSize;
+
+        // -- Below are private variables not specified but used in class. --
+        std::vector<float> reference, current;
+        bool hasReference = false;
+        int sinceProcessed = 0;
+        MotionGateStats stats;
+
+        bool sample(const cv::Mat &img, std::vector<float> &out) const;
+        double score() const;
+
+    public:
+        /**
+         * @brief Construct MotionGate
+         * @param threshold_ Mean absolute difference (gray levels) counted as motion
+         * @param maxInterval_ Longest processing interval while static (frames)
+         * @param thumbSize_ Thumbnail size, one sample per cell
+         */
+        explicit MotionGate(double threshold_ = 3.0, int maxInterval_ = 30, cv::Size thumbSize_ = cv::Size(32, 24));
+        ~MotionGate() = default;
+
+        /**
+         * @brief Check a frame.
+         * @param f Captured frame, GRAY8 or BGR
+         * @return Run the full pipeline on this frame
+         */
+        bool accept(const Frame &f);
+
+        /**
+         * @brief Forget the reference, the next frame is processed.
+         */
+        void reset();
+
+        /// @brief Counters.
+        inline const MotionGateStats &getStats() const { return stats; }
+
+        /// @brief Motion threshold (gray levels).
+        inline double getThreshold() const { return threshold; }
+
+        /// @brief Longest processing interval (frames).
+        inline int getMaxInterval() const { return maxInterval; }
+
+        /**
+         * @brief Create Shared Pointer of MotionGate object
+         * @return Shared Pointer of MotionGate
+         */
+        static std::shared_ptr<MotionGate> create(double threshold_ = 3.0, int maxInterval_ = 30, cv::Size thumbSize_ = cv::Size(32, 24)) {
+            return std::make_shared<MotionGate>(threshold_, maxInterval_, thumbSize_);
+        }
+    };
+
+} // namespace StringSLAM::Tracker
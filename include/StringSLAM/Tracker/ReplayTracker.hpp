@@ -0,0 +1,115 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+#include "StringSLAM/Tracker/FrameLog.hpp"
+#include <string>
+#include <vector>
+
+namespace StringSLAM::Tracker
+{
+    /**
+     * @brief A tracking object that replays a log written by FrameRecorder.
+     *
+     * The log is memory-mapped and every Frame handed out points straight into the
+     * mapping, no pixels are copied. Frames keep their recorded id and timestamp so
+     * a replay is deterministic. The mapping is private, so writing into a replayed
+     * frame never touches the log.
+     */
+    class ReplayTracker
+    {
+    public:
+        /// Pacing of read()
+        enum class Playback {
+            /// Return frames as fast as they are requested
+            MAX_SPEED,
+            /// Sleep so frames are returned at their recorded rate
+            REAL_TIME
+        };
+
+    private:
+        std::string path;
+        Playback mode;
+
+        // -- Below are private variables not specified but used in class. --
+        uint8_t *data = nullptr;
+        size_t size = 0;
+        std::vector<CameraModel> cms;
+        std::vector<FrameLog::IndexEntry> index;
+        size_t cursor = 0;
+
+        // Wall clock / log clock pair used for REAL_TIME pacing.
+        std::chrono::steady_clock::time_point startWall;
+        int64_t startLogNs = 0;
+        bool paced = false;
+
+        bool buildIndex(uint64_t start);
+        bool readViews(std::vector<cv::Mat> &views, int64_t &timestampNs, int &id);
+
+    public:
+        /**
+         * @brief Construct a ReplayTracker.
+         * @param path_ Log written by FrameRecorder
+         * @param mode_ Playback pacing
+         */
+        ReplayTracker(const std::string &path_, Playback mode_ = Playback::MAX_SPEED);
+        ~ReplayTracker();
+
+        ReplayTracker(const ReplayTracker &) = delete;
+        ReplayTracker &operator=(const ReplayTracker &) = delete;
+
+        /**
+         * @brief Map the log and load its index.
+         * @return Log opened succesfully
+         */
+        bool open();
+
+        /// Unmap the log, frames read before stay valid only until this call.
+        void release();
+
+        /**
+         * @brief Get next Frame from the log (first view).
+         * @param f Frame pointing into the log
+         * @return A frame was read, false at the end of the log
+         */
+        bool read(Frame &f);
+
+        /**
+         * @brief Get next StereoFrame from a stereo log.
+         * @param sf StereoFrame pointing into the log
+         * @return A frame was read, false at the end of the log or for mono logs
+         */
+        bool read(StereoFrame &sf);
+
+        /**
+         * @brief Move the read cursor.
+         * @param i Frame index
+         * @return Index was inside the log
+         */
+        bool seek(size_t i);
+
+        /// @brief Frames in the log.
+        inline size_t getFrameCount() const { return index.size(); }
+
+        /// @brief Index of the next frame read() returns.
+        inline size_t getPosition() const { return cursor; }
+
+        /// @brief Views per frame (1 mono, 2 stereo).
+        inline size_t getViews() const { return cms.size(); }
+
+        /**
+         * @brief Get recorded CameraModel.
+         * @param view View index
+         * @return CameraModel
+         */
+        inline CameraModel getCameraModel(size_t view = 0) const { return cms.at(view); }
+
+        /**
+         * @brief Create Shared Pointer of ReplayTracker object
+         * @return Shared Pointer of ReplayTracker
+         */
+        static std::shared_ptr<ReplayTracker> create(const std::string &path_, Playback mode_ = Playback::MAX_SPEED) {
+            return std::make_shared<ReplayTracker>(path_, mode_);
+        }
+    };
+
+} // namespace StringSLAM::Tracker
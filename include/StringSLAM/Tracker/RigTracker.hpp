@@ -0,0 +1,139 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+#include "StringSLAM/Feature/FeatureFinder.hpp"
+#include "StringSLAM/Tracker/MonoTracker.hpp"
+#include "StringSLAM/Utils/ThreadPool.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace StringSLAM::Tracker
+{
+    /**
+     * @brief A set of Frames captured by a RigTracker at (nearly) the same time.
+     */
+    struct RigFrame {
+        /// ID of the frame set
+        int id = 0;
+
+        /// One Frame per camera, in rig order
+        std::vector<Frame> frames;
+
+        /// Timestamp of the newest Frame in the set
+        std::chrono::system_clock::time_point timestamp;
+    };
+
+    /**
+     * @brief A tracking object for N rigidly mounted MonoTrackers.
+     *
+     * Generalizes StereoTracker to any number of cameras. Every camera captures on
+     * its own thread, read() assembles the newest set of frames whose timestamps
+     * lie within the tolerance window, then undistortion and feature extraction run
+     * per camera in parallel on a shared ThreadPool.
+     */
+    class RigTracker
+    {
+    private:
+        std::vector<std::shared_ptr<MonoTracker>> cams;
+
+        // Camera -> rig transform (T_rig_camera) of every camera.
+        std::vector<SE3> extrinsics;
+
+        std::chrono::microseconds tolerance;
+        std::shared_ptr<Utils::ThreadPool> pool;
+
+        // Optional per-camera feature extraction, one FeatureFinder per camera since they are stateful.
+        std::vector<std::shared_ptr<Feature::FeatureFinder>> finders;
+        bool undistortFrames = false;
+
+        // -- Below are private variables not specified but used in class. --
+        // Frames captured but not yet assembled, one queue per camera.
+        std::vector<std::deque<Frame>> pending;
+        std::vector<std::thread> captureThreads;
+        std::mutex mtx;
+        std::condition_variable frameCv;
+        std::atomic<bool> running{false};
+        int nextId = 0;
+
+        // Frames buffered per camera before the oldest is dropped.
+        static constexpr size_t MAX_PENDING = 4;
+
+        void captureLoop(size_t cam);
+        bool assemble(RigFrame &rf);
+
+    public:
+        /**
+         * @brief Construct RigTracker from parameters
+         * @param cams_ Cameras of the rig
+         * @param extrinsics_ Camera -> rig transform (T_rig_camera) of every camera
+         * @param tolerance_ Maximum timestamp spread inside one RigFrame
+         * @param pool_ Pool used for per-camera processing, nullptr creates one
+         */
+        RigTracker(const std::vector<std::shared_ptr<MonoTracker>> &cams_, const std::vector<SE3> &extrinsics_,
+            std::chrono::microseconds tolerance_ = std::chrono::milliseconds(5), std::shared_ptr<Utils::ThreadPool> pool_ = nullptr);
+        ~RigTracker();
+
+        RigTracker(const RigTracker &) = delete;
+        RigTracker &operator=(const RigTracker &) = delete;
+
+        /**
+         * @brief Open every camera and start the capture threads.
+         * @return Cameras opened succesfully
+         */
+        bool open();
+
+        /// Stop the capture threads and release the cameras
+        void release();
+
+        /**
+         * @brief Get the next assembled RigFrame.
+         * @param rf Frame set, processed according to setUndistort() / setFeatureFinders()
+         * @param timeout Longest time to wait for a complete set
+         * @return A complete set was assembled in time
+         */
+        bool read(RigFrame &rf, std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+
+        /**
+         * @brief Undistort every frame of a RigFrame inside read().
+         * @param enable Enable undistortion
+         */
+        inline void setUndistort(bool enable) { undistortFrames = enable; }
+
+        /**
+         * @brief Extract keypoints for every frame inside read().
+         * @param finders_ One FeatureFinder per camera (empty to disable)
+         */
+        void setFeatureFinders(const std::vector<std::shared_ptr<Feature::FeatureFinder>> &finders_);
+
+        /// @brief Cameras in the rig.
+        inline size_t getCameraCount() const { return cams.size(); }
+
+        /**
+         * @brief Get camera -> rig transform.
+         * @param cam Camera index
+         * @return T_rig_camera
+         */
+        inline const SE3 &getExtrinsic(size_t cam) const { return extrinsics.at(cam); }
+
+        /**
+         * @brief Get MonoTracker of a camera.
+         * @param cam Camera index
+         * @return MonoTracker
+         */
+        inline std::shared_ptr<MonoTracker> getCamera(size_t cam) const { return cams.at(cam); }
+
+        /**
+         * @brief Create Shared Pointer of RigTracker object
+         * @return Shared Pointer of RigTracker
+         */
+        static std::shared_ptr<RigTracker> create(const std::vector<std::shared_ptr<MonoTracker>> &cams_, const std::vector<SE3> &extrinsics_,
+            std::chrono::microseconds tolerance_ = std::chrono::milliseconds(5), std::shared_ptr<Utils::ThreadPool> pool_ = nullptr) {
+            return std::make_shared<RigTracker>(cams_, extrinsics_, tolerance_, pool_);
+        }
+    };
+
+} // namespace StringSLAM::Tracker
@@ -22,6 +22,15 @@ namespace StringSLAM::Tracker
         // -- Below are private variables not specified but used in class. --
         // Rectified Stereo correction map
         cv::Mat m1x, m1y, m2x, m2y;
+
+        // Optional recorder both captured views are handed to.
+        std::shared_ptr<FrameRecorder> recorder;
+
+        // Rectification maps, disparity and the last depth map report here.
+        std::shared_ptr<MemoryAccount> account;
+        int interpolation = cv::INTER_LINEAR;
+        size_t depthBytes = 0;
+        void accountStereo();
     public:
         /**
          * @brief Construct StereoTracker from parameters
@@ -58,6 +67,32 @@ namespace StringSLAM::Tracker
          */
         void readDepth(StereoFrame &sf);
 
+        /**
+         * @brief Get the stereo rectification, Q and R1 are filled by the first readDepth().
+         * @return Stereo camera distortion
+         */
+        inline const StereoCameraDistortion &getStereoDistortion() const { return scd; }
+
+        /**
+         * @brief Report the stereo buffers to a MemoryRegistry.
+         *
+         * When the budget is exceeded, the float rectification maps are converted
+         * to fixed point (6 instead of 8 bytes per pixel), or to nearest-neighbour
+         * maps (4 bytes per pixel) if fixed point does not fit either.
+         * @param registry Registry, nullptr to stop reporting
+         * @param name Subsystem name
+         */
+        void setMemoryRegistry(std::shared_ptr<MemoryRegistry> registry, const std::string &name = "stereo");
+
+        /// @brief Bytes of the rectification maps, the disparity buffer and the last depth map.
+        size_t getMemoryUsage() const;
+
+        /**
+         * @brief Record every StereoFrame returned by read() (nullptr to stop).
+         * @param recorder_ Opened FrameRecorder with 2 views
+         */
+        inline void setRecorder(std::shared_ptr<FrameRecorder> recorder_) { recorder = recorder_; }
+
         /**
          * @brief Create Shared Pointer of StereoTracker object
          * @return Shared Pointer of StereoTracker
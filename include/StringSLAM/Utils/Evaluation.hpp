@@ -0,0 +1,225 @@
+#pragma once
+
+#include "StringSLAM/core/Lie.hpp"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace StringSLAM::Utils
+{
+    /**
+     * @brief A timestamped pose of a trajectory.
+     */
+    struct StampedPose {
+        /// Time (s)
+        double timestamp = 0.0;
+
+        /// T_world_camera
+        SE3 pose;
+    };
+
+    /**
+     * @brief Summary of a set of errors.
+     */
+    struct ErrorStats {
+        /// Samples
+        size_t count = 0;
+
+        /// Root mean square
+        double rmse = 0.0;
+
+        /// Mean
+        double mean = 0.0;
+
+        /// Median
+        double median = 0.0;
+
+        /// Largest
+        double max = 0.0;
+
+        /**
+         * @brief Summarize errors.
+         * @param values Errors, reordered in place
+         * @return Summary
+         */
+        static ErrorStats compute(std::vector<double> &values);
+    };
+
+    /**
+     * @brief Accuracy of an estimated trajectory against ground truth.
+     */
+    struct TrajectoryErrors {
+        /// Associated pose pairs
+        size_t matched = 0;
+
+        /// Alignment of the estimate onto the ground truth (S_gt_est)
+        Sim3 alignment;
+
+        /// Absolute trajectory error (m)
+        ErrorStats ate;
+
+        /// Relative pose error, translation (m)
+        ErrorStats rpeTranslation;
+
+        /// Relative pose error, rotation (deg)
+        ErrorStats rpeRotation;
+    };
+
+    /**
+     * @brief Scores an estimated trajectory against ground truth.
+     *
+     * Poses are associated by nearest timestamp. The estimate is aligned with
+     * Umeyama's method, with scale for monocular runs, and then the absolute
+     * trajectory error (ATE) and relative pose error (RPE) over a fixed time
+     * delta are computed, following the TUM RGB-D benchmark definitions.
+     */
+    class TrajectoryEvaluator
+    {
+    private:
+        // Largest timestamp difference of an associated pair (s).
+        double maxTimeDifference = 0.02;
+
+        // Estimate a scale in the alignment (monocular).
+        bool alignScale = true;
+
+        // Time between the two poses of a RPE pair (s).
+        double rpeDelta = 1.0;
+
+    public:
+        TrajectoryEvaluator() = default;
+        ~TrajectoryEvaluator() = default;
+
+        /**
+         * @brief Score a trajectory.
+         * @param estimate Estimated poses, sorted by time
+         * @param groundTruth Ground truth poses, sorted by time
+         * @param errors Accuracy
+         * @return At least 3 poses could be associated and aligned
+         */
+        bool evaluate(const std::vector<StampedPose> &estimate, const std::vector<StampedPose> &groundTruth,
+            TrajectoryErrors &errors) const;
+
+        /**
+         * @brief Least-squares similarity between corresponding points (Umeyama, 1991).
+         * @param src Source points
+         * @param dst Destination points
+         * @param withScale Estimate scale, otherwise it is 1
+         * @param S_dst_src Alignment
+         * @return Enough non-degenerate points
+         */
+        static bool align(const std::vector<Eigen::Vector3d> &src, const std::vector<Eigen::Vector3d> &dst, bool withScale,
+            Sim3 &S_dst_src);
+
+        /**
+         * @brief Read a trajectory in TUM format (timestamp tx ty tz qx qy qz qw).
+         * @param path File
+         * @param poses Poses, sorted by time
+         * @return File was read
+         */
+        static bool loadTUM(const std::string &path, std::vector<StampedPose> &poses);
+
+        /**
+         * @brief Write a trajectory in TUM format.
+         * @param path File
+         * @param poses Poses
+         * @return File was written
+         */
+        static bool saveTUM(const std::string &path, const std::vector<StampedPose> &poses);
+
+        /**
+         * @brief Set the largest timestamp difference of an associated pair.
+         * @param maxTimeDifference_ Difference (s)
+         */
+        inline void setMaxTimeDifference(double maxTimeDifference_) { maxTimeDifference = maxTimeDifference_; }
+
+        /**
+         * @brief Set whether the alignment estimates scale.
+         * @param alignScale_ Estimate scale (monocular)
+         */
+        inline void setAlignScale(bool alignScale_) { alignScale = alignScale_; }
+
+        /**
+         * @brief Set the time between the two poses of a RPE pair.
+         * @param rpeDelta_ Delta (s)
+         */
+        inline void setRpeDelta(double rpeDelta_) { rpeDelta = rpeDelta_; }
+
+        /**
+         * @brief Create Shared Pointer of TrajectoryEvaluator object
+         * @return Shared Pointer of TrajectoryEvaluator
+         */
+        static std::shared_ptr<TrajectoryEvaluator> create() {
+            return std::make_shared<TrajectoryEvaluator>();
+        }
+    };
+
+    /**
+     * @brief Collects per-stage latencies and reports their percentiles.
+     */
+    class LatencyRecorder
+    {
+    public:
+        /**
+         * @brief Latency summary of one stage.
+         */
+        struct Summary {
+            /// Samples
+            size_t count = 0;
+
+            /// Mean (ms)
+            double mean = 0.0;
+
+            /// Percentiles (ms)
+            double p50 = 0.0, p90 = 0.0, p99 = 0.0;
+
+            /// Largest (ms)
+            double max = 0.0;
+        };
+
+    private:
+        std::map<std::string, std::vector<double>> samples;
+
+    public:
+        LatencyRecorder() = default;
+        ~LatencyRecorder() = default;
+
+        /**
+         * @brief Record one latency.
+         * @param stage Stage name
+         * @param ms Latency (ms)
+         */
+        inline void add(const std::string &stage, double ms) { samples[stage].push_back(ms); }
+
+        /**
+         * @brief Summarize a stage.
+         * @param stage Stage name
+         * @return Summary, empty for unknown stages
+         */
+        Summary summary(const std::string &stage) const;
+
+        /**
+         * @brief Get every recorded stage name.
+         * @return Stage names
+         */
+        std::vector<std::string> stages() const;
+
+        /// @brief Drop every sample.
+        inline void clear() { samples.clear(); }
+
+        /**
+         * @brief Create Shared Pointer of LatencyRecorder object
+         * @return Shared Pointer of LatencyRecorder
+         */
+        static std::shared_ptr<LatencyRecorder> create() {
+            return std::make_shared<LatencyRecorder>();
+        }
+    };
+
+    /**
+     * @brief Peak resident memory of the process.
+     * @return Peak resident set size (KiB), 0 if unknown
+     */
+    size_t getPeakMemoryKB();
+
+} // namespace StringSLAM::Utils
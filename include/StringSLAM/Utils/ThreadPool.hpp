@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace StringSLAM::Utils
+{
+    /**
+     * @brief A fixed size pool of worker threads shared between pipeline stages.
+     *
+     * Components that fan work out (per-camera extraction, block integration,
+     * hypothesis scoring, ...) take a shared_ptr to one pool instead of spawning
+     * their own threads, so the total thread count stays bounded.
+     *
+     * Every worker owns a task queue. Tasks submitted from a worker go to its own
+     * queue, tasks from other threads are spread round-robin, and a worker whose
+     * queue is empty steals from the others. Workers therefore rarely contend on
+     * one lock, and many independent producers (e.g. SessionHost sessions) are
+     * balanced over every core.
+     */
+    class ThreadPool
+    {
+    private:
+        std::vector<std::thread> workers;
+
+        // -- Below are private variables not specified but used in class. --
+        struct Queue {
+            std::mutex mtx;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        // One queue per worker, never resized after construction.
+        std::vector<std::unique_ptr<Queue>> queues;
+
+        // Queued tasks over all queues, idle workers sleep while it is zero.
+        std::atomic<size_t> pending{0};
+        std::atomic<size_t> nextQueue{0};
+        std::mutex mtx;
+        std::condition_variable taskCv;
+        bool stopping = false;
+
+        void workerLoop(size_t index, const std::function<void()> &init);
+        void push(std::function<void()> task);
+        bool pop(size_t index, std::function<void()> &task);
+        size_t localQueue();
+
+    public:
+        /**
+         * @brief Construct a ThreadPool.
+         * @param threads Worker count, 0 uses every hardware thread
+         * @param init Called first on every worker thread, e.g. Accelerator::threadInit() to pin it
+         */
+        explicit ThreadPool(size_t threads = 0, std::function<void()> init = nullptr);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        /**
+         * @brief Queue a task.
+         * @param fn Callable without arguments
+         * @return Future of the task result
+         */
+        template <class F>
+        auto submit(F &&fn) -> std::future<decltype(fn())> {
+            using R = decltype(fn());
+            auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+            std::future<R> result = task->get_future();
+            push([task] { (*task)(); });
+            return result;
+        }
+
+        /**
+         * @brief Run fn(i) for every i in [begin, end) and wait for completion.
+         *
+         * The calling thread takes part in the loop, so it is safe to call from
+         * inside a pool task.
+         * @param begin First index
+         * @param end One past the last index
+         * @param fn Loop body
+         */
+        void parallelFor(size_t begin, size_t end, const std::function<void(size_t)> &fn);
+
+        /// @brief Number of worker threads.
+        inline size_t size() const { return workers.size(); }
+
+        /// @brief Tasks queued and not started yet.
+        inline size_t queued() const { return pending.load(); }
+
+        /**
+         * @brief Create Shared Pointer of ThreadPool object
+         * @return Shared Pointer of ThreadPool
+         */
+        static std::shared_ptr<ThreadPool> create(size_t threads = 0, std::function<void()> init = nullptr) {
+            return std::make_shared<ThreadPool>(threads, std::move(init));
+        }
+    };
+
+} // namespace StringSLAM::Utils
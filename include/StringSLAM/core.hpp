@@ -1,9 +1,20 @@
 #pragma once
+#include "StringSLAM/core/Lie.hpp"
+#include "StringSLAM/core/DescriptorArena.hpp"
+#include "StringSLAM/core/Kernels.hpp"
+#include "StringSLAM/Utils/ThreadPool.hpp"
 #include "opencv2/calib3d.hpp"
 #include "opencv2/core/mat.hpp"
 #include "opencv2/core/types.hpp"
 #include <opencv2/core.hpp>
 #include <opencv2/core/ocl.hpp>
+#include <opencv2/imgproc.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
 
 namespace StringSLAM
 {
@@ -52,8 +63,7 @@ namespace StringSLAM
          * @return cv::Mat The 3x3 intrinsic matrix
          */
         cv::Mat getK() const {
-            static cv::Mat K = (cv::Mat_<double>(3,3) << fx,0,cx,0,fy,cy,0,0,1);
-            return K;
+            return (cv::Mat_<double>(3,3) << fx,0,cx,0,fy,cy,0,0,1);
         }
 
     };
@@ -109,8 +119,7 @@ namespace StringSLAM
          * @return cv::Mat The 1x8 distortion matrix
          */
         cv::Mat getD() const {
-            static cv::Mat D = (cv::Mat_<double>(1,8) << k1, k2, p1, p2,  k3, k4, k5, k6);
-            return D;
+            return (cv::Mat_<double>(1,8) << k1, k2, p1, p2,  k3, k4, k5, k6);
         }
     };
     
@@ -150,6 +159,68 @@ namespace StringSLAM
             cI(cI_), cD(cD_), capSize(capSize_) {};
     };
 
+    /**
+     * @brief Pixel layouts accepted by Frame::wrap().
+     */
+    enum class PixelFormat {
+        /// Single 8-bit luminance plane.
+        GRAY8,
+        /// Packed 4:2:2, Y0 U Y1 V per pixel pair.
+        YUYV,
+        /// Planar Y followed by interleaved UV at half resolution.
+        NV12,
+        /// Planar Y, U and V, chroma at half resolution.
+        I420
+    };
+
+    /**
+     * @brief Non-owning view of a raw image produced by an external capture stack.
+     *
+     * Only the pointers are stored, the memory stays owned by the caller and must
+     * outlive every Frame that wraps it.
+     */
+    struct RawBuffer {
+        /// Layout of the planes
+        PixelFormat format = PixelFormat::GRAY8;
+
+        /// Image width (pixels)
+        int width = 0;
+
+        /// Image height (pixels)
+        int height = 0;
+
+        /// Plane pointers, unused planes are nullptr (NV12 uses 2, I420 uses 3).
+        const uint8_t *planes[3] = {nullptr, nullptr, nullptr};
+
+        /// Row stride of each plane in bytes, 0 means tightly packed.
+        size_t strides[3] = {0, 0, 0};
+
+        /// Timestamp of when the buffer was captured.
+        std::chrono::system_clock::time_point timestamp;
+
+        /**
+         * @brief Check that the buffer has every plane its format requires.
+         * @return Buffer can be wrapped
+         */
+        bool valid() const {
+            if (width <= 0 || height <= 0 || !planes[0]) return false;
+            if (format == PixelFormat::NV12) return planes[1] != nullptr;
+            if (format == PixelFormat::I420) return planes[1] != nullptr && planes[2] != nullptr;
+            return true;
+        }
+
+        /**
+         * @brief Stride of a plane, resolving packed (0) strides.
+         * @param i Plane index
+         * @return Row stride in bytes
+         */
+        size_t stride(int i) const {
+            if (strides[i]) return strides[i];
+            if (i == 0) return format == PixelFormat::YUYV ? width * 2 : width;
+            return format == PixelFormat::NV12 ? (width + 1) / 2 * 2 : (width + 1) / 2;
+        }
+    };
+
     /**
      * @brief Frame data object to be handled by a MonoTracker instance.
      * (\ref StringSLAM::Feature::MonoTracker).
@@ -164,15 +235,66 @@ namespace StringSLAM
         /// Extracted Keypoints from frame.
         std::vector<cv::KeyPoint> kp;
 
+        /// Undistorted position of every keypoint, empty when kp were extracted from an undistorted image.
+        std::vector<cv::Point2f> kpUndistorted;
+
         /// Matches description of this frame compared to another
         cv::Mat desc;
 
-        /// Real time location of when frame was captured 
-        cv::Mat pose;
+        /// Arena slot of every row of desc, filled once the frame is stored in a Map
+        std::vector<DescriptorArena::Index> descIdx;
+
+        /// Real time location of when frame was captured (T_world_camera)
+        SE3 pose;
 
         /// Timestamp of when frame was captured.
         std::chrono::system_clock::time_point timestamp;
+
+        /// Caller-owned source buffer when the Frame was created by wrap(), chroma is read from here lazily.
+        RawBuffer raw;
+
+        Frame() = default;
+        Frame(Frame &&) = default;
+        Frame &operator=(Frame &&) = default;
+
+        /**
+         * @brief Copy a Frame.
+         *
+         * The caller's buffer may be reused once the copy exists (e.g. a keyframe
+         * stored in a Map), so raw is not carried over and pixels wrapped from it
+         * are cloned. Other pixels stay shared, as cv::Mat copies are.
+         * @param f Original Frame
+         */
+        Frame(const Frame &f)
+            : id(f.id), frame(f.wrapsRaw() ? f.frame.clone() : f.frame), kp(f.kp), kpUndistorted(f.kpUndistorted), desc(f.desc),
+              descIdx(f.descIdx), pose(f.pose), timestamp(f.timestamp) {}
+
+        Frame &operator=(const Frame &f) {
+            if (this == &f) return *this;
+            id = f.id;
+            frame = f.wrapsRaw() ? f.frame.clone() : f.frame;
+            kp = f.kp;
+            kpUndistorted = f.kpUndistorted;
+            desc = f.desc;
+            descIdx = f.descIdx;
+            pose = f.pose;
+            timestamp = f.timestamp;
+            raw = RawBuffer();
+            return *this;
+        }
+
+        /// @brief frame is a header over the caller-owned Y plane of raw.
+        inline bool wrapsRaw() const { return raw.valid() && !frame.empty() && frame.data == raw.planes[0]; }
         
+        /**
+         * @brief Undistorted position of a keypoint, for geometry (triangulation, PnP, ...).
+         * @param i Keypoint index
+         * @return kpUndistorted[i], or kp[i].pt when the frame was undistorted as a whole
+         */
+        inline const cv::Point2f &undistorted(size_t i) const {
+            return kpUndistorted.empty() ? kp[i].pt : kpUndistorted[i];
+        }
+
         /**
          * @brief Set timestamp of Frame
          */
@@ -180,8 +302,88 @@ namespace StringSLAM
             timestamp = std::chrono::system_clock::now();
         }
 
+        /**
+         * @brief Wrap caller-owned memory as this Frame without copying.
+         *
+         * frame becomes a GRAY8 header over the Y plane, so feature extraction runs
+         * directly on the caller's memory. YUYV has interleaved luminance and needs a
+         * single extraction pass, every other format is zero-copy.
+         * @param rb Raw buffer, must outlive the Frame
+         * @return Buffer was valid and wrapped
+         */
+        bool wrap(const RawBuffer &rb) {
+            kp.clear();
+            kpUndistorted.clear();
+            desc.release();
+            descIdx.clear();
+            if (!rb.valid()) {
+                frame.release();
+                raw = RawBuffer();
+                return false;
+            }
+
+            raw = rb;
+            timestamp = rb.timestamp;
+
+            if (rb.format == PixelFormat::YUYV) {
+                cv::Mat packed(rb.height, rb.width, CV_8UC2, const_cast<uint8_t *>(rb.planes[0]), rb.stride(0));
+                // frame may still point at a previous caller buffer or be shared with a keyframe.
+                frame.release();
+                cv::extractChannel(packed, frame, 0);
+            } else {
+                frame = cv::Mat(rb.height, rb.width, CV_8UC1, const_cast<uint8_t *>(rb.planes[0]), rb.stride(0));
+            }
+            return true;
+        }
+
+        /**
+         * @brief Convert this Frame to BGR for visualization.
+         *
+         * Chroma is only touched here, wrapped frames without chroma and captured
+         * frames fall back to the stored image.
+         * @param out BGR image
+         */
+        void toBGR(cv::Mat &out) const {
+            if (frame.empty()) {
+                out.release();
+                return;
+            }
+
+            if (!raw.valid() || raw.format == PixelFormat::GRAY8) {
+                if (frame.channels() == 1) cv::cvtColor(frame, out, cv::COLOR_GRAY2BGR);
+                else frame.copyTo(out);
+                return;
+            }
+
+            const int w = raw.width, h = raw.height;
+            uint8_t *y = const_cast<uint8_t *>(raw.planes[0]);
+            uint8_t *u = const_cast<uint8_t *>(raw.planes[1]);
+
+            if (raw.format == PixelFormat::YUYV) {
+                cv::Mat packed(h, w, CV_8UC2, y, raw.stride(0));
+                cv::cvtColor(packed, out, cv::COLOR_YUV2BGR_YUYV);
+            } else if (raw.format == PixelFormat::NV12) {
+                cv::Mat yMat(h, w, CV_8UC1, y, raw.stride(0));
+                cv::Mat uvMat((h + 1) / 2, (w + 1) / 2, CV_8UC2, u, raw.stride(1));
+                cv::cvtColorTwoPlane(yMat, uvMat, out, cv::COLOR_YUV2BGR_NV12);
+            } else {
+                // I420 must be contiguous for cvtColor, gather the planes once.
+                const int cw = (w + 1) / 2, ch = (h + 1) / 2;
+                cv::Mat planar(h + ch, w, CV_8UC1);
+                cv::Mat(h, w, CV_8UC1, y, raw.stride(0)).copyTo(planar.rowRange(0, h));
+                uint8_t *dst = planar.ptr<uint8_t>(h);
+                for (int p = 1; p < 3; p++) {
+                    for (int r = 0; r < ch; r++, dst += cw)
+                        std::memcpy(dst, raw.planes[p] + r * raw.stride(p), cw);
+                }
+                cv::cvtColor(planar, out, cv::COLOR_YUV2BGR_I420);
+            }
+        }
+
         /**
          * @brief Copy Frame data into this Frame.
+         *
+         * The copy owns its pixels, the borrowed raw buffer is not carried over.
          * @param f Original Frame.
          */
         void copyFrom(const Frame &f) {
@@ -190,31 +392,44 @@ namespace StringSLAM
             timestamp = f.timestamp;
             frame = f.frame.clone();
             desc = f.desc.clone();
-            pose = f.pose.clone();
+            descIdx = f.descIdx;
+            pose = f.pose;
+            raw = RawBuffer();
         }
 
         /**
-         * @brief Set Frame pose from t (translation) and R (rotation).
+         * @brief Heap bytes held by this Frame, for MemoryRegistry accounting.
+         *
+         * Pixels wrapped from a caller-owned buffer are not counted, pixels shared
+         * with another Frame are counted by both.
+         * @return Image, descriptor and keypoint bytes
+         */
+        inline size_t memoryBytes() const {
+            size_t bytes = kp.capacity() * sizeof(cv::KeyPoint) + kpUndistorted.capacity() * sizeof(cv::Point2f) +
+                descIdx.capacity() * sizeof(DescriptorArena::Index);
+            if (!frame.empty() && !wrapsRaw()) bytes += frame.total() * frame.elemSize();
+            if (!desc.empty()) bytes += desc.total() * desc.elemSize();
+            return bytes;
+        }
+
+        /**
+         * @brief Set Frame pose from OpenCV t (translation) and R (rotation).
          * @param t Translation Matrix
          * @param R Rotation Matrix
          */
         void setPoseFromTR(const cv::Mat &t, const cv::Mat &R) {
             if (R.rows != 3 || R.cols != 3 || t.rows != 3 || t.cols != 1) return;
-            pose = cv::Mat::eye(4, 4, R.type());
-            R.copyTo(pose(cv::Range(0,3), cv::Range(0,3)));
-            t.copyTo(pose(cv::Range(0,3), cv::Range(3,4)));
+            pose = SE3::fromCv(R, t);
         }
 
         /**
-         * @brief Get r & T from current pose of Frame.
+         * @brief Get OpenCV r & T from current pose of Frame.
          * @param t Translation Matrix
          * @param R Rotation Matrix
          * @return Frame's translation and rotation matrix.
          */
-        void getTRFromPose(cv::Mat &t, cv::Mat &R) {
-            if (pose.empty() ||  pose.rows != 4 || pose.cols != 4) return;
-            R = pose(cv::Range(0,3), cv::Range(0,3)).clone();
-            t = pose(cv::Range(0,3), cv::Range(3,4)).clone();
+        void getTRFromPose(cv::Mat &t, cv::Mat &R) const {
+            pose.toCv(R, t);
         }
     };
 
@@ -269,11 +484,14 @@ namespace StringSLAM
         /// Extracted Keypoints from frame.
         std::vector<cv::KeyPoint> kp;
 
+        /// Undistorted position of every keypoint, empty when kp were extracted from an undistorted image.
+        std::vector<cv::Point2f> kpUndistorted;
+
         /// Matches description of this frame compared to another
         cv::Mat desc;
 
-        /// Real time location of when frame was captured 
-        cv::Mat pose;
+        /// Real time location of when frame was captured (T_world_camera)
+        SE3 pose;
 
         /// Timestamp of when frame was captured.
         std::chrono::system_clock::time_point timestamp;
@@ -297,31 +515,39 @@ namespace StringSLAM
             frameRight.copyFrom(f.frameRight);
             depthFrame = f.depthFrame.clone();
             desc = f.desc.clone();
-            pose = f.pose.clone();
+            pose = f.pose;
+        }
+
+        /**
+         * @brief Heap bytes held by this StereoFrame, for MemoryRegistry accounting.
+         * @return Both views, depth map, descriptor and keypoint bytes
+         */
+        inline size_t memoryBytes() const {
+            size_t bytes = frameLeft.memoryBytes() + frameRight.memoryBytes() + kp.capacity() * sizeof(cv::KeyPoint) +
+                kpUndistorted.capacity() * sizeof(cv::Point2f);
+            if (!depthFrame.empty()) bytes += depthFrame.total() * depthFrame.elemSize();
+            if (!desc.empty()) bytes += desc.total() * desc.elemSize();
+            return bytes;
         }
 
         /**
-         * @brief Set StereoFrame pose from t (translation) and R (rotation).
+         * @brief Set StereoFrame pose from OpenCV t (translation) and R (rotation).
          * @param t Translation Matrix
          * @param R Rotation Matrix
          */
         void setPoseFromTR(const cv::Mat &t, const cv::Mat &R) {
             if (R.rows != 3 || R.cols != 3 || t.rows != 3 || t.cols != 1) return;
-            pose = cv::Mat::eye(4, 4, R.type());
-            R.copyTo(pose(cv::Range(0,3), cv::Range(0,3)));
-            t.copyTo(pose(cv::Range(0,3), cv::Range(3,4)));
+            pose = SE3::fromCv(R, t);
         }
 
         /**
-         * @brief Get r & T from current pose of StereoFrame.
+         * @brief Get OpenCV r & T from current pose of StereoFrame.
          * @param t Translation Matrix
          * @param R Rotation Matrix
          * @return StereoFrame's translation and rotation matrix.
          */
-        void getTRFromPose(cv::Mat &t, cv::Mat &R) {
-            if (pose.empty() ||  pose.rows != 4 || pose.cols != 4) return;
-            R = pose(cv::Range(0,3), cv::Range(0,3)).clone();
-            t = pose(cv::Range(0,3), cv::Range(3,4)).clone();
+        void getTRFromPose(cv::Mat &t, cv::Mat &R) const {
+            pose.toCv(R, t);
         }
     };
 
@@ -370,6 +596,9 @@ namespace StringSLAM
                 disp.convertTo(sf.depthFrame, CV_32F, 1.0 / 16.0);
             }
 
+            /// @brief Bytes of the disparity buffer kept between compute() calls.
+            inline size_t getMemoryUsage() const { return disp.empty() ? 0 : disp.total() * disp.elemSize(); }
+
             inline static std::shared_ptr<StereoSGBMWrapper> create(
                 int minDisparity=0, 
                 int numDisparities=16, 
@@ -468,9 +697,66 @@ namespace StringSLAM
     };
 
     /**
-     * @brief A helper class to increase performance.
-     * 
-     * Find and enables OpenCV GPU Acceleration.
+     * @brief One logical CPU as seen by the scheduler.
+     */
+    struct CpuCore {
+        /// Logical CPU number used for affinity
+        int id = 0;
+
+        /// Physical package (socket)
+        int package = 0;
+
+        /// Relative performance, 1024 for the fastest cores
+        int capacity = 1024;
+
+        /// Highest frequency (kHz), 0 if unknown
+        int maxFreqKHz = 0;
+
+        /// Belongs to the fastest cluster
+        bool big = true;
+    };
+
+    /**
+     * @brief Core cluster a pipeline stage runs on.
+     */
+    enum class CoreClass {
+        /// Every core
+        ANY,
+        /// Fastest cores (performance cluster)
+        BIG,
+        /// Remaining cores (efficiency cluster), every core on homogeneous CPUs
+        LITTLE
+    };
+
+    /**
+     * @brief Pipeline stages with their own threads.
+     */
+    enum class Stage {
+        /// Camera capture and frame decoding
+        CAPTURE,
+        /// Feature extraction and matching
+        FEATURES,
+        /// Pose tracking
+        TRACKING,
+        /// Mapping, triangulation and optimization
+        MAPPING,
+        /// Logging, recording and export
+        IO
+    };
+
+    /**
+     * @brief CPU execution manager: instruction sets, core topology and thread placement.
+     *
+     * On construction the CPU is probed once: its instruction set extensions
+     * (which select the matching kernel variants, see getHammingKernels()) and
+     * its cores, including big and little clusters of heterogeneous (big.LITTLE,
+     * hybrid) CPUs. Every Stage is then mapped to a set of cores, by default
+     * compute stages on the big cores and capture / I/O on the little ones, and
+     * threads are pinned with pinCurrentThread() or through the init hooks
+     * handed to ThreadPool, System and FrameRecorder. Topology and pinning need
+     * Linux, elsewhere every core counts as big and pinning is a no-op.
+     *
+     * Configure the stages before starting the threads that use them.
      */
     class Accelerator
     {
@@ -478,11 +764,18 @@ namespace StringSLAM
         cv::ocl::Context context;   // Device Context
         cv::ocl::Device device;     // Actual Device
 
+        // -- Below are private variables not specified but used in class. --
+        CpuFeatures features;
+        std::vector<CpuCore> cores;
+        std::vector<std::vector<int>> stageCpus;
+
+        void detectTopology();
+
     public:
         /**
-         * Constructs Accelerator
+         * Constructs Accelerator, probes the CPU and selects the best kernels.
          */
-        Accelerator() = default;
+        Accelerator();
         ~Accelerator() = default;
 
         /**
@@ -518,6 +811,84 @@ namespace StringSLAM
          */
         inline cv::ocl::Device getDevice() const { return device; }
 
+        /// @brief Instruction set extensions of this CPU.
+        inline const CpuFeatures &getCpuFeatures() const { return features; }
+
+        /**
+         * @brief Cap the kernel variants, e.g. AVX2 to avoid AVX-512 frequency drops.
+         * @param maxLevel Highest level to use
+         * @return Level actually selected
+         */
+        IsaLevel setKernelLevel(IsaLevel maxLevel);
+
+        /// @brief Level of the active kernels.
+        IsaLevel getKernelLevel() const;
+
+        /// @brief Logical CPUs, sorted by id.
+        inline const std::vector<CpuCore> &getCores() const { return cores; }
+
+        /// @brief The CPU has cores of different performance.
+        bool isHeterogeneous() const;
+
+        /**
+         * @brief Logical CPUs of a class.
+         * @param cls Class
+         * @return CPU ids, never empty
+         */
+        std::vector<int> getCpus(CoreClass cls) const;
+
+        /**
+         * @brief Run a stage on a class of cores.
+         * @param stage Stage
+         * @param cls Class
+         */
+        void setStageAffinity(Stage stage, CoreClass cls);
+
+        /**
+         * @brief Run a stage on explicit CPUs.
+         * @param stage Stage
+         * @param cpus CPU ids, empty allows every core
+         */
+        void setStageAffinity(Stage stage, const std::vector<int> &cpus);
+
+        /**
+         * @brief CPUs of a stage.
+         * @param stage Stage
+         * @return CPU ids
+         */
+        inline const std::vector<int> &getStageCpus(Stage stage) const { return stageCpus[size_t(stage)]; }
+
+        /**
+         * @brief Pin the calling thread to the cores of a stage.
+         * @param stage Stage
+         * @return Pinned (false where affinity is unsupported)
+         */
+        inline bool pinCurrentThread(Stage stage) const { return pinCurrentThread(getStageCpus(stage)); }
+
+        /**
+         * @brief Pin the calling thread to a set of CPUs.
+         * @param cpus CPU ids, empty allows every core
+         * @return Pinned (false where affinity is unsupported)
+         */
+        static bool pinCurrentThread(const std::vector<int> &cpus);
+
+        /**
+         * @brief Thread start hook pinning to a stage, for ThreadPool, System::setThreadInit(), ...
+         *
+         * The CPUs are copied, the hook stays valid after the Accelerator is gone.
+         * @param stage Stage
+         * @return Hook
+         */
+        std::function<void()> threadInit(Stage stage) const;
+
+        /**
+         * @brief Create a pool whose workers are pinned to a stage.
+         * @param stage Stage
+         * @param threads Worker count, 0 uses one per core of the stage
+         * @return Pool
+         */
+        std::shared_ptr<Utils::ThreadPool> createPool(Stage stage = Stage::MAPPING, size_t threads = 0) const;
+
         /**
          * @brief Create Shared Pointer of Accelerator object
          * @return Shared Pointer of Accelerator
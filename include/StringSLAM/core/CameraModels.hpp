@@ -0,0 +1,260 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace StringSLAM
+{
+    /**
+     * @brief Structure-of-arrays image points.
+     */
+    struct Points2 {
+        /// Horizontal coordinates (pixels)
+        std::vector<float> u;
+
+        /// Vertical coordinates (pixels)
+        std::vector<float> v;
+
+        /// @brief Number of points.
+        inline size_t size() const { return u.size(); }
+
+        /// @brief Resize every array.
+        inline void resize(size_t n) {
+            u.resize(n);
+            v.resize(n);
+        }
+    };
+
+    /**
+     * @brief Structure-of-arrays 3D points or bearing vectors.
+     */
+    struct Points3 {
+        /// X coordinates
+        std::vector<float> x;
+
+        /// Y coordinates
+        std::vector<float> y;
+
+        /// Z coordinates
+        std::vector<float> z;
+
+        /// @brief Number of points.
+        inline size_t size() const { return x.size(); }
+
+        /// @brief Resize every array.
+        inline void resize(size_t n) {
+            x.resize(n);
+            y.resize(n);
+            z.resize(n);
+        }
+    };
+
+    /**
+     * @brief Structure-of-arrays 2x3 Jacobians of a projection w.r.t. the camera frame point.
+     */
+    struct ProjectionJacobians {
+        /// First row, d(u)/d(x, y, z)
+        std::vector<float> du_dx, du_dy, du_dz;
+
+        /// Second row, d(v)/d(x, y, z)
+        std::vector<float> dv_dx, dv_dy, dv_dz;
+
+        /// @brief Number of Jacobians.
+        inline size_t size() const { return du_dx.size(); }
+
+        /// @brief Resize every array.
+        inline void resize(size_t n) {
+            du_dx.resize(n);
+            du_dy.resize(n);
+            du_dz.resize(n);
+            dv_dx.resize(n);
+            dv_dy.resize(n);
+            dv_dz.resize(n);
+        }
+    };
+
+    /**
+     * @brief Projection model of a camera with batch kernels.
+     *
+     * Every call processes a whole structure-of-arrays batch, so the virtual
+     * dispatch is paid once per batch and the kernels run 4 points per SSE/NEON
+     * instruction (scalar fallback elsewhere). Computation is in float.
+     * Parameters are stored per instance, models of different cameras never
+     * share state.
+     */
+    class ProjectionModel
+    {
+    protected:
+        CameraIntrinsic cI;
+
+        // -- Below are private variables not specified but used in class. --
+        // Cached intrinsic matrix.
+        cv::Mat K;
+
+    public:
+        /**
+         * @brief Construct ProjectionModel
+         * @param cI_ Intrinsics
+         */
+        explicit ProjectionModel(const CameraIntrinsic &cI_) : cI(cI_), K(cI_.getK()) {}
+        virtual ~ProjectionModel() = default;
+
+        /**
+         * @brief Project camera frame points to pixels.
+         * @param p Points in the camera frame
+         * @param uv Pixels, resized to p
+         * @param valid 1 when the point is in the valid projection domain, resized to p
+         */
+        virtual void project(const Points3 &p, Points2 &uv, std::vector<uint8_t> &valid) const = 0;
+
+        /**
+         * @brief Project points and compute the projection Jacobians.
+         * @param p Points in the camera frame
+         * @param uv Pixels, resized to p
+         * @param J d(u, v)/d(x, y, z) of every point, resized to p
+         * @param valid 1 when the point is in the valid projection domain, resized to p
+         */
+        virtual void projectJacobian(const Points3 &p, Points2 &uv, ProjectionJacobians &J, std::vector<uint8_t> &valid) const = 0;
+
+        /**
+         * @brief Unproject pixels to unit bearing vectors.
+         * @param uv Pixels
+         * @param rays Unit bearings in the camera frame, resized to uv
+         * @param valid 1 when the pixel maps to a ray, resized to uv
+         */
+        virtual void unproject(const Points2 &uv, Points3 &rays, std::vector<uint8_t> &valid) const = 0;
+
+        /// @brief Intrinsics.
+        inline const CameraIntrinsic &intrinsic() const { return cI; }
+
+        /// @brief Intrinsic matrix of this camera (3x3).
+        inline const cv::Mat &getK() const { return K; }
+    };
+
+    /**
+     * @brief Pinhole camera with radial-tangential (Brown-Conrady) distortion.
+     *
+     * Uses k1..k6, p1 and p2 of CameraDistortion as the OpenCV rational model
+     * (k4..k6 divide the radial term, plain Brown-Conrady when they are zero),
+     * unprojection inverts the distortion with a fixed number of Gauss-Newton steps.
+     */
+    class PinholeRadTanModel : public ProjectionModel
+    {
+    private:
+        CameraDistortion cD;
+
+        // -- Below are private variables not specified but used in class. --
+        // Cached distortion vector (k1, k2, p1, p2, k3, k4, k5, k6).
+        cv::Mat D;
+
+    public:
+        /**
+         * @brief Construct PinholeRadTanModel
+         * @param cI_ Intrinsics
+         * @param cD_ Distortion
+         */
+        PinholeRadTanModel(const CameraIntrinsic &cI_, const CameraDistortion &cD_ = CameraDistortion());
+
+        /**
+         * @brief Construct PinholeRadTanModel from a CameraModel
+         * @param cm CameraModel
+         */
+        explicit PinholeRadTanModel(const CameraModel &cm) : PinholeRadTanModel(cm.cI, cm.cD) {}
+
+        void project(const Points3 &p, Points2 &uv, std::vector<uint8_t> &valid) const override;
+        void projectJacobian(const Points3 &p, Points2 &uv, ProjectionJacobians &J, std::vector<uint8_t> &valid) const override;
+        void unproject(const Points2 &uv, Points3 &rays, std::vector<uint8_t> &valid) const override;
+
+        /// @brief Distortion vector of this camera (1x8, OpenCV order).
+        inline const cv::Mat &getD() const { return D; }
+
+        /**
+         * @brief Create Shared Pointer of PinholeRadTanModel object
+         * @return Shared Pointer of PinholeRadTanModel
+         */
+        static std::shared_ptr<PinholeRadTanModel> create(const CameraIntrinsic &cI_, const CameraDistortion &cD_ = CameraDistortion()) {
+            return std::make_shared<PinholeRadTanModel>(cI_, cD_);
+        }
+    };
+
+    /**
+     * @brief Equidistant fisheye camera (Kannala-Brandt, as cv::fisheye).
+     *
+     * theta_d = theta * (1 + k1 theta^2 + k2 theta^4 + k3 theta^6 + k4 theta^8),
+     * valid for incidence angles below the field of view (up to 180 deg).
+     */
+    class FisheyeModel : public ProjectionModel
+    {
+    private:
+        double k1, k2, k3, k4;
+
+        // Largest incidence angle (rad).
+        double maxTheta;
+
+        // -- Below are private variables not specified but used in class. --
+        // Cached distortion vector (k1, k2, k3, k4).
+        cv::Mat D;
+
+    public:
+        /**
+         * @brief Construct FisheyeModel
+         * @param cI_ Intrinsics
+         * @param k1_ Distortion coefficient
+         * @param k2_ Distortion coefficient
+         * @param k3_ Distortion coefficient
+         * @param k4_ Distortion coefficient
+         * @param fov Field of view (deg)
+         */
+        FisheyeModel(const CameraIntrinsic &cI_, double k1_ = 0.0, double k2_ = 0.0, double k3_ = 0.0, double k4_ = 0.0, double fov = 180.0);
+
+        void project(const Points3 &p, Points2 &uv, std::vector<uint8_t> &valid) const override;
+        void projectJacobian(const Points3 &p, Points2 &uv, ProjectionJacobians &J, std::vector<uint8_t> &valid) const override;
+        void unproject(const Points2 &uv, Points3 &rays, std::vector<uint8_t> &valid) const override;
+
+        /// @brief Distortion vector of this camera (1x4, cv::fisheye order).
+        inline const cv::Mat &getD() const { return D; }
+
+        /**
+         * @brief Create Shared Pointer of FisheyeModel object
+         * @return Shared Pointer of FisheyeModel
+         */
+        static std::shared_ptr<FisheyeModel> create(const CameraIntrinsic &cI_, double k1_ = 0.0, double k2_ = 0.0, double k3_ = 0.0,
+            double k4_ = 0.0, double fov = 180.0) {
+            return std::make_shared<FisheyeModel>(cI_, k1_, k2_, k3_, k4_, fov);
+        }
+    };
+
+    /**
+     * @brief Double sphere camera (Usenko et al., 2018).
+     *
+     * Closed-form projection and unprojection for wide-angle lenses beyond 180 deg.
+     */
+    class DoubleSphereModel : public ProjectionModel
+    {
+    private:
+        double xi, alpha;
+
+    public:
+        /**
+         * @brief Construct DoubleSphereModel
+         * @param cI_ Intrinsics
+         * @param xi_ Distance between the sphere centers
+         * @param alpha_ Pinhole / sphere blend, within [0, 1]
+         */
+        DoubleSphereModel(const CameraIntrinsic &cI_, double xi_, double alpha_) : ProjectionModel(cI_), xi(xi_), alpha(alpha_) {}
+
+        void project(const Points3 &p, Points2 &uv, std::vector<uint8_t> &valid) const override;
+        void projectJacobian(const Points3 &p, Points2 &uv, ProjectionJacobians &J, std::vector<uint8_t> &valid) const override;
+        void unproject(const Points2 &uv, Points3 &rays, std::vector<uint8_t> &valid) const override;
+
+        /**
+         * @brief Create Shared Pointer of DoubleSphereModel object
+         * @return Shared Pointer of DoubleSphereModel
+         */
+        static std::shared_ptr<DoubleSphereModel> create(const CameraIntrinsic &cI_, double xi_, double alpha_) {
+            return std::make_shared<DoubleSphereModel>(cI_, xi_, alpha_);
+        }
+    };
+
+} // namespace StringSLAM
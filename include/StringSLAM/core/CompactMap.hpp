@@ -0,0 +1,130 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+#include "StringSLAM/core/Map.hpp"
+#include <array>
+#include <limits>
+
+namespace StringSLAM
+{
+    /**
+     * @brief Compact, read-only encoding of a Map for large runs.
+     *
+     * - Landmark positions are quantized to resolution, relative to the origin
+     *   of the submap (a cube of about 65536 * resolution) they fall in: 6 bytes
+     *   plus a 2 byte submap index instead of a float triplet in a tree node.
+     * - Observation lists are delta coded (zigzag varints) in one byte stream,
+     *   with an offset every BLOCK landmarks instead of one vector each.
+     * - Descriptors are deduplicated: a keyframe keypoint that created a
+     *   landmark references the landmark's representative instead of its copy.
+     * - Keyframes keep pose, timestamp, keypoint coordinates (fixed point) and
+     *   one descriptor index per keypoint, no image.
+     *
+     * restore() rebuilds a Map with the same IDs, observations and descriptors.
+     * Positions move by at most half the resolution and keypoints by half a
+     * fixed point step (1/16 px up to 8192 px), both far below the noise
+     * tracking works with.
+     */
+    class CompactMap
+    {
+    private:
+        double resolution;
+
+        // -- Below are private variables not specified but used in class. --
+        static constexpr size_t BLOCK = 64;
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+        double cellSize = 0.0;
+        std::vector<std::array<int32_t, 3>> cells;
+
+        // Landmarks in ID order.
+        size_t landmarkCount = 0;
+        std::vector<int16_t> positions;
+        std::vector<uint16_t> landmarkCell;
+        std::vector<uint8_t> observations;
+        std::vector<uint32_t> blockOffset;
+
+        // Descriptor rows, the first landmarkCount are the landmark representatives.
+        std::vector<uint8_t> descriptors;
+        std::vector<bool> hasDescriptor;
+
+        struct Keyframe {
+            int id;
+            int64_t timestamp;
+            float q[4];
+            double t[3];
+            uint32_t kpBegin;
+            uint32_t kpCount;
+        };
+        std::vector<Keyframe> keyframes;
+        float keypointScale = 8.0f;
+        std::vector<uint16_t> keypoints;
+        std::vector<uint32_t> keypointDescriptor;
+
+        void clear();
+        cv::Point3f decodePosition(size_t i) const;
+        size_t seekObservations(size_t i, int &prevFirst) const;
+
+    public:
+        /**
+         * @brief Construct CompactMap
+         * @param resolution_ Landmark position quantization step (m)
+         */
+        explicit CompactMap(double resolution_ = 0.001);
+        ~CompactMap() = default;
+
+        /**
+         * @brief Encode a Map, replacing the current content.
+         * @param map Map, landmark IDs must be 0..n-1 as Map assigns them
+         * @return Encoded, false if the map does not fit (more than 65535 submaps)
+         */
+        bool build(const Map &map);
+
+        /**
+         * @brief Decode into a Map.
+         * @param map Empty Map, its storage mode decides whether descriptors are shared
+         * @return Decoded, false if map was not empty
+         */
+        bool restore(Map &map) const;
+
+        /**
+         * @brief Decode one landmark.
+         * @param id Landmark ID
+         * @param pos Position
+         * @param obs Observing keyframe IDs
+         * @return The landmark exists
+         */
+        bool getLandmark(int id, cv::Point3f &pos, std::vector<int> &obs) const;
+
+        /**
+         * @brief Representative descriptor of a landmark.
+         * @param id Landmark ID
+         * @return DescriptorArena::WIDTH bytes, nullptr if none
+         */
+        const uint8_t *getDescriptor(int id) const;
+
+        /**
+         * @brief Footprint of the encoding.
+         * @return Bytes per landmark and per keyframe
+         */
+        MapMemory getMemoryUsage() const;
+
+        /// @brief Landmarks encoded.
+        inline size_t getLandmarkCount() const { return landmarkCount; }
+
+        /// @brief Keyframes encoded.
+        inline size_t getKeyframeCount() const { return keyframes.size(); }
+
+        /// @brief Landmark position quantization step (m).
+        inline double getResolution() const { return resolution; }
+
+        /**
+         * @brief Create Shared Pointer of CompactMap object
+         * @return Shared Pointer of CompactMap
+         */
+        static std::shared_ptr<CompactMap> create(double resolution_ = 0.001) {
+            return std::make_shared<CompactMap>(resolution_);
+        }
+    };
+
+} // namespace StringSLAM
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <opencv2/core.hpp>
+
+namespace StringSLAM
+{
+    /**
+     * @brief Contiguous storage for binary (ORB) descriptors.
+     *
+     * Every descriptor occupies one 32-byte, 32-byte-aligned slot of a single
+     * buffer and is addressed by a stable index, so frames, keyframes and landmarks
+     * can share descriptors without separate cv::Mat allocations. Slots are reused
+     * through a free list and never move relative to their index; the buffer itself
+     * may be reallocated on growth, so hold indices, not pointers.
+     *
+     * Not thread-safe, the owner (e.g. Map) serializes access.
+     */
+    class DescriptorArena
+    {
+    public:
+        /// Descriptor index inside the arena
+        using Index = uint32_t;
+
+        /// Index of no descriptor
+        static constexpr Index INVALID = std::numeric_limits<Index>::max();
+
+        /// Bytes per descriptor (256-bit ORB)
+        static constexpr size_t WIDTH = 32;
+
+        /// Alignment of every slot
+        static constexpr size_t ALIGN = 32;
+
+    private:
+        struct AlignedFree {
+            void operator()(uint8_t *p) const;
+        };
+
+        std::unique_ptr<uint8_t[], AlignedFree> data;
+        size_t capacity = 0;
+        size_t used = 0;
+
+        // -- Below are private variables not specified but used in class. --
+        // Released slots, reused before the buffer grows.
+        std::vector<Index> freeSlots;
+        std::vector<bool> live;
+
+        void reserveSlots(size_t n);
+        Index allocate();
+
+    public:
+        /**
+         * @brief Construct DescriptorArena
+         * @param reserve_ Descriptors to reserve space for
+         */
+        explicit DescriptorArena(size_t reserve_ = 0);
+        ~DescriptorArena() = default;
+
+        DescriptorArena(const DescriptorArena &) = delete;
+        DescriptorArena &operator=(const DescriptorArena &) = delete;
+
+        /**
+         * @brief Store one descriptor.
+         * @param d WIDTH bytes
+         * @return Index of the stored descriptor
+         */
+        Index add(const uint8_t *d);
+
+        /**
+         * @brief Store every row of a descriptor matrix.
+         * @param desc CV_8U matrix with WIDTH columns (e.g. Frame::desc)
+         * @param out Index of every row
+         * @return desc had the expected layout
+         */
+        bool add(const cv::Mat &desc, std::vector<Index> &out);
+
+        /**
+         * @brief Duplicate a descriptor into a new slot.
+         * @param i Source index
+         * @return Index of the copy
+         */
+        Index copy(Index i);
+
+        /**
+         * @brief Overwrite a stored descriptor.
+         * @param i Index
+         * @param d WIDTH bytes
+         */
+        void set(Index i, const uint8_t *d);
+
+        /**
+         * @brief Release a slot for reuse.
+         * @param i Index
+         */
+        void release(Index i);
+
+        /// @brief Pointer to descriptor i, invalidated when the arena grows.
+        inline const uint8_t *get(Index i) const { return data.get() + size_t(i) * WIDTH; }
+
+        /// @brief Descriptor i is stored.
+        inline bool valid(Index i) const { return i < used && live[i]; }
+
+        /// @brief Slots in use (including released ones still inside the buffer).
+        inline size_t size() const { return used; }
+
+        /**
+         * @brief cv::Mat header over a range of slots, no copy.
+         * @param begin First index
+         * @param count Slots
+         * @return CV_8U matrix of count x WIDTH
+         */
+        cv::Mat view(Index begin, size_t count) const;
+
+        /**
+         * @brief Hamming distance between two descriptors.
+         * @param a WIDTH bytes, ALIGN aligned
+         * @param b WIDTH bytes, ALIGN aligned
+         * @return Differing bits
+         */
+        static int distance(const uint8_t *a, const uint8_t *b);
+
+        /**
+         * @brief Hamming distance from a query to a contiguous range of slots.
+         * @param q Query, WIDTH bytes
+         * @param begin First index
+         * @param count Slots
+         * @param out Distance of every slot
+         */
+        void distances(const uint8_t *q, Index begin, size_t count, int *out) const;
+
+        /**
+         * @brief Best and second best candidate for a query.
+         * @param q Query, WIDTH bytes
+         * @param candidates Candidate indices, sorted indices give a linear sweep
+         * @param n Candidates
+         * @param best Best index (INVALID if none)
+         * @param bestDist Distance of best
+         * @param secondDist Distance of second best
+         */
+        void nearest(const uint8_t *q, const Index *candidates, size_t n, Index &best, int &bestDist, int &secondDist) const;
+
+        /**
+         * @brief Match every row of a descriptor matrix against candidate slots.
+         *
+         * trainIdx of every match is the arena index.
+         * @param query CV_8U matrix with WIDTH columns
+         * @param candidates Candidate indices
+         * @param matches Accepted matches
+         * @param maxDistance Largest accepted distance
+         * @param ratio Lowe ratio between best and second best
+         */
+        void match(const cv::Mat &query, const std::vector<Index> &candidates, std::vector<cv::DMatch> &matches,
+            int maxDistance = 64, float ratio = 0.8f) const;
+
+        /**
+         * @brief Create Shared Pointer of DescriptorArena object
+         * @return Shared Pointer of DescriptorArena
+         */
+        static std::shared_ptr<DescriptorArena> create(size_t reserve_ = 0) {
+            return std::make_shared<DescriptorArena>(reserve_);
+        }
+    };
+
+} // namespace StringSLAM
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace StringSLAM
+{
+    /**
+     * @brief Instruction set extensions a kernel variant can be built for.
+     *
+     * x86 levels are ordered SCALAR < SSE42 < AVX2 < AVX512, ARM levels
+     * SCALAR < NEON < NEON_DOTPROD.
+     */
+    enum class IsaLevel {
+        /// Portable C++
+        SCALAR,
+        /// SSE4.2 with POPCNT
+        SSE42,
+        /// AVX2
+        AVX2,
+        /// AVX-512 F and BW
+        AVX512,
+        /// ARM Advanced SIMD
+        NEON,
+        /// ARM Advanced SIMD with the dot product extension
+        NEON_DOTPROD
+    };
+
+    /**
+     * @brief Instruction set extensions of the running CPU.
+     */
+    struct CpuFeatures {
+        /// SSE4.2 and POPCNT
+        bool sse42 = false;
+
+        /// AVX2
+        bool avx2 = false;
+
+        /// AVX-512 F and BW
+        bool avx512 = false;
+
+        /// ARM Advanced SIMD
+        bool neon = false;
+
+        /// ARM SDOT/UDOT
+        bool dotprod = false;
+
+        /**
+         * @brief Detect the features of this CPU.
+         * @return Features, all false where detection is unsupported
+         */
+        static CpuFeatures detect();
+
+        /**
+         * @brief Whether a level can run on this CPU.
+         * @param level Level
+         * @return Supported
+         */
+        bool supports(IsaLevel level) const;
+
+        /// @brief Highest supported level.
+        IsaLevel best() const;
+    };
+
+    /**
+     * @brief Name of a level, e.g. "avx2".
+     * @param level Level
+     * @return Name
+     */
+    const char *isaName(IsaLevel level);
+
+    /**
+     * @brief Hamming distance kernels for 32-byte (256-bit ORB) descriptors.
+     *
+     * One table per instruction set, the active one is picked at runtime from
+     * CpuFeatures, so a single binary uses AVX2/AVX-512 or NEON where the CPU
+     * has it and stays portable elsewhere.
+     */
+    struct HammingKernels {
+        /// Level the kernels were built for
+        IsaLevel level;
+
+        /// Distance between two descriptors
+        int (*distance)(const uint8_t *a, const uint8_t *b);
+
+        /// Distance from q to count descriptors stored back to back at base
+        void (*distances)(const uint8_t *q, const uint8_t *base, size_t count, int *out);
+    };
+
+    /**
+     * @brief Active Hamming kernels, the best ones for this CPU unless overridden.
+     * @return Kernel table
+     */
+    const HammingKernels &getHammingKernels();
+
+    /**
+     * @brief Select the Hamming kernels, e.g. to compare variants or to cap the level.
+     * @param maxLevel Highest level to use, lowered to what the CPU and the build support
+     * @return Selected level
+     */
+    IsaLevel selectHammingKernels(IsaLevel maxLevel);
+
+} // namespace StringSLAM
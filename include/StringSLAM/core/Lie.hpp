@@ -0,0 +1,433 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <opencv2/core.hpp>
+#include <eigen3/Eigen/Eigen>
+
+namespace StringSLAM
+{
+    /**
+     * @brief A 3D rotation (SO(3)) stored as a unit quaternion.
+     *
+     * Fixed size and stack allocated, no operation allocates. Tangent vectors are
+     * axis-angle (rad).
+     */
+    class SO3
+    {
+    private:
+        Eigen::Quaterniond q;
+
+    public:
+        /// @brief Identity rotation.
+        SO3() : q(Eigen::Quaterniond::Identity()) {}
+
+        /// @brief From a unit quaternion (normalized here).
+        explicit SO3(const Eigen::Quaterniond &q_) : q(q_.normalized()) {}
+
+        /// @brief From a rotation matrix.
+        explicit SO3(const Eigen::Matrix3d &R) : q(Eigen::Quaterniond(R).normalized()) {}
+
+        /**
+         * @brief Skew-symmetric matrix of v.
+         * @param v Vector
+         * @return [v]x
+         */
+        static Eigen::Matrix3d hat(const Eigen::Vector3d &v) {
+            Eigen::Matrix3d S;
+            S <<     0, -v.z(),  v.y(),
+                 v.z(),      0, -v.x(),
+                -v.y(),  v.x(),      0;
+            return S;
+        }
+
+        /**
+         * @brief Exponential map.
+         * @param phi Axis-angle
+         * @return Rotation
+         */
+        static SO3 exp(const Eigen::Vector3d &phi) {
+            const double theta = phi.norm();
+            const double half = 0.5 * theta;
+
+            // Taylor expansion of sin(theta/2)/theta near zero.
+            const double k = theta < 1e-8 ? 0.5 - theta * theta / 48.0 : std::sin(half) / theta;
+            SO3 R;
+            R.q = Eigen::Quaterniond(std::cos(half), k * phi.x(), k * phi.y(), k * phi.z());
+            return R;
+        }
+
+        /**
+         * @brief Logarithm map.
+         * @return Axis-angle
+         */
+        Eigen::Vector3d log() const {
+            // q and -q are the same rotation, pick the one with w >= 0 for the shortest angle.
+            const double sign = q.w() < 0.0 ? -1.0 : 1.0;
+            const Eigen::Vector3d v = sign * q.vec();
+            const double w = sign * q.w();
+            const double n = v.norm();
+            if (n < 1e-8) return 2.0 / w * v;
+            return 2.0 * std::atan2(n, w) / n * v;
+        }
+
+        /**
+         * @brief Right Jacobian of the exponential map.
+         * @param phi Axis-angle
+         * @return Jr(phi)
+         */
+        static Eigen::Matrix3d rightJacobian(const Eigen::Vector3d &phi) {
+            const double theta = phi.norm();
+            const Eigen::Matrix3d S = hat(phi);
+            if (theta < 1e-5) return Eigen::Matrix3d::Identity() - 0.5 * S;
+            const double t2 = theta * theta;
+            return Eigen::Matrix3d::Identity() - (1.0 - std::cos(theta)) / t2 * S + (theta - std::sin(theta)) / (t2 * theta) * S * S;
+        }
+
+        /**
+         * @brief Inverse of the right Jacobian.
+         * @param phi Axis-angle
+         * @return Jr(phi)^-1
+         */
+        static Eigen::Matrix3d rightJacobianInverse(const Eigen::Vector3d &phi) {
+            const double theta = phi.norm();
+            const Eigen::Matrix3d S = hat(phi);
+            if (theta < 1e-5) return Eigen::Matrix3d::Identity() + 0.5 * S;
+            const double t2 = theta * theta;
+            return Eigen::Matrix3d::Identity() + 0.5 * S + (1.0 / t2 - (1.0 + std::cos(theta)) / (2.0 * theta * std::sin(theta))) * S * S;
+        }
+
+        /// @brief Inverse rotation.
+        SO3 inverse() const { SO3 R; R.q = q.conjugate(); return R; }
+
+        /// @brief Composition.
+        SO3 operator*(const SO3 &o) const { SO3 R; R.q = (q * o.q).normalized(); return R; }
+
+        /// @brief Rotate a point.
+        Eigen::Vector3d operator*(const Eigen::Vector3d &p) const { return q * p; }
+
+        /// @brief Rotation matrix.
+        Eigen::Matrix3d matrix() const { return q.toRotationMatrix(); }
+
+        /// @brief Unit quaternion.
+        const Eigen::Quaterniond &quaternion() const { return q; }
+    };
+
+    /**
+     * @brief A rigid 3D transform (SE(3)).
+     *
+     * Tangent vectors are (rho, phi): translation part first, rotation second.
+     * Poses follow the T_to_from convention, Frame::pose is T_world_camera.
+     */
+    class SE3
+    {
+    private:
+        SO3 R;
+        Eigen::Vector3d t;
+
+        // Left Jacobian of SO(3), maps rho to the translation of exp().
+        static Eigen::Matrix3d V(const Eigen::Vector3d &phi) {
+            const double theta = phi.norm();
+            const Eigen::Matrix3d S = SO3::hat(phi);
+            if (theta < 1e-5) return Eigen::Matrix3d::Identity() + 0.5 * S;
+            const double t2 = theta * theta;
+            return Eigen::Matrix3d::Identity() + (1.0 - std::cos(theta)) / t2 * S + (theta - std::sin(theta)) / (t2 * theta) * S * S;
+        }
+
+    public:
+        /// 6-vector tangent type
+        using Tangent = Eigen::Matrix<double, 6, 1>;
+
+        /// @brief Identity transform.
+        SE3() : t(Eigen::Vector3d::Zero()) {}
+
+        /// @brief From rotation and translation.
+        SE3(const SO3 &R_, const Eigen::Vector3d &t_) : R(R_), t(t_) {}
+
+        /// @brief From a rotation matrix and translation.
+        SE3(const Eigen::Matrix3d &R_, const Eigen::Vector3d &t_) : R(R_), t(t_) {}
+
+        /**
+         * @brief Exponential map.
+         * @param xi (rho, phi)
+         * @return Transform
+         */
+        static SE3 exp(const Tangent &xi) {
+            const Eigen::Vector3d phi = xi.tail<3>();
+            return SE3(SO3::exp(phi), V(phi) * xi.head<3>());
+        }
+
+        /**
+         * @brief Logarithm map.
+         * @return (rho, phi)
+         */
+        Tangent log() const {
+            const Eigen::Vector3d phi = R.log();
+            Tangent xi;
+            xi.head<3>() = V(phi).inverse() * t;
+            xi.tail<3>() = phi;
+            return xi;
+        }
+
+        /// @brief Inverse transform.
+        SE3 inverse() const {
+            const SO3 Ri = R.inverse();
+            return SE3(Ri, -(Ri * t));
+        }
+
+        /// @brief Composition.
+        SE3 operator*(const SE3 &o) const { return SE3(R * o.R, R * o.t + t); }
+
+        /// @brief Transform a point.
+        Eigen::Vector3d operator*(const Eigen::Vector3d &p) const { return R * p + t; }
+
+        /**
+         * @brief Transform n points, out may alias in.
+         * @param in Source points
+         * @param out Transformed points
+         * @param n Point count
+         */
+        void transform(const Eigen::Vector3d *in, Eigen::Vector3d *out, size_t n) const {
+            const Eigen::Matrix3d M = R.matrix();
+            for (size_t i = 0; i < n; i++) out[i] = M * in[i] + t;
+        }
+
+        /**
+         * @brief Transform a 3xN block of points without allocating.
+         * @param in Source points (columns)
+         * @param out Transformed points, same size as in and not aliasing it
+         */
+        void transform(const Eigen::Ref<const Eigen::Matrix3Xd> &in, Eigen::Ref<Eigen::Matrix3Xd> out) const {
+            out.noalias() = R.matrix() * in;
+            out.colwise() += t;
+        }
+
+        /// @brief Adjoint (6x6) in the (rho, phi) ordering.
+        Eigen::Matrix<double, 6, 6> adjoint() const {
+            const Eigen::Matrix3d M = R.matrix();
+            Eigen::Matrix<double, 6, 6> A = Eigen::Matrix<double, 6, 6>::Zero();
+            A.block<3, 3>(0, 0) = M;
+            A.block<3, 3>(0, 3) = SO3::hat(t) * M;
+            A.block<3, 3>(3, 3) = M;
+            return A;
+        }
+
+        /// @brief Rotation part.
+        const SO3 &so3() const { return R; }
+
+        /// @brief Rotation matrix.
+        Eigen::Matrix3d rotation() const { return R.matrix(); }
+
+        /// @brief Translation part.
+        const Eigen::Vector3d &translation() const { return t; }
+
+        /// @brief Homogeneous 4x4 matrix.
+        Eigen::Matrix4d matrix() const {
+            Eigen::Matrix4d T = Eigen::Matrix4d::Identity();
+            T.block<3, 3>(0, 0) = R.matrix();
+            T.block<3, 1>(0, 3) = t;
+            return T;
+        }
+
+        /**
+         * @brief Build from OpenCV rotation and translation (API boundary only).
+         * @param Rm 3x3 rotation (CV_32F or CV_64F)
+         * @param tm 3x1 translation (CV_32F or CV_64F)
+         * @return Transform
+         */
+        static SE3 fromCv(const cv::Mat &Rm, const cv::Mat &tm) {
+            cv::Mat Rd, td;
+            Rm.convertTo(Rd, CV_64F);
+            tm.convertTo(td, CV_64F);
+
+            Eigen::Matrix3d Re;
+            for (int r = 0; r < 3; r++)
+                for (int c = 0; c < 3; c++) Re(r, c) = Rd.at<double>(r, c);
+            return SE3(Re, Eigen::Vector3d(td.at<double>(0), td.at<double>(1), td.at<double>(2)));
+        }
+
+        /**
+         * @brief Build from a OpenCV 4x4 homogeneous matrix (API boundary only).
+         * @param T 4x4 transform
+         * @return Transform
+         */
+        static SE3 fromCv(const cv::Mat &T) {
+            return fromCv(T(cv::Range(0, 3), cv::Range(0, 3)), T(cv::Range(0, 3), cv::Range(3, 4)));
+        }
+
+        /**
+         * @brief Convert to OpenCV rotation and translation (API boundary only).
+         * @param Rm 3x3 CV_64F rotation
+         * @param tm 3x1 CV_64F translation
+         */
+        void toCv(cv::Mat &Rm, cv::Mat &tm) const {
+            const Eigen::Matrix3d M = R.matrix();
+            Rm.create(3, 3, CV_64F);
+            tm.create(3, 1, CV_64F);
+            for (int r = 0; r < 3; r++) {
+                for (int c = 0; c < 3; c++) Rm.at<double>(r, c) = M(r, c);
+                tm.at<double>(r) = t(r);
+            }
+        }
+    };
+
+    /**
+     * @brief A similarity transform (Sim(3)): rotation, translation and scale.
+     *
+     * Maps p to s * R * p + t. Used where monocular scale drift has to be
+     * corrected, e.g. loop closure.
+     */
+    class Sim3
+    {
+    private:
+        SO3 R;
+        Eigen::Vector3d t;
+        double s;
+
+    public:
+        /// @brief Identity transform.
+        Sim3() : t(Eigen::Vector3d::Zero()), s(1.0) {}
+
+        /// @brief From rotation, translation and scale.
+        Sim3(const SO3 &R_, const Eigen::Vector3d &t_, double s_) : R(R_), t(t_), s(s_) {}
+
+        /// @brief From a rigid transform (unit scale).
+        explicit Sim3(const SE3 &T) : R(T.so3()), t(T.translation()), s(1.0) {}
+
+        /// @brief Inverse transform.
+        Sim3 inverse() const {
+            const SO3 Ri = R.inverse();
+            return Sim3(Ri, -(Ri * t) / s, 1.0 / s);
+        }
+
+        /// @brief Composition.
+        Sim3 operator*(const Sim3 &o) const { return Sim3(R * o.R, s * (R * o.t) + t, s * o.s); }
+
+        /// @brief Transform a point.
+        Eigen::Vector3d operator*(const Eigen::Vector3d &p) const { return s * (R * p) + t; }
+
+        /// @brief Adjoint (7x7) in the (translation, rotation, log scale) ordering.
+        Eigen::Matrix<double, 7, 7> adjoint() const {
+            const Eigen::Matrix3d M = R.matrix();
+            Eigen::Matrix<double, 7, 7> A = Eigen::Matrix<double, 7, 7>::Zero();
+            A.block<3, 3>(0, 0) = s * M;
+            A.block<3, 3>(0, 3) = SO3::hat(t) * M;
+            A.block<3, 1>(0, 6) = -t;
+            A.block<3, 3>(3, 3) = M;
+            A(6, 6) = 1.0;
+            return A;
+        }
+
+        /// @brief Rotation part.
+        const SO3 &so3() const { return R; }
+
+        /// @brief Translation part.
+        const Eigen::Vector3d &translation() const { return t; }
+
+        /// @brief Scale.
+        double scale() const { return s; }
+
+        /// @brief Drop the scale, the rotation and translation are kept.
+        SE3 toSE3() const { return SE3(R, t); }
+    };
+
+    /**
+     * @brief A rigid 2D transform (SE(2)).
+     *
+     * Tangent vectors are (x, y, theta) with the translation part first.
+     */
+    class SE2
+    {
+    private:
+        double theta;
+        Eigen::Vector2d t;
+
+    public:
+        /// @brief Identity transform.
+        SE2() : theta(0.0), t(Eigen::Vector2d::Zero()) {}
+
+        /// @brief From angle and translation.
+        SE2(double theta_, const Eigen::Vector2d &t_) : theta(theta_), t(t_) {}
+
+        /**
+         * @brief Exponential map.
+         * @param xi (x, y, theta)
+         * @return Transform
+         */
+        static SE2 exp(const Eigen::Vector3d &xi) {
+            const double th = xi.z();
+            double a, b;
+            if (std::abs(th) < 1e-8) {
+                a = 1.0 - th * th / 6.0;
+                b = 0.5 * th;
+            } else {
+                a = std::sin(th) / th;
+                b = (1.0 - std::cos(th)) / th;
+            }
+            return SE2(th, Eigen::Vector2d(a * xi.x() - b * xi.y(), b * xi.x() + a * xi.y()));
+        }
+
+        /**
+         * @brief Logarithm map.
+         * @return (x, y, theta)
+         */
+        Eigen::Vector3d log() const {
+            double a, b;
+            if (std::abs(theta) < 1e-8) {
+                a = 1.0 - theta * theta / 6.0;
+                b = 0.5 * theta;
+            } else {
+                a = std::sin(theta) / theta;
+                b = (1.0 - std::cos(theta)) / theta;
+            }
+            // Inverse of [[a, -b], [b, a]].
+            const double d = a * a + b * b;
+            return Eigen::Vector3d((a * t.x() + b * t.y()) / d, (-b * t.x() + a * t.y()) / d, theta);
+        }
+
+        /// @brief Inverse transform.
+        SE2 inverse() const {
+            const double c = std::cos(theta), s = std::sin(theta);
+            return SE2(-theta, Eigen::Vector2d(-(c * t.x() + s * t.y()), -(-s * t.x() + c * t.y())));
+        }
+
+        /// @brief Composition.
+        SE2 operator*(const SE2 &o) const { return SE2(std::remainder(theta + o.theta, 2.0 * EIGEN_PI), (*this) * o.t); }
+
+        /// @brief Transform a point.
+        Eigen::Vector2d operator*(const Eigen::Vector2d &p) const {
+            const double c = std::cos(theta), s = std::sin(theta);
+            return Eigen::Vector2d(c * p.x() - s * p.y() + t.x(), s * p.x() + c * p.y() + t.y());
+        }
+
+        /**
+         * @brief Transform n points, out may alias in.
+         * @param in Source points
+         * @param out Transformed points
+         * @param n Point count
+         */
+        void transform(const Eigen::Vector2d *in, Eigen::Vector2d *out, size_t n) const {
+            const double c = std::cos(theta), s = std::sin(theta);
+            for (size_t i = 0; i < n; i++) {
+                const Eigen::Vector2d p = in[i];
+                out[i] = Eigen::Vector2d(c * p.x() - s * p.y() + t.x(), s * p.x() + c * p.y() + t.y());
+            }
+        }
+
+        /// @brief Rotation angle (rad).
+        double angle() const { return theta; }
+
+        /// @brief Translation part.
+        const Eigen::Vector2d &translation() const { return t; }
+
+        /// @brief Homogeneous 3x3 matrix.
+        Eigen::Matrix3d matrix() const {
+            const double c = std::cos(theta), s = std::sin(theta);
+            Eigen::Matrix3d T = Eigen::Matrix3d::Identity();
+            T(0, 0) = c; T(0, 1) = -s; T(0, 2) = t.x();
+            T(1, 0) = s; T(1, 1) =  c; T(1, 2) = t.y();
+            return T;
+        }
+    };
+
+} // namespace StringSLAM
@@ -1,6 +1,11 @@
 #pragma once
 #include "StringSLAM/core.hpp"
+#include <algorithm>
+#include <cstring>
+#include <deque>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include "opencv2/core/types.hpp"
 
 namespace StringSLAM
@@ -14,27 +19,277 @@ namespace StringSLAM
 
         /// @brief List of frame ID's that can see the initialized point.
         std::vector<int> observations;
+
+        /// @brief Representative descriptor, a slot of the owning Map's DescriptorArena.
+        DescriptorArena::Index descriptor = DescriptorArena::INVALID;
+    };
+
+    /**
+     * @brief How a Map stores its keyframes.
+     */
+    enum class MapStorage {
+        /// Keyframes are full Frame copies (image, descriptors, undistorted keypoints)
+        FULL,
+        /// Keyframes keep pose, keypoints and descriptor slots, landmarks share the slot they were created from
+        COMPACT
+    };
+
+    /**
+     * @brief Heap footprint of a map, split between landmarks and keyframes.
+     */
+    struct MapMemory {
+        /// Landmarks counted
+        size_t landmarks = 0;
+
+        /// Keyframes counted
+        size_t keyframes = 0;
+
+        /// Bytes of the landmarks: positions, observations and representative descriptors
+        size_t landmarkBytes = 0;
+
+        /// Bytes of the keyframes: poses, keypoints, descriptors, images and graph links
+        size_t keyframeBytes = 0;
+
+        /// @brief Total bytes.
+        inline size_t totalBytes() const { return landmarkBytes + keyframeBytes; }
+
+        /// @brief Mean bytes per landmark.
+        inline double bytesPerLandmark() const { return landmarks ? double(landmarkBytes) / double(landmarks) : 0.0; }
+
+        /// @brief Mean bytes per keyframe.
+        inline double bytesPerKeyframe() const { return keyframes ? double(keyframeBytes) / double(keyframes) : 0.0; }
+    };
+
+    /**
+     * @brief Kind of a Map modification.
+     */
+    enum class MapChangeType : uint8_t {
+        LANDMARK_ADDED,
+        LANDMARK_MOVED,
+        /// Not produced by Map itself (landmarks are never erased), reserved for consumers
+        LANDMARK_REMOVED,
+        KEYFRAME_ADDED,
+        KEYFRAME_MOVED
+    };
+
+    /**
+     * @brief One entry of the Map change log.
+     */
+    struct MapChange {
+        /// Map revision right after the change
+        uint64_t revision;
+
+        /// Landmark or keyframe ID
+        int id;
+
+        /// Kind
+        MapChangeType type;
     };
 
     /**
      * @brief A class meant to manage landmarks and keyframes.
+     *
+     * Keyframes are linked by a covisibility graph weighted by the landmarks they
+     * share, and by a spanning tree over the strongest links. Both are updated as
+     * observations are added, so neighbourhood queries only touch the local map.
      */
     class Map
     {
     private:
+        // Covisibility links and spanning tree position of a keyframe.
+        struct CovisibilityNode {
+            // (keyframe, shared landmarks), heaviest first.
+            std::vector<std::pair<int, int>> neighbours;
+
+            // Position of every neighbour inside neighbours.
+            std::unordered_map<int, size_t> index;
+
+            int parent = -1;
+            std::vector<int> children;
+        };
+
         std::map<int, Frame> keyframes;
         std::map<int, MapPoint> landmarks;
+
+        // Descriptors of every keyframe and landmark.
+        std::shared_ptr<DescriptorArena> arena = DescriptorArena::create();
+
+        // -- Below are private variables not specified but used in class. --
+        // Landmark ID owning each arena slot (-1 for keyframe slots).
+        std::vector<int> slotLandmark;
+
+        // Landmarks observed by every keyframe.
+        std::map<int, std::vector<int>> keyframeLandmarks;
+
+        // Covisibility graph and spanning tree, rooted at the first keyframe.
+        std::unordered_map<int, CovisibilityNode> covisibility;
+        int spanningRoot = -1;
+
+        // Inverted index of landmark descriptors: word -> arena slots. A word is
+        // WORD_BITS sampled descriptor bits, every table samples other bits so a
+        // match that differs in one table's bits can still share another's.
+        static constexpr int WORD_TABLES = 4;
+        static constexpr int WORD_BITS = 12;
+        std::unordered_map<uint32_t, std::vector<DescriptorArena::Index>> landmarkWords;
+
+        MapStorage storage = MapStorage::FULL;
+
+        // Every modification bumps revision, the log keeps them while enabled.
+        uint64_t revision = 0;
+        bool changeLog = false;
+        std::deque<MapChange> changes;
+
+        inline void changed(MapChangeType type, int id) {
+            revision++;
+            if (changeLog) changes.push_back({revision, id, type});
+        }
+
+        inline bool landmarkSlot(DescriptorArena::Index i) const {
+            return i < slotLandmark.size() && slotLandmark[i] >= 0;
+        }
+
+        // Slots shared with a landmark stay with the landmark.
+        void releaseSlots(const std::vector<DescriptorArena::Index> &slots) {
+            for (auto i : slots)
+                if (!landmarkSlot(i)) arena->release(i);
+        }
+
+        // Drop everything of a keyframe but its pose, keypoints and descriptor slots.
+        static void strip(Frame &kf) {
+            kf.frame.release();
+            kf.desc.release();
+            std::vector<cv::Point2f>().swap(kf.kpUndistorted);
+            kf.kp.shrink_to_fit();
+            kf.raw = RawBuffer();
+        }
+
+        bool inSpanningTree(int kf) const {
+            auto it = covisibility.find(kf);
+            return kf == spanningRoot || (it != covisibility.end() && it->second.parent >= 0);
+        }
+
+        // Attach kf below parent, then pull in every neighbour that is still detached.
+        void attach(int kf, int parent) {
+            std::vector<std::pair<int, int>> pending{{kf, parent}};
+            while (!pending.empty()) {
+                auto [k, p] = pending.back();
+                pending.pop_back();
+                if (inSpanningTree(k)) continue;
+
+                CovisibilityNode &node = covisibility[k];
+                node.parent = p;
+                covisibility[p].children.push_back(k);
+                for (auto it = node.neighbours.rbegin(); it != node.neighbours.rend(); ++it)
+                    if (!inSpanningTree(it->first)) pending.emplace_back(it->first, k);
+            }
+        }
+
+        // Change the weight of the directed link a -> b, keeping neighbours sorted.
+        void adjustLink(int a, int b, int delta) {
+            CovisibilityNode &node = covisibility[a];
+            auto &nb = node.neighbours;
+            auto it = node.index.find(b);
+            if (it == node.index.end()) {
+                if (delta <= 0) return;
+                it = node.index.emplace(b, nb.size()).first;
+                nb.emplace_back(b, 0);
+            }
+
+            size_t i = it->second;
+            nb[i].second += delta;
+            while (i > 0 && nb[i - 1].second < nb[i].second) {
+                std::swap(nb[i - 1], nb[i]);
+                node.index[nb[i].first] = i;
+                node.index[nb[i - 1].first] = i - 1;
+                i--;
+            }
+            while (i + 1 < nb.size() && nb[i + 1].second > nb[i].second) {
+                std::swap(nb[i + 1], nb[i]);
+                node.index[nb[i].first] = i;
+                node.index[nb[i + 1].first] = i + 1;
+                i++;
+            }
+
+            if (nb[i].second <= 0) {
+                // Links only reach zero when observations are erased, which is rare.
+                nb.erase(nb.begin() + i);
+                node.index.erase(b);
+                for (size_t j = i; j < nb.size(); j++) node.index[nb[j].first] = j;
+            }
+        }
+
+        // Update the graph for a landmark seen by kf and the keyframes in others.
+        void connect(int kf, const std::vector<int> &others) {
+            for (int o : others) {
+                if (o == kf) continue;
+                adjustLink(kf, o, 1);
+                adjustLink(o, kf, 1);
+
+                if (inSpanningTree(o) && !inSpanningTree(kf)) attach(kf, o);
+                else if (inSpanningTree(kf) && !inSpanningTree(o)) attach(o, kf);
+            }
+        }
+
+        // Word of a descriptor in a table, tables sample disjoint, spread out bits.
+        static uint32_t word(const uint8_t *d, int table) {
+            uint32_t w = uint32_t(table) << WORD_BITS;
+            for (int j = 0; j < WORD_BITS; j++) {
+                const int bit = (table * 13 + j * 21) % int(DescriptorArena::WIDTH * 8);
+                w |= uint32_t((d[bit >> 3] >> (bit & 7)) & 1) << j;
+            }
+            return w;
+        }
+
+        void indexLandmark(DescriptorArena::Index slot) {
+            const uint8_t *d = arena->get(slot);
+            for (int t = 0; t < WORD_TABLES; t++) landmarkWords[word(d, t)].push_back(slot);
+        }
+
+        void registerLandmark(int id, const MapPoint &mp) {
+            for (size_t i = 0; i < mp.observations.size(); i++) {
+                keyframeLandmarks[mp.observations[i]].push_back(id);
+                connect(mp.observations[i], std::vector<int>(mp.observations.begin(), mp.observations.begin() + i));
+            }
+        }
+
     public:
         /// @brief Create Constructor
         Map() = default;
         ~Map() = default;
 
+        /**
+         * @brief Set how keyframes are stored.
+         *
+         * Switching to MapStorage::COMPACT also strips the keyframes already stored.
+         * @param storage_ Storage mode
+         */
+        inline void setStorage(MapStorage storage_) {
+            storage = storage_;
+            if (storage == MapStorage::COMPACT)
+                for (auto &[id, kf] : keyframes) strip(kf);
+        }
+
+        /// @brief How keyframes are stored.
+        inline MapStorage getStorage() const { return storage; }
+
         /**
          * @brief Add keyframe to Map
+         *
+         * The descriptors of the frame are moved into the arena, Frame::descIdx holds their slots.
          * @param f Linked frame
          */
         inline void addKeyframe(const Frame& f) {
-            keyframes[f.id] = f;
+            auto it = keyframes.find(f.id);
+            if (it != keyframes.end()) releaseSlots(it->second.descIdx);
+
+            Frame &kf = keyframes[f.id];
+            kf = f;
+            if (!arena->add(f.desc, kf.descIdx)) kf.descIdx.clear();
+            if (storage == MapStorage::COMPACT) strip(kf);
+
+            covisibility[f.id];
+            if (spanningRoot < 0) spanningRoot = f.id;
+            changed(MapChangeType::KEYFRAME_ADDED, f.id);
         }
 
         /**
@@ -42,9 +297,542 @@ namespace StringSLAM
          * @param mp Observed point
          */
         inline void addLandmark(const MapPoint& mp) {
-            landmarks[landmarks.size()] = mp;
+            int id = int(landmarks.size());
+            landmarks[id] = mp;
+            registerLandmark(id, mp);
+            changed(MapChangeType::LANDMARK_ADDED, id);
+        }
+
+        /**
+         * @brief Add landmark to Map, taking its descriptor from a keyframe observation.
+         *
+         * With MapStorage::COMPACT the landmark shares the keyframe slot instead of copying it.
+         * @param mp Observed point
+         * @param kfId Keyframe ID
+         * @param kpIdx Keypoint index inside the keyframe
+         * @return Landmark ID
+         */
+        inline int addLandmark(const MapPoint& mp, int kfId, int kpIdx) {
+            int id = int(landmarks.size());
+            MapPoint &lm = landmarks[id];
+            lm = mp;
+            registerLandmark(id, mp);
+            changed(MapChangeType::LANDMARK_ADDED, id);
+
+            auto it = keyframes.find(kfId);
+            if (it != keyframes.end() && kpIdx >= 0 && size_t(kpIdx) < it->second.descIdx.size()) {
+                const DescriptorArena::Index slot = it->second.descIdx[kpIdx];
+                lm.descriptor = storage == MapStorage::COMPACT && !landmarkSlot(slot) ? slot : arena->copy(slot);
+                if (slotLandmark.size() <= lm.descriptor) slotLandmark.resize(lm.descriptor + 1, -1);
+                slotLandmark[lm.descriptor] = id;
+                indexLandmark(lm.descriptor);
+            }
+            return id;
+        }
+
+        /**
+         * @brief Add landmark to Map with a descriptor of its own (e.g. decoded from a CompactMap).
+         * @param mp Observed point
+         * @param descriptor DescriptorArena::WIDTH bytes, nullptr for none
+         * @return Landmark ID
+         */
+        inline int addLandmark(const MapPoint& mp, const uint8_t *descriptor) {
+            int id = int(landmarks.size());
+            MapPoint &lm = landmarks[id];
+            lm = mp;
+            registerLandmark(id, mp);
+            changed(MapChangeType::LANDMARK_ADDED, id);
+
+            lm.descriptor = DescriptorArena::INVALID;
+            if (descriptor) {
+                lm.descriptor = arena->add(descriptor);
+                if (slotLandmark.size() <= lm.descriptor) slotLandmark.resize(lm.descriptor + 1, -1);
+                slotLandmark[lm.descriptor] = id;
+                indexLandmark(lm.descriptor);
+            }
+            return id;
+        }
+
+        /**
+         * @brief Record that a keyframe observes an existing landmark.
+         * @param lmId Landmark ID
+         * @param kfId Keyframe ID
+         * @return The observation is new
+         */
+        inline bool addObservation(int lmId, int kfId) {
+            auto it = landmarks.find(lmId);
+            if (it == landmarks.end()) return false;
+            auto &obs = it->second.observations;
+            if (std::find(obs.begin(), obs.end(), kfId) != obs.end()) return false;
+
+            connect(kfId, obs);
+            obs.push_back(kfId);
+            keyframeLandmarks[kfId].push_back(lmId);
+            return true;
+        }
+
+        /**
+         * @brief Remove an observation (e.g. an outlier after optimization).
+         *
+         * The spanning tree is left as is.
+         * @param lmId Landmark ID
+         * @param kfId Keyframe ID
+         * @return The observation existed
+         */
+        inline bool eraseObservation(int lmId, int kfId) {
+            auto it = landmarks.find(lmId);
+            if (it == landmarks.end()) return false;
+            auto &obs = it->second.observations;
+            auto o = std::find(obs.begin(), obs.end(), kfId);
+            if (o == obs.end()) return false;
+            obs.erase(o);
+
+            for (int other : obs) {
+                adjustLink(kfId, other, -1);
+                adjustLink(other, kfId, -1);
+            }
+            auto &lms = keyframeLandmarks[kfId];
+            lms.erase(std::remove(lms.begin(), lms.end(), lmId), lms.end());
+            return true;
+        }
+
+        /**
+         * @brief Replace the pose of a keyframe (e.g. after optimization).
+         * @param id Keyframe ID
+         * @param pose T_world_camera
+         */
+        inline void setKeyframePose(int id, const SE3 &pose) {
+            auto it = keyframes.find(id);
+            if (it == keyframes.end()) return;
+            it->second.pose = pose;
+            changed(MapChangeType::KEYFRAME_MOVED, id);
+        }
+
+        /**
+         * @brief Move a landmark (e.g. after optimization).
+         * @param id Landmark ID
+         * @param pos New position
+         */
+        inline void setLandmarkPosition(int id, const cv::Point3f &pos) {
+            auto it = landmarks.find(id);
+            if (it == landmarks.end()) return;
+            it->second.pos = pos;
+            changed(MapChangeType::LANDMARK_MOVED, id);
+        }
+
+        /**
+         * @brief Keep a log of added and moved landmarks and keyframes, for incremental export.
+         *
+         * The log grows until trimChanges(), disabling it drops it.
+         * @param enabled Log changes
+         */
+        inline void setChangeLog(bool enabled) {
+            changeLog = enabled;
+            if (!changeLog) changes.clear();
+        }
+
+        /// @brief Changes are logged.
+        inline bool getChangeLog() const { return changeLog; }
+
+        /// @brief Count of modifications so far, IDs and positions are unchanged while it is.
+        inline uint64_t getRevision() const { return revision; }
+
+        /**
+         * @brief Get the logged changes after a revision, oldest first.
+         * @param since Revision already seen
+         * @param out Changes, an ID appears once per modification
+         */
+        inline void getChanges(uint64_t since, std::vector<MapChange> &out) const {
+            out.clear();
+            auto it = std::upper_bound(changes.begin(), changes.end(), since,
+                [](uint64_t r, const MapChange &c) { return r < c.revision; });
+            out.assign(it, changes.end());
+        }
+
+        /**
+         * @brief Drop the logged changes up to a revision, once every consumer has seen them.
+         * @param upTo Last revision to drop
+         */
+        inline void trimChanges(uint64_t upTo) {
+            while (!changes.empty() && changes.front().revision <= upTo) changes.pop_front();
+        }
+
+        /**
+         * @brief Match the descriptors of a frame against every landmark in one sweep of the arena.
+         * @param f Frame with descriptors
+         * @param matches queryIdx is the keypoint index, trainIdx the landmark ID
+         * @param maxDistance Largest accepted Hamming distance
+         * @param ratio Lowe ratio between best and second best
+         */
+        void matchLandmarks(const Frame &f, std::vector<cv::DMatch> &matches, int maxDistance = 64, float ratio = 0.8f) const {
+            std::vector<int> ids;
+            ids.reserve(landmarks.size());
+            for (auto &[id, lm] : landmarks) ids.push_back(id);
+            matchLandmarks(f.desc, ids, matches, maxDistance, ratio);
+        }
+
+        /**
+         * @brief Match descriptors against a subset of landmarks.
+         * @param desc Descriptors (e.g. Frame::desc)
+         * @param ids Landmark IDs to match against
+         * @param matches queryIdx is the descriptor row, trainIdx the landmark ID
+         * @param maxDistance Largest accepted Hamming distance
+         * @param ratio Lowe ratio between best and second best
+         */
+        void matchLandmarks(const cv::Mat &desc, const std::vector<int> &ids, std::vector<cv::DMatch> &matches,
+            int maxDistance = 64, float ratio = 0.8f) const {
+            std::vector<DescriptorArena::Index> candidates;
+            candidates.reserve(ids.size());
+            for (int id : ids) {
+                auto it = landmarks.find(id);
+                if (it != landmarks.end() && it->second.descriptor != DescriptorArena::INVALID)
+                    candidates.push_back(it->second.descriptor);
+            }
+
+            // Ascending slots turn the gather into a forward walk through memory.
+            std::sort(candidates.begin(), candidates.end());
+            arena->match(desc, candidates, matches, maxDistance, ratio);
+            for (auto &m : matches) m.trainIdx = slotLandmark[m.trainIdx];
+        }
+
+        /**
+         * @brief Rank keyframes by how many landmarks they share with a set of landmark matches.
+         * @param matches Matches from matchLandmarks()
+         * @param maxCandidates Keyframes to return
+         * @param kfIds Keyframe IDs, most shared landmarks first
+         */
+        void getKeyframeCandidates(const std::vector<cv::DMatch> &matches, size_t maxCandidates, std::vector<int> &kfIds) const {
+            std::map<int, int> votes;
+            for (auto &m : matches) {
+                auto it = landmarks.find(m.trainIdx);
+                if (it == landmarks.end()) continue;
+                for (int kf : it->second.observations) votes[kf]++;
+            }
+
+            std::vector<std::pair<int, int>> ranked(votes.begin(), votes.end());
+            std::sort(ranked.begin(), ranked.end(), [](auto &a, auto &b) { return a.second > b.second; });
+
+            kfIds.clear();
+            for (size_t i = 0; i < ranked.size() && i < maxCandidates; i++) kfIds.push_back(ranked[i].first);
+        }
+
+        /**
+         * @brief Rank keyframes by the landmarks a set of descriptors matches, through the word index.
+         *
+         * Every descriptor is only compared with the landmarks sharing one of its
+         * words, so the cost follows the bucket sizes instead of the map size. The
+         * matches are approximate (some are missed), good enough to pick the
+         * keyframes a full matchLandmarks() on their landmarks is then run against.
+         * @param desc Descriptors (e.g. Frame::desc)
+         * @param maxCandidates Keyframes to return
+         * @param kfIds Keyframe IDs, most matched landmarks first
+         * @param maxDistance Largest accepted Hamming distance
+         */
+        void getKeyframeCandidates(const cv::Mat &desc, size_t maxCandidates, std::vector<int> &kfIds, int maxDistance = 64) const {
+            kfIds.clear();
+            if (desc.empty() || desc.depth() != CV_8U || size_t(desc.cols) * desc.elemSize() != DescriptorArena::WIDTH) return;
+
+            std::unordered_map<int, int> votes;
+            alignas(DescriptorArena::ALIGN) uint8_t q[DescriptorArena::WIDTH];
+            for (int r = 0; r < desc.rows; r++) {
+                std::memcpy(q, desc.ptr<uint8_t>(r), DescriptorArena::WIDTH);
+
+                DescriptorArena::Index best = DescriptorArena::INVALID;
+                int bestDist = maxDistance + 1;
+                for (int t = 0; t < WORD_TABLES; t++) {
+                    auto it = landmarkWords.find(word(q, t));
+                    if (it == landmarkWords.end()) continue;
+
+                    DescriptorArena::Index i;
+                    int d, second;
+                    arena->nearest(q, it->second.data(), it->second.size(), i, d, second);
+                    if (i != DescriptorArena::INVALID && d < bestDist) {
+                        best = i;
+                        bestDist = d;
+                    }
+                }
+                if (best == DescriptorArena::INVALID) continue;
+
+                auto lm = landmarks.find(slotLandmark[best]);
+                if (lm == landmarks.end()) continue;
+                for (int kf : lm->second.observations) votes[kf]++;
+            }
+
+            std::vector<std::pair<int, int>> ranked(votes.begin(), votes.end());
+            std::sort(ranked.begin(), ranked.end(), [](auto &a, auto &b) { return a.second > b.second || (a.second == b.second && a.first < b.first); });
+            for (size_t i = 0; i < ranked.size() && i < maxCandidates; i++) kfIds.push_back(ranked[i].first);
+        }
+
+        /**
+         * @brief Get the landmarks observed by a keyframe.
+         * @param kfId Keyframe ID
+         * @return Landmark IDs
+         */
+        const std::vector<int> &getKeyframeLandmarks(int kfId) const {
+            static const std::vector<int> none;
+            auto it = keyframeLandmarks.find(kfId);
+            return it == keyframeLandmarks.end() ? none : it->second;
+        }
+
+        /**
+         * @brief Get the landmarks two keyframes share.
+         * @param a Keyframe ID
+         * @param b Keyframe ID
+         * @return Covisibility weight, 0 if not linked
+         */
+        int getCovisibilityWeight(int a, int b) const {
+            auto it = covisibility.find(a);
+            if (it == covisibility.end()) return 0;
+            auto n = it->second.index.find(b);
+            return n == it->second.index.end() ? 0 : it->second.neighbours[n->second].second;
+        }
+
+        /**
+         * @brief Get every covisible keyframe.
+         * @param kfId Keyframe ID
+         * @return (keyframe ID, shared landmarks), heaviest first
+         */
+        const std::vector<std::pair<int, int>> &getCovisibleKeyframes(int kfId) const {
+            static const std::vector<std::pair<int, int>> none;
+            auto it = covisibility.find(kfId);
+            return it == covisibility.end() ? none : it->second.neighbours;
+        }
+
+        /**
+         * @brief Get the best covisible keyframes.
+         * @param kfId Keyframe ID
+         * @param k Keyframes to return at most
+         * @param kfIds Keyframe IDs, heaviest first
+         * @param minWeight Smallest number of shared landmarks
+         */
+        void getCovisibleKeyframes(int kfId, size_t k, std::vector<int> &kfIds, int minWeight = 1) const {
+            kfIds.clear();
+            for (auto &[id, w] : getCovisibleKeyframes(kfId)) {
+                if (kfIds.size() >= k || w < minWeight) break;
+                kfIds.push_back(id);
+            }
+        }
+
+        /**
+         * @brief Get the parent of a keyframe in the spanning tree.
+         * @param kfId Keyframe ID
+         * @return Parent keyframe ID, -1 for the root or detached keyframes
+         */
+        int getSpanningParent(int kfId) const {
+            auto it = covisibility.find(kfId);
+            return it == covisibility.end() ? -1 : it->second.parent;
+        }
+
+        /**
+         * @brief Get the children of a keyframe in the spanning tree.
+         * @param kfId Keyframe ID
+         * @return Child keyframe IDs
+         */
+        const std::vector<int> &getSpanningChildren(int kfId) const {
+            static const std::vector<int> none;
+            auto it = covisibility.find(kfId);
+            return it == covisibility.end() ? none : it->second.children;
+        }
+
+        /**
+         * @brief Get the landmarks observed by a set of keyframes.
+         * @param kfIds Keyframe IDs
+         * @param lmIds Landmark IDs, each once and ascending
+         */
+        void getLocalLandmarks(const std::vector<int> &kfIds, std::vector<int> &lmIds) const {
+            lmIds.clear();
+            for (int kf : kfIds) {
+                const auto &lms = getKeyframeLandmarks(kf);
+                lmIds.insert(lmIds.end(), lms.begin(), lms.end());
+            }
+            std::sort(lmIds.begin(), lmIds.end());
+            lmIds.erase(std::unique(lmIds.begin(), lmIds.end()), lmIds.end());
+        }
+
+        /**
+         * @brief Get the local map around a tracked frame.
+         *
+         * Keyframes observing the tracked landmarks are ranked by how many they see,
+         * then extended by their best covisible keyframes and spanning tree
+         * neighbours. The cost depends on the neighbourhood only, not on the map size.
+         * @param trackedLandmarks Landmark IDs matched in the frame
+         * @param maxKeyframes Keyframes to return at most
+         * @param kfIds Local keyframe IDs, the keyframe sharing most landmarks first
+         * @param lmIds Landmarks of the local keyframes, each once and ascending
+         * @param neighbours Covisible keyframes added per local keyframe
+         */
+        void getLocalMap(const std::vector<int> &trackedLandmarks, size_t maxKeyframes, std::vector<int> &kfIds,
+            std::vector<int> &lmIds, size_t neighbours = 10) const {
+            std::unordered_map<int, int> votes;
+            for (int lmId : trackedLandmarks) {
+                auto it = landmarks.find(lmId);
+                if (it == landmarks.end()) continue;
+                for (int kf : it->second.observations) votes[kf]++;
+            }
+
+            std::vector<std::pair<int, int>> ranked(votes.begin(), votes.end());
+            std::sort(ranked.begin(), ranked.end(), [](auto &a, auto &b) { return a.second > b.second; });
+
+            kfIds.clear();
+            std::unordered_set<int> seen;
+            auto push = [&](int id) {
+                if (id >= 0 && kfIds.size() < maxKeyframes && seen.insert(id).second) kfIds.push_back(id);
+            };
+            for (auto &[id, n] : ranked) push(id);
+
+            // Extend around the keyframes that see the frame, not around their extensions.
+            const size_t direct = kfIds.size();
+            for (size_t i = 0; i < direct && kfIds.size() < maxKeyframes; i++) {
+                const auto &nb = getCovisibleKeyframes(kfIds[i]);
+                for (size_t j = 0; j < nb.size() && j < neighbours; j++) push(nb[j].first);
+                for (int c : getSpanningChildren(kfIds[i])) push(c);
+                push(getSpanningParent(kfIds[i]));
+            }
+
+            getLocalLandmarks(kfIds, lmIds);
+        }
+
+        /**
+         * @brief Estimate the heap footprint of the map.
+         *
+         * Containers count their capacity plus an allocator overhead per node.
+         * Descriptors shared by a keyframe and a landmark count for the landmark,
+         * keyframe images count in full even when shared with the caller.
+         * @return Footprint
+         */
+        MapMemory getMemoryUsage() const {
+            constexpr size_t NODE = 4 * sizeof(void *);
+            constexpr size_t WIDTH = DescriptorArena::WIDTH;
+            MapMemory m;
+            m.landmarks = landmarks.size();
+            m.keyframes = keyframes.size();
+
+            for (auto &[id, lm] : landmarks) {
+                m.landmarkBytes += NODE + sizeof(id) + sizeof(lm) + lm.observations.capacity() * sizeof(int);
+                if (lm.descriptor != DescriptorArena::INVALID) m.landmarkBytes += WIDTH + sizeof(int);
+            }
+            for (auto &[w, slots] : landmarkWords)
+                m.landmarkBytes += NODE + sizeof(w) + sizeof(slots) + slots.capacity() * sizeof(DescriptorArena::Index);
+            m.landmarkBytes += landmarkWords.bucket_count() * sizeof(void *);
+
+            for (auto &[id, kf] : keyframes) {
+                m.keyframeBytes += NODE + sizeof(id) + sizeof(kf) + kf.kp.capacity() * sizeof(cv::KeyPoint) +
+                    kf.kpUndistorted.capacity() * sizeof(cv::Point2f) + kf.descIdx.capacity() * sizeof(DescriptorArena::Index);
+                if (!kf.frame.empty()) m.keyframeBytes += kf.frame.total() * kf.frame.elemSize();
+                if (!kf.desc.empty()) m.keyframeBytes += kf.desc.total() * kf.desc.elemSize();
+                for (auto i : kf.descIdx)
+                    if (!landmarkSlot(i)) m.keyframeBytes += WIDTH + sizeof(int);
+            }
+
+            for (auto &[id, lms] : keyframeLandmarks) m.keyframeBytes += NODE + sizeof(id) + sizeof(lms) + lms.capacity() * sizeof(int);
+            for (auto &[id, node] : covisibility) {
+                m.keyframeBytes += NODE + sizeof(id) + sizeof(node) + node.neighbours.capacity() * sizeof(std::pair<int, int>) +
+                    node.index.size() * (NODE + sizeof(std::pair<const int, size_t>)) + node.index.bucket_count() * sizeof(void *) +
+                    node.children.capacity() * sizeof(int);
+            }
+            return m;
         }
 
+        /**
+         * @brief Upper bound of what inserting a keyframe adds to getMemoryUsage().
+         *
+         * Covers addKeyframe() with the current MapStorage, an observation for every
+         * keypoint with a landmark, and a new landmark, observed by f and partner,
+         * for every keypoint without one. Vector and hash table growth is bounded
+         * from the current capacities, so the real growth never exceeds it.
+         * @param f Keyframe
+         * @param kpLandmark Landmark of every keypoint of f, -1 where one may be created
+         * @param partner Keyframe that observes the new landmarks too, -1 for none
+         * @return Bytes
+         */
+        size_t estimateInsertion(const Frame &f, const std::vector<int> &kpLandmark, int partner = -1) const {
+            constexpr size_t NODE = 4 * sizeof(void *);
+            constexpr size_t WIDTH = DescriptorArena::WIDTH;
+            const bool compact = storage == MapStorage::COMPACT;
+            const size_t descriptors = f.desc.empty() ? 0 : size_t(f.desc.rows);
+
+            // Push backs double a full vector, a hash table at load 1 rehashes to the next prime of twice its buckets.
+            auto vectorGrowth = [](size_t size, size_t capacity, size_t added, size_t elem) {
+                return size + added > capacity ? (2 * (size + added) - capacity) * elem : size_t(0);
+            };
+            auto bucketGrowth = [](size_t size, size_t buckets, size_t added) {
+                const size_t target = std::max(size + added, 2 * buckets);
+                return size + added > buckets ? (target + target / 8 + 16 - buckets) * sizeof(void *) : size_t(0);
+            };
+
+            // The keyframe as addKeyframe() stores it.
+            size_t bytes = NODE + sizeof(int) + sizeof(Frame) + f.kp.size() * sizeof(cv::KeyPoint) +
+                descriptors * (sizeof(DescriptorArena::Index) + WIDTH + sizeof(int));
+            if (!compact) {
+                bytes += f.kpUndistorted.size() * sizeof(cv::Point2f);
+                if (!f.frame.empty()) bytes += f.frame.total() * f.frame.elemSize();
+                if (!f.desc.empty()) bytes += f.desc.total() * f.desc.elemSize();
+            }
+
+            // Observations of existing landmarks, and the keyframes f gets linked to.
+            std::vector<int> linked;
+            size_t fresh = 0;
+            for (int lm : kpLandmark) {
+                auto it = lm >= 0 ? landmarks.find(lm) : landmarks.end();
+                if (it == landmarks.end()) {
+                    fresh++;
+                    continue;
+                }
+                const auto &obs = it->second.observations;
+                bytes += vectorGrowth(obs.size(), obs.capacity(), 1, sizeof(int));
+                linked.insert(linked.end(), obs.begin(), obs.end());
+            }
+            if (fresh && partner >= 0) linked.push_back(partner);
+            std::sort(linked.begin(), linked.end());
+            linked.erase(std::unique(linked.begin(), linked.end()), linked.end());
+
+            // Landmark list and covisibility node of f, one entry on both sides of every link.
+            const size_t seen = kpLandmark.size();
+            bytes += 2 * NODE + 2 * sizeof(int) + sizeof(std::vector<int>) + sizeof(CovisibilityNode) + 2 * seen * sizeof(int) +
+                2 * linked.size() * sizeof(std::pair<int, int>) + linked.size() * (NODE + sizeof(std::pair<const int, size_t>)) +
+                bucketGrowth(0, 0, linked.size()) + sizeof(int);
+            bytes += bucketGrowth(covisibility.size(), covisibility.bucket_count(), 1);
+            for (int k : linked) {
+                auto it = covisibility.find(k);
+                if (it == covisibility.end()) continue;
+                const CovisibilityNode &node = it->second;
+                bytes += vectorGrowth(node.neighbours.size(), node.neighbours.capacity(), 1, sizeof(std::pair<int, int>)) + NODE +
+                    sizeof(std::pair<const int, size_t>) + bucketGrowth(node.index.size(), node.index.bucket_count(), 1) +
+                    vectorGrowth(node.children.size(), node.children.capacity(), 1, sizeof(int));
+            }
+            if (fresh && partner >= 0) {
+                auto it = keyframeLandmarks.find(partner);
+                if (it != keyframeLandmarks.end()) bytes += vectorGrowth(it->second.size(), it->second.capacity(), fresh, sizeof(int));
+            }
+
+            // New landmarks, with a copied descriptor unless compact, and their word entries.
+            bytes += fresh * (NODE + sizeof(int) + sizeof(MapPoint) + 2 * sizeof(int) + (compact ? 0 : WIDTH + sizeof(int)));
+            std::map<uint32_t, size_t> words;
+            for (size_t i = 0; i < kpLandmark.size() && i < descriptors; i++) {
+                if (kpLandmark[i] >= 0 && landmarks.count(kpLandmark[i])) continue;
+                for (int t = 0; t < WORD_TABLES; t++) words[word(f.desc.ptr<uint8_t>(int(i)), t)]++;
+            }
+            size_t newWords = 0;
+            for (auto &[w, added] : words) {
+                auto it = landmarkWords.find(w);
+                if (it == landmarkWords.end()) {
+                    newWords++;
+                    bytes += NODE + sizeof(w) + sizeof(std::vector<DescriptorArena::Index>) +
+                        vectorGrowth(0, 0, added, sizeof(DescriptorArena::Index));
+                } else {
+                    bytes += vectorGrowth(it->second.size(), it->second.capacity(), added, sizeof(DescriptorArena::Index));
+                }
+            }
+            bytes += bucketGrowth(landmarkWords.size(), landmarkWords.bucket_count(), newWords);
+            return bytes;
+        }
+
+        /**
+         * @brief Get the descriptor storage shared by keyframes and landmarks.
+         * @return Arena
+         */
+        const std::shared_ptr<DescriptorArena>& getDescriptorArena() const { return arena; }
+
         /**
          * @brief Get all keyframes.
          * @return Keyframes
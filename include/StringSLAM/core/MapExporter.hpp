@@ -0,0 +1,213 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+#include "StringSLAM/core/Map.hpp"
+#include "StringSLAM/core/MapStream.hpp"
+#include "StringSLAM/core/PointCloud.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace StringSLAM
+{
+    /**
+     * @brief Streams Map changes, and snapshots on request, on a writer thread.
+     *
+     * update() reads the Map change log since the previous call, keeps one
+     * record per landmark and keyframe (added wins over moved) with its current
+     * value, trims the log and queues the batch. The first call enables the log
+     * and sends the whole map as added. Its cost is the number of changes, not
+     * the map size, so it can run every frame (System::setMapExporter()).
+     * The exporter owns the log while it is attached: System disables it on
+     * detach, a standalone caller does so with Map::setChangeLog(false) after
+     * close(). Finding the log disabled again, update() resends the whole map.
+     *
+     * The FileHeader and the batches are written as MapStream records to a
+     * file or handed to a sink (e.g. a socket) by the writer thread. Batches
+     * still queued when a new one arrives are merged, so a slow sink receives
+     * fewer, larger batches instead of a growing backlog. A failed file write
+     * ends the stream, later batches are dropped (hasStreamFailed()).
+     *
+     * snapshot() writes a full binary PLY instead: landmarks as vertices and
+     * keyframe poses as a camera element, with the map revision in a comment so
+     * a receiver can load it and then apply the deltas that follow. Depth
+     * geometry (a PointCloud) can be snapshotted the same way.
+     *
+     * update() and snapshot() read the Map, call them where the Map may be read
+     * (the tracking thread, or after System::drain()).
+     */
+    class MapExporter
+    {
+    public:
+        /// @brief Receives the stream, one FileHeader or batch per call, on the writer thread.
+        using Sink = std::function<void(const uint8_t *data, size_t bytes)>;
+
+    private:
+        std::string path;
+        Sink sink;
+
+        // Shortest time between two batches, changes in between are merged.
+        std::chrono::steady_clock::duration minInterval{0};
+
+        // -- Below are private variables not specified but used in class. --
+        enum class Kind { HEADER, DELTA, MAP_PLY, CLOUD_PLY };
+
+        struct Batch {
+            Kind kind = Kind::DELTA;
+            std::string path;
+            uint64_t revision = 0;
+            int64_t timestampNs = 0;
+            std::vector<MapStream::LandmarkRecord> landmarksAdded, landmarksMoved;
+            std::vector<int32_t> landmarksRemoved;
+            std::vector<MapStream::KeyframeRecord> keyframesAdded, keyframesMoved;
+
+            // CLOUD_PLY: camera frame points, their colours and the camera pose.
+            std::vector<cv::Point3f> points;
+            std::vector<cv::Vec3b> colors;
+            SE3 pose;
+        };
+
+        FILE *file = nullptr;
+        std::atomic<bool> running{false};
+        std::deque<Batch> queue;
+        std::mutex mtx;
+        std::condition_variable queueCv;
+        std::thread writer;
+        std::function<void()> threadInit;
+
+        // Last revision sent, the Map change log is enabled on the first update().
+        bool synced = false;
+        uint64_t cursor = 0;
+        std::chrono::steady_clock::time_point lastUpdate;
+
+        // Reused by update().
+        std::vector<MapChange> changes;
+        std::vector<uint8_t> landmarkMark;
+        std::map<int, uint8_t> keyframeMark;
+
+        std::atomic<uint64_t> batches{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> snapshots{0};
+        std::atomic<uint64_t> failed{0};
+
+        // A stream write failed, nothing more is emitted.
+        std::atomic<bool> streamFailed{false};
+
+        void enqueue(Batch &&b);
+        void writerLoop();
+        bool writeHeader();
+        bool writeDelta(const Batch &b);
+        bool writePly(const Batch &b);
+        bool emit(const void *data, size_t n);
+        static MapStream::KeyframeRecord keyframeRecord(int id, const SE3 &pose);
+
+    public:
+        /**
+         * @brief Stream the deltas to a file.
+         * @param path_ Output file, truncated by open()
+         */
+        explicit MapExporter(const std::string &path_);
+
+        /**
+         * @brief Stream the deltas to a sink.
+         * @param sink_ Sink, called on the writer thread
+         */
+        explicit MapExporter(Sink sink_);
+        ~MapExporter();
+
+        MapExporter(const MapExporter &) = delete;
+        MapExporter &operator=(const MapExporter &) = delete;
+
+        /**
+         * @brief Open the stream and start the writer thread, which writes the header first.
+         * @return Stream opened succesfully
+         */
+        bool open();
+
+        /// Write the queued batches and snapshots, then stop the writer thread.
+        void close();
+
+        /**
+         * @brief Set a function run first on the writer thread, e.g. Accelerator::threadInit(Stage::IO).
+         * @param init Hook, call before open()
+         */
+        inline void setThreadInit(std::function<void()> init) { threadInit = std::move(init); }
+
+        /**
+         * @brief Limit the batch rate, e.g. 33 ms for a 30 Hz viewer.
+         * @param ms Shortest time between two batches (ms), 0 sends on every update()
+         */
+        inline void setMinInterval(double ms) {
+            minInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(ms));
+        }
+
+        /**
+         * @brief Queue the changes of a Map since the previous call.
+         * @param map Map, its change log is enabled and trimmed by this exporter
+         * @return A batch was queued, false once the stream failed
+         */
+        bool update(Map &map);
+
+        /**
+         * @brief Queue a binary PLY of the whole map.
+         * @param map Map
+         * @param plyPath Output file
+         * @return Queued, false if the exporter is not open
+         */
+        bool snapshot(const Map &map, const std::string &plyPath);
+
+        /**
+         * @brief Queue a binary PLY of a point cloud, e.g. from DisparityReprojector.
+         * @param cloud Points in the camera frame
+         * @param T_world_camera Pose the points are moved to world with
+         * @param plyPath Output file
+         * @return Queued, false if the exporter is not open
+         */
+        bool snapshot(const PointCloud &cloud, const SE3 &T_world_camera, const std::string &plyPath);
+
+        /// @brief Map revision of the last queued batch.
+        inline uint64_t getRevision() const { return cursor; }
+
+        /// @brief Batches written.
+        inline uint64_t getBatches() const { return batches; }
+
+        /// @brief Stream bytes written.
+        inline uint64_t getBytes() const { return bytes; }
+
+        /// @brief PLY snapshots written.
+        inline uint64_t getSnapshots() const { return snapshots; }
+
+        /// @brief PLY snapshots and stream batches (header included) that could not be written.
+        inline uint64_t getFailed() const { return failed; }
+
+        /// @brief A stream write failed and the stream was ended.
+        inline bool hasStreamFailed() const { return streamFailed; }
+
+        /// @brief Stream is open.
+        inline bool isOpen() const { return running; }
+
+        /**
+         * @brief Create Shared Pointer of MapExporter object
+         * @return Shared Pointer of MapExporter
+         */
+        static std::shared_ptr<MapExporter> create(const std::string &path_) {
+            return std::make_shared<MapExporter>(path_);
+        }
+
+        /**
+         * @brief Create Shared Pointer of MapExporter object
+         * @return Shared Pointer of MapExporter
+         */
+        static std::shared_ptr<MapExporter> create(Sink sink_) {
+            return std::make_shared<MapExporter>(std::move(sink_));
+        }
+    };
+
+} // namespace StringSLAM
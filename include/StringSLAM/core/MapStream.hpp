@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+namespace StringSLAM::MapStream
+{
+    /*
+     * Layout of the delta stream written by MapExporter.
+     *
+     *  FileHeader
+     *  { DeltaHeader,
+     *    LandmarkRecord x (landmarksAdded + landmarksMoved),
+     *    int32 ID x landmarksRemoved,
+     *    KeyframeRecord x (keyframesAdded + keyframesMoved) } ...
+     *
+     * Records hold absolute values (current position and pose, not offsets), so
+     * applying a batch twice, or one that overlaps a snapshot, is harmless. A
+     * sink receives the FileHeader first and then exactly one batch per call.
+     * Values are in host byte order (little endian on every supported target).
+     */
+
+    /// Format version written to FileHeader
+    constexpr uint32_t VERSION = 1;
+
+    /// Magic of a DeltaHeader ("DLTA")
+    constexpr uint32_t DELTA_MAGIC = 0x41544C44;
+
+    /// Magic of the FileHeader
+    constexpr char FILE_MAGIC[8] = {'S', 'S', 'L', 'A', 'M', 'M', 'A', 'P'};
+
+    /// @brief Start of the stream.
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+    };
+
+    /// @brief Start of a batch of changes.
+    struct DeltaHeader {
+        uint32_t magic;
+        uint32_t landmarksAdded;
+        uint32_t landmarksMoved;
+        uint32_t landmarksRemoved;
+        uint32_t keyframesAdded;
+        uint32_t keyframesMoved;
+        /// Map revision the batch brings the receiver to
+        uint64_t revision;
+        /// Export time
+        int64_t timestampNs;
+    };
+
+    /// @brief Landmark position (world frame).
+    struct LandmarkRecord {
+        int32_t id;
+        float x, y, z;
+    };
+
+    /// @brief Keyframe pose T_world_camera, rotation as a unit quaternion.
+    struct KeyframeRecord {
+        int32_t id;
+        float qw, qx, qy, qz;
+        float tx, ty, tz;
+    };
+
+} // namespace StringSLAM::MapStream
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace StringSLAM
+{
+    /**
+     * @brief Live bytes and budget of one subsystem.
+     */
+    struct MemoryUsage {
+        /// Subsystem name, e.g. "map"
+        std::string name;
+
+        /// Bytes reported by the subsystem's accounts
+        size_t bytes = 0;
+
+        /// Largest bytes seen
+        size_t peak = 0;
+
+        /// Budget (bytes), 0 if unlimited
+        size_t budget = 0;
+
+        /// Reports that exceeded the budget, each one triggered the subsystem's policy
+        uint64_t overruns = 0;
+    };
+
+    /**
+     * @brief Central memory accounting with per-subsystem budgets.
+     *
+     * Subsystems report their live bytes through a MemoryAccount, several
+     * accounts with the same name add up (e.g. the undistortion maps of two
+     * MonoTrackers). A report returns whether the subsystem and the total still
+     * fit their budgets. When they do not, the owner applies its policy right
+     * away (evict, downgrade or stop growing, see the owners' setMemoryRegistry()),
+     * so the registry never calls into a subsystem from another thread.
+     *
+     * Budgets can be set before or after the accounts are opened. The usage
+     * breakdown is meant to be exported next to the latency counters.
+     */
+    class MemoryRegistry
+    {
+    private:
+        size_t totalBudget = 0;
+
+        // -- Below are private variables not specified but used in class. --
+        struct Entry {
+            size_t bytes = 0;
+            size_t peak = 0;
+            size_t budget = 0;
+            uint64_t overruns = 0;
+        };
+        std::map<std::string, Entry> entries;
+        size_t total = 0;
+        size_t peakTotal = 0;
+        mutable std::mutex mtx;
+
+        friend class MemoryAccount;
+        bool update(const std::string &name, size_t before, size_t after);
+        bool fits(const std::string &name, size_t before, size_t after) const;
+
+    public:
+        MemoryRegistry() = default;
+        ~MemoryRegistry() = default;
+
+        /**
+         * @brief Set the budget of a subsystem.
+         * @param name Subsystem name
+         * @param bytes Budget, 0 for unlimited
+         */
+        void setBudget(const std::string &name, size_t bytes);
+
+        /**
+         * @brief Set the budget of all subsystems together.
+         * @param bytes Budget, 0 for unlimited
+         */
+        void setTotalBudget(size_t bytes);
+
+        /// @brief Bytes reported by all accounts.
+        size_t getTotalBytes() const;
+
+        /// @brief Largest total seen.
+        size_t getPeakBytes() const;
+
+        /**
+         * @brief Usage of every subsystem that was reported or given a budget.
+         * @return Breakdown, sorted by name
+         */
+        std::vector<MemoryUsage> getUsage() const;
+
+        /**
+         * @brief Every subsystem and the total fit their budgets.
+         * @return Within budget
+         */
+        bool withinBudget() const;
+
+        /**
+         * @brief Create Shared Pointer of MemoryRegistry object
+         * @return Shared Pointer of MemoryRegistry
+         */
+        static std::shared_ptr<MemoryRegistry> create() {
+            return std::make_shared<MemoryRegistry>();
+        }
+    };
+
+    /**
+     * @brief Handle a subsystem reports its live bytes through.
+     *
+     * Its bytes are withdrawn from the registry when it is destroyed. A default
+     * constructed account is not attached: set() accepts everything.
+     */
+    class MemoryAccount
+    {
+    private:
+        std::shared_ptr<MemoryRegistry> registry;
+        std::string name;
+
+        // -- Below are private variables not specified but used in class. --
+        size_t bytes = 0;
+
+    public:
+        MemoryAccount() = default;
+
+        /**
+         * @brief Open an account.
+         * @param registry_ Registry, nullptr for a detached account
+         * @param name_ Subsystem name
+         */
+        MemoryAccount(std::shared_ptr<MemoryRegistry> registry_, std::string name_);
+        ~MemoryAccount();
+
+        MemoryAccount(const MemoryAccount &) = delete;
+        MemoryAccount &operator=(const MemoryAccount &) = delete;
+        MemoryAccount(MemoryAccount &&other) noexcept;
+        MemoryAccount &operator=(MemoryAccount &&other) noexcept;
+
+        /**
+         * @brief Report the live bytes of this account.
+         * @param bytes_ Bytes
+         * @return The subsystem and the total fit their budgets
+         */
+        bool set(size_t bytes_);
+
+        /**
+         * @brief Whether reporting a value would fit, e.g. before an allocation.
+         * @param bytes_ Bytes this account would hold
+         * @return Fits the subsystem and the total budget
+         */
+        bool fits(size_t bytes_) const;
+
+        /// @brief Bytes last reported.
+        inline size_t getBytes() const { return bytes; }
+
+        /// @brief Attached to a registry.
+        inline bool valid() const { return registry != nullptr; }
+
+        /// @brief Subsystem name.
+        inline const std::string &getName() const { return name; }
+    };
+
+} // namespace StringSLAM
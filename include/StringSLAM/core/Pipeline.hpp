@@ -0,0 +1,131 @@
+#pragma once
+
+#include "StringSLAM/core/Policies.hpp"
+#include <type_traits>
+
+namespace StringSLAM
+{
+    /**
+     * @brief Front-end whose extractor, matcher, camera and estimator are chosen at compile time.
+     *
+     * The policies (\ref StringSLAM::Policy) are held by value, so there is no
+     * shared_ptr or virtual call between the stages and fixed parameters such as
+     * the descriptor width are constants the compiler can specialize on.
+     * Incompatible combinations (e.g. a 32-byte extractor with a 64-byte
+     * matcher) fail to compile.
+     *
+     * Embedded builds pick one fixed configuration:
+     * @code
+     * using Front = Pipeline<Policy::Orb<500, 3>, Policy::Hamming<32>, Policy::Pinhole, Policy::Essential>;
+     * Front front(Policy::Orb<500, 3>(), Policy::Hamming<32>(), Policy::Pinhole(cm.cI));
+     * @endcode
+     * The runtime-configurable classes (e.g. Feature::FeatureFinder) wrap the
+     * OrbRuntime / BruteForce instantiation.
+     */
+    template <class Extractor, class Matcher, class Camera = Policy::Pinhole, class Estimator = Policy::NoEstimator>
+    class Pipeline
+    {
+        static_assert(Matcher::descriptorBytes == 0 || Matcher::descriptorBytes == Extractor::descriptorBytes,
+            "Matcher and Extractor descriptor widths differ");
+
+    private:
+        Extractor extractor;
+        Matcher matcher;
+        Camera camera;
+        Estimator estimator;
+
+        // -- Below are private variables not specified but used in class. --
+        // Matched points handed to the estimator, reused across frames.
+        std::vector<cv::Point2f> p1, p2;
+
+    public:
+        /// Bytes per descriptor
+        static constexpr int descriptorBytes = Extractor::descriptorBytes;
+
+        /**
+         * @brief Construct Pipeline
+         * @param extractor_ Extractor policy
+         * @param matcher_ Matcher policy
+         * @param camera_ Camera policy
+         * @param estimator_ Estimator policy
+         */
+        explicit Pipeline(Extractor extractor_ = Extractor(), Matcher matcher_ = Matcher(), Camera camera_ = Camera(),
+            Estimator estimator_ = Estimator())
+            : extractor(std::move(extractor_)), matcher(std::move(matcher_)), camera(std::move(camera_)), estimator(std::move(estimator_)) {}
+
+        /**
+         * @brief Extract keypoints and descriptors, undistorting the keypoints when the camera is distorted.
+         * @param f Frame, kp, kpUndistorted and desc are replaced
+         */
+        inline void extract(Frame &f) {
+            f.kp.clear();
+            f.kpUndistorted.clear();
+            f.desc.release();
+            if (f.frame.empty()) return;
+
+            extractor.extract(f.frame, f.kp, f.desc);
+            if constexpr (Camera::distorted) camera.undistort(f);
+        }
+
+        /**
+         * @brief Match the descriptors of two frames.
+         * @param f1 Frame 1
+         * @param f2 Frame 2
+         * @param matches queryIdx indexes f1.kp, trainIdx f2.kp
+         */
+        inline void match(const Frame &f1, const Frame &f2, std::vector<cv::DMatch> &matches) {
+            matches.clear();
+            if (f1.desc.empty() || f2.desc.empty()) return;
+            matcher.match(f1.desc, f2.desc, matches);
+        }
+
+        /**
+         * @brief Estimate the motion between two matched frames.
+         * @param ref Reference frame
+         * @param cur Current frame
+         * @param matches queryIdx indexes ref.kp, trainIdx cur.kp
+         * @param T_ref_cur Pose of cur in ref
+         * @return Motion accepted
+         */
+        bool estimate(const Frame &ref, const Frame &cur, const std::vector<cv::DMatch> &matches, SE3 &T_ref_cur) {
+            static_assert(Estimator::enabled, "Pipeline has no Estimator policy");
+            p1.clear();
+            p2.clear();
+            for (auto &m : matches) {
+                p1.push_back(ref.undistorted(m.queryIdx));
+                p2.push_back(cur.undistorted(m.trainIdx));
+            }
+            return estimator.estimate(p1, p2, camera.intrinsic(), T_ref_cur);
+        }
+
+        /**
+         * @brief Extract, match against ref and estimate the pose of cur.
+         * @param ref Reference frame with keypoints, descriptors and pose
+         * @param cur Current frame, its pose is set on success
+         * @param matches queryIdx indexes ref.kp, trainIdx cur.kp
+         * @return Pose recovered
+         */
+        bool track(const Frame &ref, Frame &cur, std::vector<cv::DMatch> &matches) {
+            extract(cur);
+            match(ref, cur, matches);
+
+            SE3 T_ref_cur;
+            if (!estimate(ref, cur, matches, T_ref_cur)) return false;
+            cur.pose = ref.pose * T_ref_cur;
+            return true;
+        }
+
+        /// @brief Extractor policy.
+        inline Extractor &getExtractor() { return extractor; }
+
+        /// @brief Matcher policy.
+        inline Matcher &getMatcher() { return matcher; }
+
+        /// @brief Camera policy.
+        inline Camera &getCamera() { return camera; }
+
+        /// @brief Estimator policy.
+        inline Estimator &getEstimator() { return estimator; }
+    };
+
+} // namespace StringSLAM
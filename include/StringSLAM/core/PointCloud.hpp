@@ -0,0 +1,142 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+#include "StringSLAM/Utils/ThreadPool.hpp"
+#include <limits>
+#include <vector>
+
+namespace StringSLAM
+{
+    /**
+     * @brief A compact point cloud, reused across frames without reallocating.
+     *
+     * points and colors are sized to the largest cloud seen so far, only the first
+     * size entries are valid.
+     */
+    struct PointCloud {
+        /// Points in the rectified left camera frame
+        std::vector<cv::Point3f> points;
+
+        /// Optional BGR colour of every point
+        std::vector<cv::Vec3b> colors;
+
+        /// Valid points
+        size_t size = 0;
+
+        /// Image position (u, v) of every point, filled on request
+        std::vector<cv::Point2i> pixels;
+
+        /**
+         * @brief Grow the buffers so a cloud of n points needs no allocation.
+         * @param n Points
+         * @param withColor Reserve colours too
+         * @param withPixels Reserve pixel positions too
+         */
+        void reserve(size_t n, bool withColor = false, bool withPixels = false) {
+            if (points.size() < n) points.resize(n);
+            if (withColor && colors.size() < n) colors.resize(n);
+            if (withPixels && pixels.size() < n) pixels.resize(n);
+        }
+    };
+
+    /**
+     * @brief Turns disparity into a compact point cloud.
+     *
+     * Replaces cv::reprojectImageTo3D() on the hot path: only valid pixels are
+     * written, the output buffers are reused, and every row runs through a
+     * branch-free kernel the compiler vectorizes before the valid points are
+     * compacted. Rows can be split into stripes processed on a ThreadPool.
+     *
+     * Row scratch is kept between calls, so one reprojector must not be used
+     * from two threads at once.
+     */
+    class DisparityReprojector
+    {
+    private:
+        // Disparity-to-depth matrix rows (X, Y, Z, W).
+        float q[4][4];
+
+        int stride = 1;
+        float minDisparity = 0.0f;
+        float maxDisparity = std::numeric_limits<float>::max();
+        size_t stripes = 1;
+        std::shared_ptr<Utils::ThreadPool> pool;
+
+        // -- Below are private variables not specified but used in class. --
+        // One sampled row in structure-of-arrays form, one per stripe.
+        struct RowScratch {
+            std::vector<float> d, X, Y, Z;
+            std::vector<uint8_t> valid;
+        };
+
+        // Grown by reproject() only when the image gets wider or stripes are added.
+        mutable std::vector<RowScratch> scratch;
+        mutable std::vector<int> rowStart;
+        mutable std::vector<size_t> stripeWritten;
+
+        // Reprojects rows [r0, r1) into out starting at offset, returns points written.
+        size_t reprojectRows(const cv::Mat &disp, const cv::Mat &mask, const cv::Mat &color, int r0, int r1,
+            PointCloud &out, size_t offset, RowScratch &row) const;
+
+    public:
+        /**
+         * @brief Construct DisparityReprojector
+         * @param Q 4x4 disparity-to-depth matrix (StereoCameraDistortion::Q)
+         */
+        explicit DisparityReprojector(const cv::Mat &Q);
+        ~DisparityReprojector() = default;
+
+        /**
+         * @brief Reproject a disparity image.
+         * @param disp CV_32F disparity (px), e.g. StereoFrame::depthFrame
+         * @param out Cloud, its buffers grow only when needed
+         * @param color Optional CV_8UC3 or CV_8UC1 image aligned with disp
+         * @param mask Optional CV_8U mask, zero pixels are skipped
+         * @param withPixels Store the image position of every point
+         * @return Points written
+         */
+        size_t reproject(const cv::Mat &disp, PointCloud &out, const cv::Mat &color = cv::Mat(),
+            const cv::Mat &mask = cv::Mat(), bool withPixels = false) const;
+
+        /**
+         * @brief Reproject a StereoFrame from StereoTracker::readDepth().
+         * @param sf StereoFrame, depthFrame holds disparity
+         * @param out Cloud
+         * @param withColor Take colour from frameLeft
+         * @return Points written
+         */
+        size_t reproject(const StereoFrame &sf, PointCloud &out, bool withColor = false) const;
+
+        /**
+         * @brief Set subsampling, every stride-th pixel of every stride-th row is used.
+         * @param stride_ Pixel stride
+         */
+        inline void setStride(int stride_) { stride = std::max(1, stride_); }
+
+        /**
+         * @brief Set the valid disparity range, anything outside (min, max] is dropped.
+         * @param minDisparity_ Exclusive lower bound
+         * @param maxDisparity_ Inclusive upper bound
+         */
+        inline void setDisparityRange(float minDisparity_, float maxDisparity_) {
+            minDisparity = minDisparity_;
+            maxDisparity = maxDisparity_;
+        }
+
+        /**
+         * @brief Split the image into row stripes processed in parallel.
+         * @param pool_ Pool, nullptr processes on the calling thread
+         * @param stripes_ Stripes, 0 uses one per pool thread
+         */
+        void setParallel(std::shared_ptr<Utils::ThreadPool> pool_, size_t stripes_ = 0);
+
+        /**
+         * @brief Create Shared Pointer of DisparityReprojector object
+         * @return Shared Pointer of DisparityReprojector
+         */
+        static std::shared_ptr<DisparityReprojector> create(const cv::Mat &Q) {
+            return std::make_shared<DisparityReprojector>(Q);
+        }
+    };
+
+} // namespace StringSLAM
@@ -0,0 +1,354 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+#include "StringSLAM/core/UndistortLUT.hpp"
+#include "StringSLAM/Estimation/Poser/PoseEstimator2d.hpp"
+#include <climits>
+#include <cstring>
+
+/**
+ * @brief Building blocks of a Pipeline, chosen at compile time.
+ *
+ * Every policy is held by value inside the Pipeline, so calls into it are
+ * direct and can be inlined. The policies follow four small interfaces:
+ *
+ * - Extractor: `descriptorBytes`, `extract(cv::Mat &img, std::vector<cv::KeyPoint> &kp, cv::Mat &desc)`
+ * - Matcher: `descriptorBytes` (0 accepts any width), `match(const cv::Mat &d1, const cv::Mat &d2, std::vector<cv::DMatch> &matches)`
+ * - Camera: `distorted`, `undistort(Frame &f)`, `intrinsic()`
+ * - Estimator: `enabled`, `estimate(p1, p2, cI, T_1_2)`
+ *
+ * The fixed variants (Orb, Hamming) take their parameters as template
+ * arguments, the runtime variants (OrbRuntime, BruteForce) back the existing
+ * runtime-configurable classes such as Feature::FeatureFinder.
+ */
+namespace StringSLAM::Policy
+{
+    namespace detail
+    {
+        inline int popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_popcountll(x);
+#else
+            x = x - ((x >> 1) & 0x5555555555555555ULL);
+            x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+            x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+            return int((x * 0x0101010101010101ULL) >> 56);
+#endif
+        }
+    } // namespace detail
+
+    // ------------------ Extractors ------------------
+
+    /**
+     * @brief ORB with its configuration fixed at compile time.
+     * @tparam NFeatures Features per frame
+     * @tparam Levels Pyramid levels
+     * @tparam PatchSize Patch size, also used as edge threshold
+     * @tparam FastThreshold FAST threshold
+     */
+    template <int NFeatures = 1000, int Levels = 4, int PatchSize = 31, int FastThreshold = 20>
+    class Orb
+    {
+        static_assert(NFeatures > 0, "ORB needs at least one feature");
+        static_assert(Levels > 0, "ORB needs at least one pyramid level");
+        static_assert(PatchSize >= 2, "ORB patch size is too small");
+
+    private:
+        cv::Ptr<cv::ORB> orb;
+
+    public:
+        /// Bytes per descriptor (256-bit)
+        static constexpr int descriptorBytes = 32;
+
+        /// Features per frame
+        static constexpr int features = NFeatures;
+
+        /// Patch size (pixels)
+        static constexpr int patchSize = PatchSize;
+
+        Orb() : orb(cv::ORB::create(NFeatures, 1.2f, Levels, PatchSize, 0, 2, cv::ORB::HARRIS_SCORE, PatchSize, FastThreshold)) {}
+
+        /**
+         * @brief Detect keypoints and compute their descriptors.
+         * @param img Image
+         * @param kp Keypoints
+         * @param desc Descriptors, one row per keypoint
+         */
+        inline void extract(cv::Mat &img, std::vector<cv::KeyPoint> &kp, cv::Mat &desc) {
+            orb->detectAndCompute(img, cv::noArray(), kp, desc);
+        }
+    };
+
+    /**
+     * @brief ORB configured at runtime through an OrbWrapper.
+     */
+    class OrbRuntime
+    {
+    private:
+        std::shared_ptr<OrbWrapper> orb;
+
+    public:
+        /// Bytes per descriptor (256-bit)
+        static constexpr int descriptorBytes = 32;
+
+        /**
+         * @brief Construct OrbRuntime
+         * @param orb_ OrbWrapper
+         */
+        explicit OrbRuntime(std::shared_ptr<OrbWrapper> orb_) : orb(std::move(orb_)) {}
+
+        /**
+         * @brief Detect keypoints and compute their descriptors.
+         * @param img Image
+         * @param kp Keypoints
+         * @param desc Descriptors, one row per keypoint
+         */
+        inline void extract(cv::Mat &img, std::vector<cv::KeyPoint> &kp, cv::Mat &desc) { orb->detectAndCompute(img, kp, desc); }
+    };
+
+    // ------------------ Matchers ------------------
+
+    /**
+     * @brief Brute-force Hamming matcher for a fixed descriptor width.
+     *
+     * The distance loop has a compile-time trip count and is fully unrolled.
+     * A match is kept when it is within MaxDistance and clearly better than the
+     * runner-up (Lowe ratio).
+     * @tparam Bytes Bytes per descriptor, a multiple of 8
+     * @tparam RatioPercent Lowe ratio (percent)
+     * @tparam MaxDistance Largest accepted distance (bits)
+     */
+    template <int Bytes = 32, int RatioPercent = 75, int MaxDistance = 64>
+    class Hamming
+    {
+        static_assert(Bytes > 0 && Bytes % 8 == 0, "Descriptor width must be a multiple of 8 bytes");
+        static_assert(RatioPercent > 0 && RatioPercent <= 100, "Ratio must be within (0, 100]");
+
+    private:
+        static constexpr int WORDS = Bytes / 8;
+
+        static inline int distance(const uint64_t *q, const uint8_t *d) {
+            uint64_t w[WORDS];
+            std::memcpy(w, d, Bytes);
+
+            int dist = 0;
+            for (int k = 0; k < WORDS; k++) dist += detail::popcount64(q[k] ^ w[k]);
+            return dist;
+        }
+
+    public:
+        /// Bytes per descriptor
+        static constexpr int descriptorBytes = Bytes;
+
+        /**
+         * @brief Match every descriptor of d1 against d2.
+         * @param d1 CV_8U descriptors with Bytes columns
+         * @param d2 CV_8U descriptors with Bytes columns
+         * @param matches queryIdx indexes d1, trainIdx d2, empty if the layout does not match
+         */
+        void match(const cv::Mat &d1, const cv::Mat &d2, std::vector<cv::DMatch> &matches) const {
+            matches.clear();
+            if (d1.empty() || d2.empty() || d1.type() != CV_8UC1 || d2.type() != CV_8UC1 || d1.cols != Bytes || d2.cols != Bytes)
+                return;
+
+            uint64_t q[WORDS];
+            for (int i = 0; i < d1.rows; i++) {
+                std::memcpy(q, d1.ptr<uint8_t>(i), Bytes);
+
+                int best = INT_MAX, second = INT_MAX, bestIdx = -1;
+                for (int j = 0; j < d2.rows; j++) {
+                    const int d = distance(q, d2.ptr<uint8_t>(j));
+                    if (d < best) {
+                        second = best;
+                        best = d;
+                        bestIdx = j;
+                    } else if (d < second) {
+                        second = d;
+                    }
+                }
+
+                if (second == INT_MAX || best > MaxDistance || best * 100 >= RatioPercent * second) continue;
+                matches.emplace_back(i, bestIdx, float(best));
+            }
+        }
+    };
+
+    /**
+     * @brief OpenCV brute-force matcher with a kNN ratio test, any descriptor width.
+     */
+    class BruteForce
+    {
+    private:
+        cv::Ptr<cv::BFMatcher> matcher = cv::BFMatcher::create(cv::NORM_HAMMING, false);
+        float ratio;
+
+        // -- Below are private variables not specified but used in class. --
+        // Reused kNN buffer.
+        std::vector<std::vector<cv::DMatch>> knnMatches;
+
+    public:
+        /// Any descriptor width
+        static constexpr int descriptorBytes = 0;
+
+        /**
+         * @brief Construct BruteForce
+         * @param ratio_ Lowe ratio between best and second best
+         */
+        explicit BruteForce(float ratio_ = 0.75f) : ratio(ratio_) {}
+
+        /**
+         * @brief Match every descriptor of d1 against d2.
+         * @param d1 Descriptors
+         * @param d2 Descriptors
+         * @param matches queryIdx indexes d1, trainIdx d2
+         */
+        void match(const cv::Mat &d1, const cv::Mat &d2, std::vector<cv::DMatch> &matches);
+    };
+
+    // ------------------ Cameras ------------------
+
+    /**
+     * @brief Pinhole camera without distortion (or with undistorted images).
+     */
+    class Pinhole
+    {
+    private:
+        CameraIntrinsic cI;
+
+    public:
+        /// Keypoints are used as detected
+        static constexpr bool distorted = false;
+
+        /**
+         * @brief Construct Pinhole
+         * @param cI_ Intrinsics, the default keeps pixel coordinates
+         */
+        explicit Pinhole(const CameraIntrinsic &cI_ = CameraIntrinsic(1.0, 1.0, 0.0, 0.0)) : cI(cI_) {}
+
+        /// @brief Nothing to undistort.
+        inline void undistort(Frame &) const {}
+
+        /// @brief Intrinsics.
+        inline const CameraIntrinsic &intrinsic() const { return cI; }
+    };
+
+    /**
+     * @brief Distorted camera, keypoints are undistorted after extraction through an UndistortLUT.
+     *
+     * Undistorting only the keypoints is cheaper than remapping the whole image,
+     * Frame::kp keep the raw positions and Frame::kpUndistorted is filled.
+     */
+    class RadTan
+    {
+    private:
+        CameraIntrinsic cI;
+        UndistortLUT lut;
+
+    public:
+        /// Keypoints are undistorted
+        static constexpr bool distorted = true;
+
+        /**
+         * @brief Construct RadTan
+         * @param cm CameraModel, capSize is the raw image size
+         * @param step LUT grid spacing (pixels)
+         */
+        explicit RadTan(const CameraModel &cm, int step = 8) : cI(cm.cI), lut(cm, step) {}
+
+        /**
+         * @brief Fill Frame::kpUndistorted, in pixels of the same K.
+         * @param f Frame with raw keypoints
+         */
+        inline void undistort(Frame &f) const { lut.undistort(f); }
+
+        /// @brief Intrinsics.
+        inline const CameraIntrinsic &intrinsic() const { return cI; }
+    };
+
+    // ------------------ Estimators ------------------
+
+    /**
+     * @brief No motion estimation, the Pipeline only extracts and matches.
+     */
+    class NoEstimator
+    {
+    public:
+        /// Pipeline::estimate() is unavailable
+        static constexpr bool enabled = false;
+    };
+
+    /**
+     * @brief Relative motion from the essential matrix (5-point RANSAC), translation has unit length.
+     */
+    class Essential
+    {
+    private:
+        double threshold;
+        double confidence;
+        int minInliers;
+
+        // -- Below are private variables not specified but used in class. --
+        cv::Mat mask;
+
+    public:
+        /// Pipeline::estimate() is available
+        static constexpr bool enabled = true;
+
+        /**
+         * @brief Construct Essential
+         * @param threshold_ RANSAC threshold (px)
+         * @param confidence_ RANSAC confidence
+         * @param minInliers_ Inliers needed to accept the motion
+         */
+        explicit Essential(double threshold_ = 1.0, double confidence_ = 0.999, int minInliers_ = 15)
+            : threshold(threshold_), confidence(confidence_), minInliers(minInliers_) {}
+
+        /**
+         * @brief Estimate the motion between two views.
+         * @param p1 Points in view 1 (px)
+         * @param p2 Corresponding points in view 2 (px)
+         * @param cI Intrinsics
+         * @param T_1_2 Pose of view 2 in view 1
+         * @return Motion accepted
+         */
+        bool estimate(const std::vector<cv::Point2f> &p1, const std::vector<cv::Point2f> &p2, const CameraIntrinsic &cI, SE3 &T_1_2);
+    };
+
+    /**
+     * @brief Planar motion of a camera looking straight down at a plane at unit distance.
+     *
+     * Solves a rotation about the optical axis and an in-plane translation with
+     * Estimation::Poser::PoseEstimator2d on normalized coordinates. Matches must be
+     * outlier free (e.g. matchFramesLK()), there is no RANSAC.
+     */
+    class Planar
+    {
+    private:
+        Estimation::Poser::PoseEstimator2d solver;
+        int maxIterations;
+
+        // -- Below are private variables not specified but used in class. --
+        std::vector<Eigen::Vector2d> src, dst;
+
+    public:
+        /// Pipeline::estimate() is available
+        static constexpr bool enabled = true;
+
+        /**
+         * @brief Construct Planar
+         * @param maxIterations_ Gauss-Newton iterations
+         */
+        explicit Planar(int maxIterations_ = 20) : maxIterations(maxIterations_) {}
+
+        /**
+         * @brief Estimate the motion between two views.
+         * @param p1 Points in view 1 (px)
+         * @param p2 Corresponding points in view 2 (px)
+         * @param cI Intrinsics
+         * @param T_1_2 Pose of view 2 in view 1
+         * @return Motion solved
+         */
+        bool estimate(const std::vector<cv::Point2f> &p1, const std::vector<cv::Point2f> &p2, const CameraIntrinsic &cI, SE3 &T_1_2);
+    };
+
+} // namespace StringSLAM::Policy
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+
+namespace StringSLAM
+{
+    /**
+     * @brief Sub-sampled lookup table from distorted to undistorted pixels.
+     *
+     * Built once per CameraModel: the exact undistortion (cv::undistortPoints,
+     * including the rectification R) is evaluated on a grid every step pixels,
+     * and keypoints are mapped by bilinear interpolation between the four
+     * surrounding nodes. This is a few multiply-adds per keypoint instead of an
+     * iterative solve, and the image itself is never remapped.
+     *
+     * Undistorted pixels use the original intrinsics (cm.cI), so they can be
+     * handed straight to Initializer, Relocalizer or solvePnP with cm.cI.
+     */
+    class UndistortLUT
+    {
+    private:
+        cv::Size size;
+        int step;
+
+        // -- Below are private variables not specified but used in class. --
+        // Grid nodes per row / column, the last node covers the last pixel.
+        int cols = 0, rows = 0;
+
+        // Undistorted position of every node, row-major.
+        std::vector<cv::Point2f> grid;
+
+    public:
+        /**
+         * @brief Construct UndistortLUT
+         * @param cm CameraModel, capSize is the raw image size
+         * @param step_ Grid spacing (pixels), smaller is more accurate and larger
+         */
+        explicit UndistortLUT(const CameraModel &cm, int step_ = 8);
+        ~UndistortLUT() = default;
+
+        /**
+         * @brief Undistort one pixel.
+         * @param p Distorted pixel, points outside the image are extrapolated from the border cells
+         * @return Undistorted pixel
+         */
+        inline cv::Point2f operator()(const cv::Point2f &p) const {
+            const float gx = p.x / float(step), gy = p.y / float(step);
+            const int i = std::min(std::max(int(gx), 0), cols - 2);
+            const int j = std::min(std::max(int(gy), 0), rows - 2);
+            const float a = gx - float(i), b = gy - float(j);
+
+            const cv::Point2f *n = &grid[size_t(j) * cols + i];
+            const cv::Point2f top = n[0] + (n[1] - n[0]) * a;
+            const cv::Point2f bottom = n[cols] + (n[cols + 1] - n[cols]) * a;
+            return top + (bottom - top) * b;
+        }
+
+        /**
+         * @brief Undistort keypoint positions.
+         * @param kp Distorted keypoints
+         * @param out Undistorted position of every keypoint
+         */
+        void undistort(const std::vector<cv::KeyPoint> &kp, std::vector<cv::Point2f> &out) const;
+
+        /**
+         * @brief Fill Frame::kpUndistorted from Frame::kp.
+         * @param f Frame with keypoints extracted from the raw image
+         */
+        inline void undistort(Frame &f) const { undistort(f.kp, f.kpUndistorted); }
+
+        /// @brief Raw image size covered by the table.
+        inline cv::Size getSize() const { return size; }
+
+        /// @brief Grid spacing (pixels).
+        inline int getStep() const { return step; }
+
+        /// @brief Bytes of the table.
+        inline size_t getMemoryUsage() const { return grid.capacity() * sizeof(cv::Point2f); }
+
+        /**
+         * @brief Create Shared Pointer of UndistortLUT object
+         * @return Shared Pointer of UndistortLUT
+         */
+        static std::shared_ptr<UndistortLUT> create(const CameraModel &cm, int step_ = 8) {
+            return std::make_shared<UndistortLUT>(cm, step_);
+        }
+    };
+
+} // namespace StringSLAM
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "StringSLAM/core.hpp"
+#include "StringSLAM/Utils/ThreadPool.hpp"
+#include <cstdint>
+#include <shared_mutex>
+#include <vector>
+#include <eigen3/Eigen/Eigen>
+
+namespace StringSLAM
+{
+    /**
+     * @brief Occupancy state of a point in a VoxelMap.
+     */
+    enum class Occupancy {
+        UNKNOWN,
+        FREE,
+        OCCUPIED
+    };
+
+    /**
+     * @brief A sparse truncated signed distance field (TSDF) built from depth.
+     *
+     * Space is divided into blocks of BLOCK^3 voxels that are allocated on demand
+     * around observed surfaces and addressed through an open-addressing hash
+     * table. Depth is fused with projective TSDF integration, one block per task
+     * on a ThreadPool. Memory is bounded by a block budget, and the least recently
+     * observed blocks are evicted when it is reached.
+     *
+     * Integration and queries may run on different threads.
+     */
+    class VoxelMap
+    {
+    public:
+        /// Voxels per block side
+        static constexpr int BLOCK = 8;
+
+        /// Voxels per block
+        static constexpr int BLOCK_VOXELS = BLOCK * BLOCK * BLOCK;
+
+        /**
+         * @brief A single TSDF voxel.
+         */
+        struct Voxel {
+            /// Truncated signed distance normalized to [-1, 1] (positive in front of the surface)
+            float tsdf = 1.0f;
+
+            /// Accumulated integration weight, 0 is unobserved
+            float weight = 0.0f;
+        };
+
+    private:
+        struct Block {
+            Eigen::Vector3i coords = Eigen::Vector3i::Zero();
+            uint64_t lastUsed = 0;
+            Voxel voxels[BLOCK_VOXELS];
+        };
+
+        struct Slot {
+            uint64_t key = EMPTY;
+            int32_t block = -1;
+        };
+
+        static constexpr uint64_t EMPTY = ~uint64_t(0);
+
+        float voxelSize;
+        float truncation;
+        size_t maxBlocks;
+        std::shared_ptr<Utils::ThreadPool> pool;
+
+        float maxWeight = 64.0f;
+        float minDepth = 0.1f, maxDepth = 5.0f;
+        int stride = 4;
+
+        // -- Below are private variables not specified but used in class. --
+        // Block storage, indices stay valid until a block is evicted.
+        std::vector<Block> blocks;
+        std::vector<int32_t> freeBlocks;
+
+        // Open-addressing (linear probing) table from block coordinates to block index.
+        std::vector<Slot> table;
+        uint64_t mask = 0;
+
+        uint64_t frameCount = 0;
+        cv::Mat depthBuffer;
+        std::vector<int32_t> touched;
+        mutable std::shared_mutex mtx;
+
+        static uint64_t pack(const Eigen::Vector3i &c);
+        size_t home(uint64_t key) const;
+        int32_t find(const Eigen::Vector3i &c) const;
+        int32_t allocate(const Eigen::Vector3i &c);
+        void erase(size_t slot);
+        bool evict();
+        const Voxel *voxelAt(const Eigen::Vector3d &p) const;
+        Eigen::Vector3i blockOf(const Eigen::Vector3d &p) const;
+        void integrateBlock(Block &b, const cv::Mat &depth, const CameraIntrinsic &cI, const SE3 &T_camera_world);
+
+    public:
+        /**
+         * @brief Construct VoxelMap
+         * @param voxelSize_ Voxel edge length (m)
+         * @param truncation_ TSDF truncation distance (m)
+         * @param maxBlocks_ Block budget, each block holds BLOCK^3 voxels
+         * @param pool_ Pool blocks are integrated on, nullptr creates one
+         */
+        VoxelMap(float voxelSize_ = 0.05f, float truncation_ = 0.2f, size_t maxBlocks_ = 1 << 15,
+            std::shared_ptr<Utils::ThreadPool> pool_ = nullptr);
+        ~VoxelMap() = default;
+
+        VoxelMap(const VoxelMap &) = delete;
+        VoxelMap &operator=(const VoxelMap &) = delete;
+
+        /**
+         * @brief Fuse a depth image.
+         * @param depth CV_32F depth (m), 0 or non-finite is invalid
+         * @param cI Intrinsics of the depth image
+         * @param T_world_camera Camera pose
+         */
+        void integrate(const cv::Mat &depth, const CameraIntrinsic &cI, const SE3 &T_world_camera);
+
+        /**
+         * @brief Fuse the disparity of a StereoFrame (StereoTracker::readDepth()).
+         *
+         * StereoFrame::pose is the pose of the unrectified left camera, the rectifying
+         * rotation R1 is applied here.
+         * @param sf StereoFrame with depthFrame as disparity (px)
+         * @param scd Rectification of the stereo pair (Q, R1)
+         * @return scd holds a rectification
+         */
+        bool integrate(const StereoFrame &sf, const StereoCameraDistortion &scd);
+
+        /**
+         * @brief Signed distance to the nearest surface.
+         * @param p World point
+         * @param distance Distance (m), truncated to the truncation distance
+         * @return The point was observed
+         */
+        bool getDistance(const Eigen::Vector3d &p, float &distance) const;
+
+        /**
+         * @brief Occupancy of a world point.
+         * @param p World point
+         * @return Occupancy
+         */
+        Occupancy getOccupancy(const Eigen::Vector3d &p) const;
+
+        /**
+         * @brief Check a sphere for collisions (e.g. a robot footprint).
+         * @param center Sphere center
+         * @param radius Sphere radius (m)
+         * @param unknownIsOccupied Treat unobserved space as an obstacle
+         * @return No occupied voxel inside the sphere
+         */
+        bool isFree(const Eigen::Vector3d &center, double radius, bool unknownIsOccupied = true) const;
+
+        /**
+         * @brief Check a straight motion for collisions.
+         * @param a Start
+         * @param b End
+         * @param radius Sphere radius swept along the segment (m)
+         * @param unknownIsOccupied Treat unobserved space as an obstacle
+         * @return The swept sphere is free
+         */
+        bool isSegmentFree(const Eigen::Vector3d &a, const Eigen::Vector3d &b, double radius, bool unknownIsOccupied = true) const;
+
+        /**
+         * @brief Set the valid depth range.
+         * @param minDepth_ Nearest depth used (m)
+         * @param maxDepth_ Farthest depth used (m)
+         */
+        inline void setDepthRange(float minDepth_, float maxDepth_) {
+            minDepth = minDepth_;
+            maxDepth = maxDepth_;
+        }
+
+        /**
+         * @brief Set the pixel stride used to find blocks to allocate.
+         * @param stride_ Pixel stride
+         */
+        inline void setStride(int stride_) { stride = std::max(1, stride_); }
+
+        /**
+         * @brief Set the weight cap, lower adapts faster to change.
+         * @param maxWeight_ Weight cap
+         */
+        inline void setMaxWeight(float maxWeight_) { maxWeight = maxWeight_; }
+
+        /// @brief Allocated blocks.
+        size_t getBlockCount() const;
+
+        /// @brief Voxel edge length (m).
+        inline float getVoxelSize() const { return voxelSize; }
+
+        /// @brief Remove every block.
+        void clear();
+
+        /**
+         * @brief Create Shared Pointer of VoxelMap object
+         * @return Shared Pointer of VoxelMap
+         */
+        static std::shared_ptr<VoxelMap> create(float voxelSize_ = 0.05f, float truncation_ = 0.2f, size_t maxBlocks_ = 1 << 15,
+            std::shared_ptr<Utils::ThreadPool> pool_ = nullptr) {
+            return std::make_shared<VoxelMap>(voxelSize_, truncation_, maxBlocks_, pool_);
+        }
+    };
+
+} // namespace StringSLAM
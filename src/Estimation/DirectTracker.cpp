@@ -0,0 +1,464 @@
+#include <StringSLAM/Estimation/DirectTracker.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace StringSLAM::Estimation
+{
+    namespace
+    {
+        using Vector6f = Eigen::Matrix<float, 6, 1>;
+        using Vector6d = Eigen::Matrix<double, 6, 1>;
+        using Matrix6d = Eigen::Matrix<double, 6, 6>;
+
+        // 2x2 box average, the pixel centers of level l + 1 sit between four pixels of level l.
+        void halfSample(const cv::Mat &in, cv::Mat &out) {
+            out.create(in.rows / 2, in.cols / 2, CV_8UC1);
+            for (int y = 0; y < out.rows; y++) {
+                const uint8_t *r0 = in.ptr<uint8_t>(2 * y), *r1 = in.ptr<uint8_t>(2 * y + 1);
+                uint8_t *o = out.ptr<uint8_t>(y);
+                for (int x = 0; x < out.cols; x++) o[x] = uint8_t((r0[2 * x] + r0[2 * x + 1] + r1[2 * x] + r1[2 * x + 1] + 2) >> 2);
+            }
+        }
+
+        // Level 0 pixel to level l pixel.
+        inline cv::Point2f toLevel(const cv::Point2d &u, int level) {
+            const double s = 1.0 / double(1 << level);
+            return cv::Point2f(float((u.x + 0.5) * s - 0.5), float((u.y + 0.5) * s - 0.5));
+        }
+
+        // A size x size patch with top-left sample (x, y) can be read bilinearly.
+        inline bool inside(const cv::Mat &img, float x, float y, int size) {
+            return x >= 0.0f && y >= 0.0f && x + float(size + 1) < float(img.cols) && y + float(size + 1) < float(img.rows);
+        }
+
+        // Bilinear patch read, all samples share the sub-pixel weights.
+        void samplePatch(const cv::Mat &img, float x, float y, int size, float *out) {
+            const int ix = int(x), iy = int(y);
+            const float ax = x - float(ix), ay = y - float(iy);
+            const float w00 = (1.0f - ax) * (1.0f - ay), w01 = ax * (1.0f - ay), w10 = (1.0f - ax) * ay, w11 = ax * ay;
+            const size_t step = img.step;
+            for (int r = 0; r < size; r++) {
+                const uint8_t *p0 = img.ptr<uint8_t>(iy + r) + ix, *p1 = p0 + step;
+                for (int c = 0; c < size; c++) *out++ = w00 * p0[c] + w01 * p0[c + 1] + w10 * p1[c] + w11 * p1[c + 1];
+            }
+        }
+
+        // Patch with a one pixel border, returns interior intensities and central differences.
+        void sampleGradients(const cv::Mat &img, float x, float y, int size, float *val, float *gx, float *gy) {
+            const int n = size + 2;
+            std::vector<float> buf(size_t(n * n));
+            samplePatch(img, x - 1.0f, y - 1.0f, n, buf.data());
+            for (int r = 0; r < size; r++) {
+                for (int c = 0; c < size; c++) {
+                    const float *p = &buf[size_t((r + 1) * n + c + 1)];
+                    const int k = r * size + c;
+                    val[k] = p[0];
+                    gx[k] = 0.5f * (p[1] - p[-1]);
+                    gy[k] = 0.5f * (p[n] - p[-n]);
+                }
+            }
+        }
+
+        inline float huberWeight(float r, float k) {
+            const float a = std::abs(r);
+            return a <= k ? 1.0f : k / a;
+        }
+
+        inline double huberCost(double r, double k) {
+            const double a = std::abs(r);
+            return a <= k ? 0.5 * r * r : k * (a - 0.5 * k);
+        }
+
+        // d(pixel)/d(twist) of a point p in camera coordinates, left perturbation, pinhole.
+        inline Eigen::Matrix<double, 2, 6> projectionJacobian(const Eigen::Vector3d &p, double fx, double fy) {
+            const double iz = 1.0 / p.z(), iz2 = iz * iz;
+            Eigen::Matrix<double, 2, 3> dpi;
+            dpi << fx * iz, 0.0, -fx * p.x() * iz2, 0.0, fy * iz, -fy * p.y() * iz2;
+            Eigen::Matrix<double, 3, 6> dp;
+            dp << Eigen::Matrix3d::Identity(), -SO3::hat(p);
+            return dpi * dp;
+        }
+    } // namespace
+
+    DirectTracker::DirectTracker(const CameraModel &cm_, int levels_, int minLevel_, size_t maxPoints_)
+        : cm(cm_), levels(std::max(1, levels_)), minLevel(std::clamp(minLevel_, 0, levels - 1)), maxPoints(maxPoints_), model(cm_) {
+        patches.resize(size_t(levels));
+        pyramid.resize(size_t(levels));
+    }
+
+    bool DirectTracker::buildPyramid(const cv::Mat &img) {
+        if (img.empty() || img.depth() != CV_8U) return false;
+        if (img.channels() == 3) cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+        else if (img.channels() == 1) gray = img;
+        else return false;
+
+        pyramid[0] = gray;
+        for (int l = 1; l < levels; l++) halfSample(pyramid[size_t(l - 1)], pyramid[size_t(l)]);
+        return true;
+    }
+
+    void DirectTracker::projectPoints(const SE3 &T) const {
+        // Raw pixels of every reference point seen from T, one batch through the camera model.
+        batchPoints.resize(points.size());
+        for (size_t i = 0; i < points.size(); i++) {
+            const Eigen::Vector3d p = T * points[i].pos;
+            batchPoints.x[i] = float(p.x());
+            batchPoints.y[i] = float(p.y());
+            batchPoints.z[i] = float(p.z());
+        }
+        model.project(batchPoints, batchPixels, batchValid);
+        for (size_t i = 0; i < points.size(); i++) batchValid[i] &= uint8_t(batchPoints.z[i] > 0.0f);
+    }
+
+    bool DirectTracker::setReference(const Frame &kf, const std::vector<int> &kpLandmark, const Map &map) {
+        reset();
+        if (!buildPyramid(kf.frame)) return false;
+        refPose = kf.pose;
+
+        const CameraIntrinsic &cI = cm.cI;
+        const SE3 Trw = kf.pose.inverse();
+        const auto &landmarks = map.getLandmarks();
+        const int n = PATCH * PATCH;
+        const float half = 0.5f * float(PATCH - 1);
+
+        // Points with a depth: the keypoint ray at the landmark depth, so the point projects exactly onto its keypoint.
+        for (size_t i = 0; i < kpLandmark.size() && i < kf.kp.size(); i++) {
+            if (kpLandmark[i] < 0) continue;
+            auto it = landmarks.find(kpLandmark[i]);
+            if (it == landmarks.end()) continue;
+
+            const cv::Point3f &X = it->second.pos;
+            const Eigen::Vector3d Xc = Trw * Eigen::Vector3d(X.x, X.y, X.z);
+            if (Xc.z() <= 0.0) continue;
+
+            const cv::Point2f &u = kf.undistorted(i);
+            const Eigen::Vector3d pos = Eigen::Vector3d((u.x - cI.cx) / cI.fx, (u.y - cI.cy) / cI.fy, 1.0) * Xc.z();
+            points.push_back({kpLandmark[i], pos, cv::Point2f()});
+        }
+        projectPoints(SE3());
+
+        // Candidates scored by the gradient of their level 0 patch.
+        std::vector<Point> candidates;
+        std::vector<float> score;
+        float val[n], gx[n], gy[n];
+        for (size_t i = 0; i < points.size(); i++) {
+            if (!batchValid[i]) continue;
+            const cv::Point2f c(batchPixels.u[i], batchPixels.v[i]);
+            const float x = c.x - half, y = c.y - half;
+            if (!inside(pyramid[0], x - 1.0f, y - 1.0f, PATCH + 2)) continue;
+
+            sampleGradients(pyramid[0], x, y, PATCH, val, gx, gy);
+            float g = 0.0f;
+            for (int k = 0; k < n; k++) g += gx[k] * gx[k] + gy[k] * gy[k];
+            if (g < minGradient * minGradient * float(n)) continue;
+
+            candidates.push_back({points[i].landmark, points[i].pos, c});
+            score.push_back(g);
+        }
+        points.clear();
+
+        std::vector<size_t> order(candidates.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return score[a] > score[b]; });
+        if (order.size() > maxPoints) order.resize(maxPoints);
+        for (size_t k : order) points.push_back(candidates[k]);
+
+        // Alignment patches and their constant Jacobians, zero-mean per patch.
+        for (int l = 0; l < levels; l++) {
+            LevelPatches &lp = patches[size_t(l)];
+            lp.intensity.assign(points.size() * n, 0.0f);
+            lp.jacobian.assign(points.size() * n, Vector6f::Zero());
+            lp.hessian.assign(points.size(), Eigen::Matrix<float, 6, 6>::Zero());
+            lp.valid.assign(points.size(), 0);
+
+            const double s = 1.0 / double(1 << l);
+            for (size_t i = 0; i < points.size(); i++) {
+                const cv::Point2f c = toLevel(points[i].center, l);
+                if (!inside(pyramid[size_t(l)], c.x - half - 1.0f, c.y - half - 1.0f, PATCH + 2)) continue;
+
+                sampleGradients(pyramid[size_t(l)], c.x - half, c.y - half, PATCH, &lp.intensity[i * n], gx, gy);
+                const Eigen::Matrix<double, 2, 6> Jp = projectionJacobian(points[i].pos, cI.fx * s, cI.fy * s);
+
+                Vector6d mean = Vector6d::Zero();
+                for (int k = 0; k < n; k++) {
+                    const Vector6d J = double(gx[k]) * Jp.row(0).transpose() + double(gy[k]) * Jp.row(1).transpose();
+                    lp.jacobian[i * n + size_t(k)] = J.cast<float>();
+                    mean += J;
+                }
+                mean /= double(n);
+
+                Matrix6d H = Matrix6d::Zero();
+                for (int k = 0; k < n; k++) {
+                    Vector6f &J = lp.jacobian[i * n + size_t(k)];
+                    J -= mean.cast<float>();
+                    H.noalias() += J.cast<double>() * J.cast<double>().transpose();
+                }
+                lp.hessian[i] = H.cast<float>();
+                lp.valid[i] = 1;
+            }
+        }
+
+        // Refinement patches on level 0 with their inverse 3x3 (x, y, brightness) Hessian.
+        const int m = REFINE_PATCH * REFINE_PATCH;
+        const float rhalf = 0.5f * float(REFINE_PATCH - 1);
+        refineIntensity.assign(points.size() * m, 0.0f);
+        refineGx.assign(points.size() * m, 0.0f);
+        refineGy.assign(points.size() * m, 0.0f);
+        refineHinv.assign(points.size(), Eigen::Matrix3f::Zero());
+        refineValid.assign(points.size(), 0);
+        for (size_t i = 0; i < points.size(); i++) {
+            const cv::Point2f &c = points[i].center;
+            if (!inside(pyramid[0], c.x - rhalf - 1.0f, c.y - rhalf - 1.0f, REFINE_PATCH + 2)) continue;
+
+            float *gxi = &refineGx[i * m], *gyi = &refineGy[i * m];
+            sampleGradients(pyramid[0], c.x - rhalf, c.y - rhalf, REFINE_PATCH, &refineIntensity[i * m], gxi, gyi);
+            Eigen::Matrix3d H = Eigen::Matrix3d::Zero();
+            for (int k = 0; k < m; k++) {
+                const Eigen::Vector3d J(gxi[k], gyi[k], 1.0);
+                H.noalias() += J * J.transpose();
+            }
+            if (std::abs(H.determinant()) < 1e-6) continue;
+            refineHinv[i] = H.inverse().cast<float>();
+            refineValid[i] = 1;
+        }
+
+        if (int(points.size()) < minPoints) {
+            reset();
+            return false;
+        }
+        return true;
+    }
+
+    void DirectTracker::alignLevel(int level, SE3 &T, int &visible, double &error) const {
+        const LevelPatches &lp = patches[size_t(level)];
+        const cv::Mat &img = pyramid[size_t(level)];
+        const int n = PATCH * PATCH;
+        const float half = 0.5f * float(PATCH - 1);
+
+        // Cost, Hessian and gradient at T, the Jacobians are those of the reference.
+        auto evaluate = [&](const SE3 &Tc, Matrix6d &H, Vector6d &b, int &count, double &absError) {
+            H.setZero();
+            b.setZero();
+            count = 0;
+            absError = 0.0;
+            double cost = 0.0;
+            float cur[n], r[n];
+            projectPoints(Tc);
+            for (size_t i = 0; i < points.size(); i++) {
+                if (!lp.valid[i] || !batchValid[i]) continue;
+                const cv::Point2f c = toLevel(cv::Point2f(batchPixels.u[i], batchPixels.v[i]), level);
+                if (!inside(img, c.x - half, c.y - half, PATCH)) continue;
+                samplePatch(img, c.x - half, c.y - half, PATCH, cur);
+
+                const float *ref = &lp.intensity[i * n];
+                float mean = 0.0f;
+                for (int k = 0; k < n; k++) {
+                    r[k] = cur[k] - ref[k];
+                    mean += r[k];
+                }
+                mean /= float(n);
+
+                bool inlier = true;
+                Vector6d Jr = Vector6d::Zero();
+                Matrix6d Hw = Matrix6d::Zero();
+                for (int k = 0; k < n; k++) {
+                    r[k] -= mean;
+                    absError += std::abs(r[k]);
+                    cost += huberCost(r[k], huber);
+                    const float w = huberWeight(r[k], huber);
+                    const Vector6d J = lp.jacobian[i * n + size_t(k)].cast<double>();
+                    Jr.noalias() += double(w * r[k]) * J;
+                    if (w < 1.0f) inlier = false;
+                }
+
+                // Unweighted patches reuse the precomputed Hessian.
+                if (inlier) {
+                    H += lp.hessian[i].cast<double>();
+                } else {
+                    for (int k = 0; k < n; k++) {
+                        const Vector6d J = lp.jacobian[i * n + size_t(k)].cast<double>();
+                        Hw.noalias() += double(huberWeight(r[k], huber)) * J * J.transpose();
+                    }
+                    H += Hw;
+                }
+                b += Jr;
+                count++;
+            }
+            if (count) absError /= double(count * n);
+            return count ? cost / double(count) : std::numeric_limits<double>::max();
+        };
+
+        Matrix6d H;
+        Vector6d b;
+        double last = std::numeric_limits<double>::max();
+        SE3 previous = T;
+        for (int it = 0; it < iterations; it++) {
+            int count;
+            double absError;
+            const double cost = evaluate(T, H, b, count, absError);
+            if (count < 6 || cost > last) {
+                // The last step made things worse, keep the pose before it.
+                T = previous;
+                break;
+            }
+            last = cost;
+            visible = count;
+            error = absError;
+
+            const Vector6d delta = H.ldlt().solve(b);
+            if (!delta.allFinite()) break;
+            previous = T;
+            T = T * SE3::exp(-delta);
+            if (delta.squaredNorm() < 1e-10) break;
+        }
+    }
+
+    bool DirectTracker::refineFeature(size_t i, cv::Point2f &u) const {
+        if (!refineValid[i]) return false;
+        const cv::Mat &img = pyramid[0];
+        const int m = REFINE_PATCH * REFINE_PATCH;
+        const float rhalf = 0.5f * float(REFINE_PATCH - 1);
+        const float *ref = &refineIntensity[i * m], *gx = &refineGx[i * m], *gy = &refineGy[i * m];
+        const Eigen::Matrix3f &Hinv = refineHinv[i];
+
+        const cv::Point2f start = u;
+        float cur[m];
+        float bias = 0.0f;
+        for (int it = 0; it < 10; it++) {
+            if (!inside(img, u.x - rhalf, u.y - rhalf, REFINE_PATCH)) return false;
+            samplePatch(img, u.x - rhalf, u.y - rhalf, REFINE_PATCH, cur);
+
+            Eigen::Vector3f Jr = Eigen::Vector3f::Zero();
+            for (int k = 0; k < m; k++) {
+                const float e = cur[k] - ref[k] - bias;
+                Jr += Eigen::Vector3f(gx[k], gy[k], 1.0f) * e;
+            }
+            const Eigen::Vector3f step = Hinv * Jr;
+            u.x -= step.x();
+            u.y -= step.y();
+            bias += step.z();
+
+            if (std::abs(u.x - start.x) > refineRadius || std::abs(u.y - start.y) > refineRadius) return false;
+            if (step.x() * step.x() + step.y() * step.y() < 0.03f * 0.03f) return true;
+        }
+        return false;
+    }
+
+    int DirectTracker::refinePose(SE3 &T, const std::vector<size_t> &idx, const std::vector<cv::Point2f> &pred,
+        const std::vector<cv::Point2f> &meas, std::vector<uint8_t> &inlier) const {
+        const CameraIntrinsic &cI = cm.cI;
+
+        // Measurements in undistorted pixels: the refinement offset mapped through the local distortion Jacobian.
+        batchPoints.resize(idx.size());
+        for (size_t j = 0; j < idx.size(); j++) {
+            const Eigen::Vector3d p = T * points[idx[j]].pos;
+            batchPoints.x[j] = float(p.x());
+            batchPoints.y[j] = float(p.y());
+            batchPoints.z[j] = float(p.z());
+        }
+        model.projectJacobian(batchPoints, batchPixels, batchJacobians, batchValid);
+
+        std::vector<Eigen::Vector2d> target(idx.size());
+        for (size_t j = 0; j < idx.size(); j++) {
+            const double z = batchPoints.z[j], x = batchPoints.x[j] / z, y = batchPoints.y[j] / z;
+            Eigen::Vector2d d(meas[j].x - pred[j].x, meas[j].y - pred[j].y);
+
+            // d(pixel)/d(x/z, y/z) is the x, y block of the point Jacobian scaled by z.
+            Eigen::Matrix2d A;
+            A << batchJacobians.du_dx[j], batchJacobians.du_dy[j], batchJacobians.dv_dx[j], batchJacobians.dv_dy[j];
+            A *= z;
+            if (std::abs(A.determinant()) > 1e-12) d = Eigen::Vector2d(cI.fx, cI.fy).asDiagonal() * A.inverse() * d;
+            target[j] = Eigen::Vector2d(cI.fx * x + cI.cx, cI.fy * y + cI.cy) + d;
+        }
+
+        const double k = 1.0;
+        for (int it = 0; it < 10; it++) {
+            Matrix6d H = Matrix6d::Zero();
+            Vector6d b = Vector6d::Zero();
+            for (size_t j = 0; j < idx.size(); j++) {
+                const Eigen::Vector3d p = T * points[idx[j]].pos;
+                if (p.z() <= 0.0) continue;
+                const Eigen::Vector2d e = Eigen::Vector2d(cI.fx * p.x() / p.z() + cI.cx, cI.fy * p.y() / p.z() + cI.cy) - target[j];
+                const Eigen::Matrix<double, 2, 6> J = projectionJacobian(p, cI.fx, cI.fy);
+                const double w = huberWeight(float(e.norm()), float(k));
+                H.noalias() += w * J.transpose() * J;
+                b.noalias() += w * J.transpose() * e;
+            }
+            const Vector6d delta = -H.ldlt().solve(b);
+            if (!delta.allFinite()) break;
+            T = SE3::exp(delta) * T;
+            if (delta.squaredNorm() < 1e-12) break;
+        }
+
+        int count = 0;
+        inlier.assign(idx.size(), 0);
+        for (size_t j = 0; j < idx.size(); j++) {
+            const Eigen::Vector3d p = T * points[idx[j]].pos;
+            if (p.z() <= 0.0) continue;
+            const Eigen::Vector2d e = Eigen::Vector2d(cI.fx * p.x() / p.z() + cI.cx, cI.fy * p.y() / p.z() + cI.cy) - target[j];
+            if (e.norm() < reprojError) {
+                inlier[j] = 1;
+                count++;
+            }
+        }
+        return count;
+    }
+
+    bool DirectTracker::track(const cv::Mat &img, const SE3 &prior, DirectResult &res) {
+        res = DirectResult();
+        if (points.empty() || !buildPyramid(img)) return false;
+
+        // Relative pose T_current_reference.
+        SE3 T = prior.inverse() * refPose;
+        for (int l = levels - 1; l >= minLevel; l--) {
+            if (pyramid[size_t(l)].cols < 2 * PATCH || pyramid[size_t(l)].rows < 2 * PATCH) continue;
+            alignLevel(l, T, res.aligned, res.photometricError);
+        }
+        if (res.aligned < minPoints) return false;
+
+        // Refine every feature on its own, starting from the aligned projection.
+        std::vector<size_t> idx;
+        std::vector<cv::Point2f> pred, meas;
+        projectPoints(T);
+        for (size_t i = 0; i < points.size(); i++) {
+            if (!batchValid[i]) continue;
+            const cv::Point2f c(batchPixels.u[i], batchPixels.v[i]);
+            cv::Point2f u = c;
+            if (!refineFeature(i, u)) continue;
+            idx.push_back(i);
+            pred.push_back(c);
+            meas.push_back(u);
+        }
+        if (int(idx.size()) < minPoints) return false;
+
+        std::vector<uint8_t> inlier;
+        res.inliers = refinePose(T, idx, pred, meas, inlier);
+        if (res.inliers < minPoints) return false;
+
+        for (size_t j = 0; j < idx.size(); j++) {
+            if (!inlier[j]) continue;
+            res.landmarks.push_back(points[idx[j]].landmark);
+            res.points.push_back(meas[j]);
+        }
+        res.pose = refPose * T.inverse();
+        return true;
+    }
+
+    void DirectTracker::reset() {
+        points.clear();
+        for (auto &lp : patches) {
+            lp.intensity.clear();
+            lp.jacobian.clear();
+            lp.hessian.clear();
+            lp.valid.clear();
+        }
+        refineIntensity.clear();
+        refineGx.clear();
+        refineGy.clear();
+        refineHinv.clear();
+        refineValid.clear();
+    }
+
+} // namespace StringSLAM::Estimation
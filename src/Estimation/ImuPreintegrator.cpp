@@ -0,0 +1,193 @@
+#include <StringSLAM/Estimation/ImuPreintegrator.hpp>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace StringSLAM::Estimation
+{
+    static double seconds(const std::chrono::system_clock::duration &d) {
+        return std::chrono::duration<double>(d).count();
+    }
+
+    // ------------------ ImuQueue ------------------
+
+    void ImuQueue::push(const ImuMeasurement &m) {
+        std::lock_guard<std::mutex> lock(mtx);
+        queue.push_back(m);
+    }
+
+    bool ImuQueue::getInterval(const std::chrono::system_clock::time_point &t0, const std::chrono::system_clock::time_point &t1,
+        std::vector<ImuMeasurement> &out) {
+        out.clear();
+        std::lock_guard<std::mutex> lock(mtx);
+        if (queue.empty() || queue.back().timestamp < t1 || t1 <= t0) return false;
+
+        // Samples are held constant until the next one, so start from the last one at or before t0.
+        size_t first = 0;
+        while (first + 1 < queue.size() && queue[first + 1].timestamp <= t0) first++;
+
+        size_t last = first;
+        for (size_t i = first; i < queue.size() && queue[i].timestamp <= t1; i++) {
+            out.push_back(queue[i]);
+            last = i;
+        }
+
+        // The last sample before t1 is also the first one of the next interval.
+        queue.erase(queue.begin(), queue.begin() + last);
+        return !out.empty();
+    }
+
+    size_t ImuQueue::size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return queue.size();
+    }
+
+    size_t ImuQueue::loadEuRoC(const std::string &path) {
+        std::ifstream in(path);
+        if (!in) return 0;
+
+        size_t loaded = 0;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::replace(line.begin(), line.end(), ',', ' ');
+
+            std::istringstream ss(line);
+            long long ns;
+            ImuMeasurement m;
+            if (!(ss >> ns >> m.gyro.x() >> m.gyro.y() >> m.gyro.z() >> m.acc.x() >> m.acc.y() >> m.acc.z())) continue;
+
+            m.timestamp = std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+            this->push(m);
+            loaded++;
+        }
+        return loaded;
+    }
+
+    // ------------------ ImuPreintegration ------------------
+
+    void ImuPreintegration::reset(const ImuBias &b) {
+        *this = ImuPreintegration();
+        bias = b;
+    }
+
+    void ImuPreintegration::integrate(const Eigen::Vector3d &acc, const Eigen::Vector3d &gyro, double dt_, const ImuNoise &noise) {
+        if (dt_ <= 0.0) return;
+
+        const Eigen::Vector3d a = acc - bias.acc;
+        const Eigen::Vector3d w = gyro - bias.gyro;
+        const double dt2 = dt_ * dt_;
+
+        const SO3 dRinc = SO3::exp(w * dt_);
+        const Eigen::Matrix3d dRincM = dRinc.matrix();
+        const Eigen::Matrix3d Jr = SO3::rightJacobian(w * dt_);
+        const Eigen::Matrix3d aSkew = SO3::hat(a);
+        const Eigen::Matrix3d R = dR.matrix();
+
+        // Noise propagation (Forster et al.), uses the deltas before this step.
+        Eigen::Matrix<double, 9, 9> A = Eigen::Matrix<double, 9, 9>::Identity();
+        Eigen::Matrix<double, 9, 6> B = Eigen::Matrix<double, 9, 6>::Zero();
+        A.block<3, 3>(0, 0) = dRincM.transpose();
+        A.block<3, 3>(3, 0) = -R * aSkew * dt_;
+        A.block<3, 3>(6, 0) = -0.5 * R * aSkew * dt2;
+        A.block<3, 3>(6, 3) = Eigen::Matrix3d::Identity() * dt_;
+        B.block<3, 3>(0, 0) = Jr * dt_;
+        B.block<3, 3>(3, 3) = R * dt_;
+        B.block<3, 3>(6, 3) = 0.5 * R * dt2;
+
+        Eigen::Matrix<double, 6, 6> Qd = Eigen::Matrix<double, 6, 6>::Zero();
+        Qd.diagonal().head<3>().setConstant(noise.gyro * noise.gyro / dt_);
+        Qd.diagonal().tail<3>().setConstant(noise.acc * noise.acc / dt_);
+        cov = A * cov * A.transpose() + B * Qd * B.transpose();
+
+        // Bias Jacobians, position first since it uses the old velocity terms.
+        JPa += JVa * dt_ - 0.5 * R * dt2;
+        JPg += JVg * dt_ - 0.5 * R * aSkew * JRg * dt2;
+        JVa -= R * dt_;
+        JVg -= R * aSkew * JRg * dt_;
+        JRg = dRincM.transpose() * JRg - Jr * dt_;
+
+        dP += dV * dt_ + 0.5 * R * a * dt2;
+        dV += R * a * dt_;
+
+        dR = dR * dRinc;
+        dt += dt_;
+    }
+
+    SO3 ImuPreintegration::getDeltaR(const ImuBias &b) const {
+        return dR * SO3::exp(JRg * (b.gyro - bias.gyro));
+    }
+
+    ImuState ImuPreintegration::predict(const ImuState &s, const Eigen::Vector3d &gravity) const {
+        const Eigen::Vector3d dbg = s.bias.gyro - bias.gyro;
+        const Eigen::Vector3d dba = s.bias.acc - bias.acc;
+
+        ImuState out = s;
+        out.R = s.R * getDeltaR(s.bias);
+        out.v = s.v + gravity * dt + s.R * (dV + JVg * dbg + JVa * dba);
+        out.p = s.p + s.v * dt + 0.5 * gravity * dt * dt + s.R * (dP + JPg * dbg + JPa * dba);
+        return out;
+    }
+
+    // ------------------ ImuPreintegrator ------------------
+
+    ImuPreintegrator::ImuPreintegrator(const ImuNoise &noise_, const SO3 &R_imu_cam_) :
+        noise(noise_), R_imu_cam(R_imu_cam_) { }
+
+    bool ImuPreintegrator::integrate(ImuQueue &queue, const std::chrono::system_clock::time_point &t0,
+        const std::chrono::system_clock::time_point &t1, ImuPreintegration &out) const {
+        out.reset(bias);
+
+        std::vector<ImuMeasurement> samples;
+        if (!queue.getInterval(t0, t1, samples)) return false;
+
+        for (size_t k = 0; k < samples.size(); k++) {
+            const auto start = std::max(samples[k].timestamp, t0);
+            const auto end = (k + 1 < samples.size()) ? std::min(samples[k + 1].timestamp, t1) : t1;
+            out.integrate(samples[k].acc, samples[k].gyro, seconds(end - start), noise);
+        }
+        return out.dt > 0.0;
+    }
+
+    SO3 ImuPreintegrator::getCameraRotation(const ImuPreintegration &pi) const {
+        return R_imu_cam.inverse() * pi.getDeltaR(bias) * R_imu_cam;
+    }
+
+    SE3 ImuPreintegrator::predictCameraPose(const SE3 &T_world_prev, const ImuPreintegration &pi) const {
+        return T_world_prev * SE3(getCameraRotation(pi), Eigen::Vector3d::Zero());
+    }
+
+    void ImuPreintegrator::predictKeypoints(const CameraIntrinsic &cI, const SO3 &R_prev_cur,
+        const std::vector<cv::KeyPoint> &kp, std::vector<cv::Point2f> &predicted) const {
+        Eigen::Matrix3d K;
+        K << cI.fx, 0, cI.cx, 0, cI.fy, cI.cy, 0, 0, 1;
+
+        // Infinite homography, exact for pure rotation and a good seed at frame rate.
+        const Eigen::Matrix3d H = K * R_prev_cur.inverse().matrix() * K.inverse();
+
+        predicted.resize(kp.size());
+        for (size_t i = 0; i < kp.size(); i++) {
+            const Eigen::Vector3d x = H * Eigen::Vector3d(kp[i].pt.x, kp[i].pt.y, 1.0);
+            predicted[i] = x.z() > 1e-6 ? cv::Point2f(x.x() / x.z(), x.y() / x.z()) : kp[i].pt;
+        }
+    }
+
+    Poser::Pose2D ImuPreintegrator::predictPose2D(const CameraIntrinsic &cI, const SO3 &R_prev_cur) const {
+        Eigen::Matrix3d K;
+        K << cI.fx, 0, cI.cx, 0, cI.fy, cI.cy, 0, 0, 1;
+        const Eigen::Matrix3d Rt = R_prev_cur.inverse().matrix();
+        const Eigen::Vector3d c = K * Rt * K.inverse() * Eigen::Vector3d(cI.cx, cI.cy, 1.0);
+
+        // Roll about the optical axis plus the shift of the principal point.
+        const double theta = std::atan2(Rt(1, 0), Rt(0, 0));
+        const double cs = std::cos(theta), sn = std::sin(theta);
+
+        Poser::Pose2D pose;
+        pose.pos.x() = c.x() / c.z() - (cs * cI.cx - sn * cI.cy);
+        pose.pos.y() = c.y() / c.z() - (sn * cI.cx + cs * cI.cy);
+        pose.pos.z() = theta;
+        return pose;
+    }
+
+} // namespace StringSLAM::Estimation
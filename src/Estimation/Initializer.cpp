@@ -0,0 +1,434 @@
+#include <StringSLAM/Estimation/Initializer.hpp>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace StringSLAM::Estimation
+{
+    namespace
+    {
+        // Chi-square 95% bounds for 1 and 2 degrees of freedom.
+        constexpr double CHI2_1D = 3.841;
+        constexpr double CHI2_2D = 5.991;
+
+        // Points seen with less parallax than this (cos) are not triangulated.
+        constexpr double MIN_COS_PARALLAX = 0.99998;
+
+        // Second best motion candidate must score below this share of the best.
+        constexpr double AMBIGUITY = 0.75;
+
+        struct Model {
+            Eigen::Matrix3d M = Eigen::Matrix3d::Zero();
+            double score = -1.0;
+            int inliers = 0;
+        };
+
+        struct Candidate {
+            Eigen::Matrix3d R = Eigen::Matrix3d::Identity();
+            Eigen::Vector3d t = Eigen::Vector3d::Zero();
+            int good = 0;
+            double parallax = 0.0;
+            std::vector<Eigen::Vector3d> points;
+            std::vector<uint8_t> triangulated;
+        };
+
+        /*
+         * PROSAC growth function (Chum & Matas, 2005). Hypothesis t (1-based) samples
+         * from the best n matches where n is the first entry with growth[n] >= t,
+         * past growth[N] sampling is uniform.
+         */
+        std::vector<int> prosacGrowth(int N, int m, int iterations) {
+            std::vector<int> growth(N + 1, 0);
+            double Tn = iterations;
+            for (int i = 0; i < m; i++) Tn *= double(m - i) / double(N - i);
+
+            int tn = 1;
+            growth[m] = tn;
+            for (int n = m; n < N; n++) {
+                const double Tn1 = Tn * double(n + 1) / double(n + 1 - m);
+                tn += int(std::ceil(Tn1 - Tn));
+                growth[n + 1] = tn;
+                Tn = Tn1;
+            }
+            return growth;
+        }
+
+        void prosacSample(const std::vector<int> &growth, int m, int t, uint64_t seed, int *idx) {
+            const int N = int(growth.size()) - 1;
+            std::minstd_rand rng(uint32_t(seed ^ (uint64_t(t) * 0x9E3779B97F4A7C15ULL >> 16)) | 1u);
+
+            int k = 0, n = N;
+            auto it = std::lower_bound(growth.begin() + m, growth.end(), t);
+            if (it != growth.end()) {
+                // The newest match of the growing set is always part of the sample.
+                n = int(it - growth.begin()) - 1;
+                idx[k++] = n;
+            }
+            while (k < m) {
+                const int c = std::uniform_int_distribution<int>(0, n - 1)(rng);
+                if (std::find(idx, idx + k, c) == idx + k) idx[k++] = c;
+            }
+        }
+
+        // Symmetric point-to-epipolar-line score of a fundamental matrix (F21: x2' F x1 = 0).
+        void scoreFundamental(Model &model, const std::vector<cv::Point2f> &p1, const std::vector<cv::Point2f> &p2,
+            double invSigma2, std::vector<uint8_t> *mask) {
+            const Eigen::Matrix3d &F = model.M;
+            double score = 0.0;
+            int inliers = 0;
+            for (size_t i = 0; i < p1.size(); i++) {
+                const double u1 = p1[i].x, v1 = p1[i].y, u2 = p2[i].x, v2 = p2[i].y;
+                bool in = true;
+
+                // Line in the second image.
+                const double a2 = F(0, 0) * u1 + F(0, 1) * v1 + F(0, 2);
+                const double b2 = F(1, 0) * u1 + F(1, 1) * v1 + F(1, 2);
+                const double c2 = F(2, 0) * u1 + F(2, 1) * v1 + F(2, 2);
+                const double n2 = a2 * u2 + b2 * v2 + c2;
+                const double chi2 = n2 * n2 / (a2 * a2 + b2 * b2) * invSigma2;
+                if (chi2 > CHI2_1D) in = false;
+                else score += CHI2_2D - chi2;
+
+                // Line in the first image.
+                const double a1 = F(0, 0) * u2 + F(1, 0) * v2 + F(2, 0);
+                const double b1 = F(0, 1) * u2 + F(1, 1) * v2 + F(2, 1);
+                const double c1 = F(0, 2) * u2 + F(1, 2) * v2 + F(2, 2);
+                const double n1 = a1 * u1 + b1 * v1 + c1;
+                const double chi1 = n1 * n1 / (a1 * a1 + b1 * b1) * invSigma2;
+                if (chi1 > CHI2_1D) in = false;
+                else score += CHI2_2D - chi1;
+
+                inliers += in;
+                if (mask) (*mask)[i] = in;
+            }
+            model.score = score;
+            model.inliers = inliers;
+        }
+
+        // Symmetric transfer score of a homography (H21: x2 = H x1).
+        void scoreHomography(Model &model, const std::vector<cv::Point2f> &p1, const std::vector<cv::Point2f> &p2,
+            double invSigma2, std::vector<uint8_t> *mask) {
+            const Eigen::Matrix3d &H = model.M;
+            const Eigen::Matrix3d Hi = H.inverse();
+            double score = 0.0;
+            int inliers = 0;
+            for (size_t i = 0; i < p1.size(); i++) {
+                const double u1 = p1[i].x, v1 = p1[i].y, u2 = p2[i].x, v2 = p2[i].y;
+                bool in = true;
+
+                const double w2 = 1.0 / (H(2, 0) * u1 + H(2, 1) * v1 + H(2, 2));
+                const double du2 = u2 - (H(0, 0) * u1 + H(0, 1) * v1 + H(0, 2)) * w2;
+                const double dv2 = v2 - (H(1, 0) * u1 + H(1, 1) * v1 + H(1, 2)) * w2;
+                const double chi2 = (du2 * du2 + dv2 * dv2) * invSigma2;
+                if (!(chi2 <= CHI2_2D)) in = false;
+                else score += CHI2_2D - chi2;
+
+                const double w1 = 1.0 / (Hi(2, 0) * u2 + Hi(2, 1) * v2 + Hi(2, 2));
+                const double du1 = u1 - (Hi(0, 0) * u2 + Hi(0, 1) * v2 + Hi(0, 2)) * w1;
+                const double dv1 = v1 - (Hi(1, 0) * u2 + Hi(1, 1) * v2 + Hi(1, 2)) * w1;
+                const double chi1 = (du1 * du1 + dv1 * dv1) * invSigma2;
+                if (!(chi1 <= CHI2_2D)) in = false;
+                else score += CHI2_2D - chi1;
+
+                inliers += in;
+                if (mask) (*mask)[i] = in;
+            }
+            model.score = score;
+            model.inliers = inliers;
+        }
+
+        // 3x3 block of a CV_64F matrix starting at row r.
+        Eigen::Matrix3d toEigen(const cv::Mat &m, int r = 0) {
+            Eigen::Matrix3d M;
+            for (int i = 0; i < 3; i++)
+                for (int j = 0; j < 3; j++) M(i, j) = m.at<double>(r + i, j);
+            return M;
+        }
+
+        int requiredIterations(int inliers, int N, int m, double confidence, int maxIterations) {
+            const double w = double(inliers) / double(N);
+            const double miss = 1.0 - std::pow(w, m);
+            if (miss <= std::numeric_limits<double>::epsilon()) return 1;
+            if (miss >= 1.0) return maxIterations;
+            const double k = std::ceil(std::log(1.0 - confidence) / std::log(miss));
+            return int(std::min<double>(k, maxIterations));
+        }
+
+        // Triangulate the inliers for one motion (x2 = R x1 + t) and count the points passing every check.
+        void checkMotion(Candidate &c, const std::vector<cv::Point2f> &p1, const std::vector<cv::Point2f> &p2,
+            const std::vector<uint8_t> &inliers, const CameraIntrinsic &cI, double th2, int minTriangulated) {
+            const size_t N = p1.size();
+            c.good = 0;
+            c.points.assign(N, Eigen::Vector3d::Zero());
+            c.triangulated.assign(N, 0);
+
+            const Eigen::Matrix3d &R = c.R;
+            const Eigen::Vector3d &t = c.t;
+            const Eigen::Vector3d O2 = -R.transpose() * t;
+
+            std::vector<double> parallaxes;
+            parallaxes.reserve(N);
+            for (size_t i = 0; i < N; i++) {
+                if (!inliers[i]) continue;
+                const double x1 = (p1[i].x - cI.cx) / cI.fx, y1 = (p1[i].y - cI.cy) / cI.fy;
+                const double x2 = (p2[i].x - cI.cx) / cI.fx, y2 = (p2[i].y - cI.cy) / cI.fy;
+
+                // Linear triangulation, (x r3 - r1) X = t1 - x t3 for both cameras.
+                Eigen::Matrix<double, 4, 3> A;
+                Eigen::Vector4d b;
+                A << -1.0, 0.0, x1,
+                     0.0, -1.0, y1,
+                     x2 * R.row(2) - R.row(0),
+                     y2 * R.row(2) - R.row(1);
+                b << 0.0, 0.0, t(0) - x2 * t(2), t(1) - y2 * t(2);
+                const Eigen::Vector3d X = (A.transpose() * A).ldlt().solve(A.transpose() * b);
+                if (!X.allFinite()) continue;
+
+                const Eigen::Vector3d n1 = X, n2 = X - O2;
+                const double cosParallax = n1.dot(n2) / (n1.norm() * n2.norm());
+
+                // In front of both cameras, unless too far away to tell.
+                const Eigen::Vector3d X2 = R * X + t;
+                if (X.z() <= 0.0 && cosParallax < MIN_COS_PARALLAX) continue;
+                if (X2.z() <= 0.0 && cosParallax < MIN_COS_PARALLAX) continue;
+
+                const double du1 = cI.fx * X.x() / X.z() + cI.cx - p1[i].x;
+                const double dv1 = cI.fy * X.y() / X.z() + cI.cy - p1[i].y;
+                if (du1 * du1 + dv1 * dv1 > th2) continue;
+                const double du2 = cI.fx * X2.x() / X2.z() + cI.cx - p2[i].x;
+                const double dv2 = cI.fy * X2.y() / X2.z() + cI.cy - p2[i].y;
+                if (du2 * du2 + dv2 * dv2 > th2) continue;
+
+                c.good++;
+                parallaxes.push_back(std::acos(std::clamp(cosParallax, -1.0, 1.0)));
+                if (cosParallax < MIN_COS_PARALLAX) {
+                    c.points[i] = X;
+                    c.triangulated[i] = 1;
+                }
+            }
+
+            // Parallax reached by the minTriangulated-th best point.
+            c.parallax = 0.0;
+            if (!parallaxes.empty()) {
+                const size_t k = std::min(parallaxes.size(), size_t(minTriangulated)) - 1;
+                std::nth_element(parallaxes.begin(), parallaxes.begin() + k, parallaxes.end(), std::greater<double>());
+                c.parallax = parallaxes[k] * 180.0 / CV_PI;
+            }
+        }
+    } // namespace
+
+    Initializer::Initializer(const CameraIntrinsic &cI_, std::shared_ptr<Utils::ThreadPool> pool_) : cI(cI_), pool(pool_) {
+        if (!pool) pool = Utils::ThreadPool::create();
+    }
+
+    bool Initializer::initialize(const Frame &ref, Frame &cur, const std::vector<cv::DMatch> &matches, InitResult &result) const {
+        using Clock = std::chrono::steady_clock;
+        const auto start = Clock::now();
+        result = InitResult();
+
+        // PROSAC order, best match first.
+        std::vector<int> order;
+        order.reserve(matches.size());
+        for (size_t i = 0; i < matches.size(); i++) {
+            const auto &m = matches[i];
+            if (m.queryIdx >= 0 && size_t(m.queryIdx) < ref.kp.size() && m.trainIdx >= 0 && size_t(m.trainIdx) < cur.kp.size())
+                order.push_back(int(i));
+        }
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return matches[a].distance < matches[b].distance; });
+
+        const int N = int(order.size());
+        if (N < std::max(8, minTriangulated)) return false;
+
+        std::vector<cv::Point2f> p1(N), p2(N);
+        for (int i = 0; i < N; i++) {
+            p1[i] = ref.undistorted(matches[order[i]].queryIdx);
+            p2[i] = cur.undistorted(matches[order[i]].trainIdx);
+        }
+
+        const double invSigma2 = 1.0 / (sigma * sigma);
+        const cv::Mat K = cI.getK();
+        Eigen::Matrix3d Ke;
+        Ke << cI.fx, 0.0, cI.cx, 0.0, cI.fy, cI.cy, 0.0, 0.0, 1.0;
+        const Eigen::Matrix3d Kinv = Ke.inverse();
+        const std::vector<int> growthE = prosacGrowth(N, 5, maxIterations);
+        const std::vector<int> growthH = prosacGrowth(N, 4, maxIterations);
+
+        // Sampling leaves a quarter of the budget for the reconstruction.
+        const auto samplingBudget = timeBudget * 3 / 4;
+        const size_t batch = batchSize ? batchSize : 2 * (pool->size() + 1);
+        std::vector<Model> batchE(batch), batchH(batch);
+
+        Model bestE, bestH;
+        int neededE = maxIterations, neededH = maxIterations, needed = maxIterations, drawn = 0;
+        while (drawn < needed) {
+            const int count = std::min(int(batch), needed - drawn);
+            pool->parallelFor(0, size_t(count), [&](size_t b) {
+                const int t = drawn + int(b) + 1;
+                int idx[5];
+                batchE[b] = Model();
+                batchH[b] = Model();
+
+                if (t <= neededE) {
+                    prosacSample(growthE, 5, t, seed, idx);
+                    std::vector<cv::Point2f> s1(5), s2(5);
+                    for (int k = 0; k < 5; k++) {
+                        s1[k] = p1[idx[k]];
+                        s2[k] = p2[idx[k]];
+                    }
+
+                    // A minimal set returns every real root of the 5-point solver, stacked 3 rows each.
+                    const cv::Mat Es = cv::findEssentialMat(s1, s2, K, cv::RANSAC, 0.999, sigma);
+                    for (int r = 0; r + 3 <= Es.rows; r += 3) {
+                        Model m;
+                        m.M = Kinv.transpose() * toEigen(Es, r) * Kinv;
+                        scoreFundamental(m, p1, p2, invSigma2, nullptr);
+                        if (m.score > batchE[b].score) batchE[b] = m;
+                    }
+                }
+
+                if (t <= neededH) {
+                    prosacSample(growthH, 4, t, seed ^ 0x4848ULL, idx);
+                    cv::Point2f s1[4], s2[4];
+                    for (int k = 0; k < 4; k++) {
+                        s1[k] = p1[idx[k]];
+                        s2[k] = p2[idx[k]];
+                    }
+
+                    Model m;
+                    const cv::Mat H = cv::getPerspectiveTransform(s1, s2);
+                    if (H.rows == 3 && H.cols == 3) {
+                        m.M = toEigen(H);
+                        if (m.M.allFinite() && std::abs(m.M.determinant()) > 1e-12) {
+                            scoreHomography(m, p1, p2, invSigma2, nullptr);
+                            batchH[b] = m;
+                        }
+                    }
+                }
+            });
+            drawn += count;
+
+            for (int b = 0; b < count; b++) {
+                if (batchE[b].score > bestE.score) bestE = batchE[b];
+                if (batchH[b].score > bestH.score) bestH = batchH[b];
+            }
+            neededE = std::max(1, requiredIterations(bestE.inliers, N, 5, confidence, maxIterations));
+            neededH = std::max(1, requiredIterations(bestH.inliers, N, 4, confidence, maxIterations));
+
+            // Stop once the leading model is confident, the trailing one only has to lose the selection.
+            needed = bestH.score > bestE.score ? neededH : neededE;
+
+            if (Clock::now() - start > samplingBudget) break;
+        }
+        result.iterations = drawn;
+        if (bestE.score <= 0.0 && bestH.score <= 0.0) return false;
+
+        // Model selection, a homography explains planar and low-parallax scenes better.
+        const double sE = std::max(0.0, bestE.score), sH = std::max(0.0, bestH.score);
+        result.homography = sH / (sH + sE) > homographyRatio;
+
+        std::vector<uint8_t> inliers(N, 0);
+        std::vector<Candidate> candidates;
+        if (result.homography) {
+            scoreHomography(bestH, p1, p2, invSigma2, &inliers);
+            cv::Mat H(3, 3, CV_64F);
+            for (int i = 0; i < 3; i++)
+                for (int j = 0; j < 3; j++) H.at<double>(i, j) = bestH.M(i, j);
+
+            std::vector<cv::Mat> Rs, ts, normals;
+            cv::decomposeHomographyMat(H, K, Rs, ts, normals);
+            for (size_t i = 0; i < Rs.size(); i++) {
+                Candidate c;
+                SE3 T = SE3::fromCv(Rs[i], ts[i]);
+                c.R = T.rotation();
+                c.t = T.translation();
+                candidates.push_back(c);
+            }
+        } else {
+            scoreFundamental(bestE, p1, p2, invSigma2, &inliers);
+            // E = [t]x R has two rotations and a translation up to sign.
+            const Eigen::Matrix3d E = Ke.transpose() * bestE.M * Ke;
+            Eigen::JacobiSVD<Eigen::Matrix3d> svd(E, Eigen::ComputeFullU | Eigen::ComputeFullV);
+            Eigen::Matrix3d U = svd.matrixU(), V = svd.matrixV();
+            if (U.determinant() < 0.0) U = -U;
+            if (V.determinant() < 0.0) V = -V;
+            Eigen::Matrix3d W;
+            W << 0, -1, 0, 1, 0, 0, 0, 0, 1;
+
+            for (const Eigen::Matrix3d &R : {Eigen::Matrix3d(U * W * V.transpose()), Eigen::Matrix3d(U * W.transpose() * V.transpose())}) {
+                for (double sign : {1.0, -1.0}) {
+                    Candidate c;
+                    c.R = R;
+                    c.t = sign * U.col(2);
+                    candidates.push_back(c);
+                }
+            }
+        }
+        const int modelInliers = result.homography ? bestH.inliers : bestE.inliers;
+        if (candidates.empty()) return false;
+
+        const double th2 = 4.0 * sigma * sigma;
+        pool->parallelFor(0, candidates.size(), [&](size_t i) {
+            checkMotion(candidates[i], p1, p2, inliers, cI, th2, minTriangulated);
+        });
+
+        size_t best = 0;
+        for (size_t i = 1; i < candidates.size(); i++)
+            if (candidates[i].good > candidates[best].good) best = i;
+        const Candidate &c = candidates[best];
+
+        // Reject ambiguous motion, too few points, or too little parallax.
+        for (size_t i = 0; i < candidates.size(); i++)
+            if (i != best && candidates[i].good > AMBIGUITY * c.good) return false;
+        if (c.good < std::max(minTriangulated, int(0.9 * modelInliers))) return false;
+        if (c.parallax < minParallax) return false;
+
+        // Monocular scale is arbitrary, fix the median depth of the reference view to 1.
+        std::vector<double> depths;
+        for (int i = 0; i < N; i++)
+            if (c.triangulated[i]) depths.push_back(c.points[i].z());
+        if (int(depths.size()) < minTriangulated) return false;
+        std::nth_element(depths.begin(), depths.begin() + depths.size() / 2, depths.end());
+        const double median = depths[depths.size() / 2];
+        if (median <= 0.0) return false;
+        const double scale = 1.0 / median;
+
+        result.points.reserve(depths.size());
+        result.matchIdx.reserve(depths.size());
+        for (int i = 0; i < N; i++) {
+            if (!c.triangulated[i]) continue;
+            const Eigen::Vector3d X = c.points[i] * scale;
+            result.points.emplace_back(float(X.x()), float(X.y()), float(X.z()));
+            result.matchIdx.push_back(order[i]);
+        }
+
+        result.T_ref_cur = SE3(c.R, c.t * scale).inverse();
+        result.parallax = c.parallax;
+        cur.pose = ref.pose * result.T_ref_cur;
+        return true;
+    }
+
+    bool Initializer::initialize(const Frame &ref, Frame &cur, const std::vector<cv::DMatch> &matches, Map &map,
+        InitResult &result) const {
+        if (ref.id == cur.id) return false;
+        if (!initialize(ref, cur, matches, result)) return false;
+
+        map.addKeyframe(ref);
+        map.addKeyframe(cur);
+
+        result.landmarkIds.reserve(result.points.size());
+        for (size_t i = 0; i < result.points.size(); i++) {
+            const cv::Point3f &p = result.points[i];
+            const Eigen::Vector3d X = ref.pose * Eigen::Vector3d(p.x, p.y, p.z);
+
+            MapPoint mp;
+            mp.pos = cv::Point3f(float(X.x()), float(X.y()), float(X.z()));
+            mp.observations = {ref.id, cur.id};
+            result.landmarkIds.push_back(map.addLandmark(mp, ref.id, matches[result.matchIdx[i]].queryIdx));
+        }
+        return true;
+    }
+
+} // namespace StringSLAM::Estimation
@@ -0,0 +1,332 @@
+#include <StringSLAM/Estimation/Optimizer.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace StringSLAM::Estimation
+{
+    using Vector7d = Eigen::Matrix<double, 7, 1>;
+    using Matrix7d = Eigen::Matrix<double, 7, 7>;
+
+    // Right update S * E(d), E has the same first order terms as the Sim(3) exponential.
+    // Updating in the keyframe frame keeps H well conditioned far from the world origin.
+    static Sim3 retract(const Sim3 &S, const Vector7d &d) {
+        return S * Sim3(SO3::exp(d.segment<3>(3)), d.head<3>(), std::exp(d(6)));
+    }
+
+    // Residual (translation, rotation, log scale) of E = Z^-1 * Si^-1 * Sj.
+    static Vector7d residual(const Sim3 &E) {
+        Vector7d r;
+        r.head<3>() = E.translation();
+        r.segment<3>(3) = E.so3().log();
+        r(6) = std::log(E.scale());
+        return r;
+    }
+
+    // Jacobians of the residual w.r.t. the updates of Si and Sj, to first order:
+    // E * E(dj) for Sj and E * E(-Adj(Sj^-1 Si) di) for Si.
+    static void jacobians(const Sim3 &E, const Vector7d &r, const Sim3 &Si, const Sim3 &Sj, Matrix7d &Ji, Matrix7d &Jj) {
+        Jj.setZero();
+        Jj.block<3, 3>(0, 0) = E.scale() * E.so3().matrix();
+        Jj.block<3, 3>(3, 3) = SO3::rightJacobianInverse(r.segment<3>(3));
+        Jj(6, 6) = 1.0;
+        Ji = -Jj * (Sj.inverse() * Si).adjoint();
+    }
+
+    PoseGraph::PoseGraph(bool estimateScale_) : estimateScale(estimateScale_) { }
+
+    PoseGraph::~PoseGraph() {
+        this->wait();
+    }
+
+    void PoseGraph::addVertex(int id, const SE3 &pose, bool fixed) {
+        std::lock_guard<std::mutex> lock(mtx);
+        Vertex &v = graph.vertices[id];
+        v.pose = Sim3(pose);
+        v.fixed = fixed;
+    }
+
+    void PoseGraph::addOdometryEdge(int from, int to, const SE3 &T_from_to, const Eigen::Matrix<double, 6, 6> &information) {
+        PoseGraphEdge e;
+        e.from = from;
+        e.to = to;
+        e.measurement = Sim3(T_from_to);
+        e.information.topLeftCorner<6, 6>() = information;
+        e.loop = false;
+
+        std::lock_guard<std::mutex> lock(mtx);
+        graph.edges.push_back(e);
+    }
+
+    void PoseGraph::addLoopEdge(int from, int to, const Sim3 &S_from_to, const Eigen::Matrix<double, 7, 7> &information) {
+        PoseGraphEdge e;
+        e.from = from;
+        e.to = to;
+        e.measurement = estimateScale ? S_from_to : Sim3(S_from_to.toSE3());
+        e.information = information;
+        e.loop = true;
+
+        std::lock_guard<std::mutex> lock(mtx);
+        graph.edges.push_back(e);
+    }
+
+    void PoseGraph::addKeyframes(const Map &map) {
+        std::lock_guard<std::mutex> lock(mtx);
+        const bool first = graph.vertices.empty();
+
+        const Frame *prev = nullptr;
+        const auto &keyframes = map.getKeyframes();
+        for (auto &[id, kf] : keyframes) {
+            if (!graph.vertices.count(id)) {
+                Vertex &v = graph.vertices[id];
+                v.pose = Sim3(kf.pose);
+                v.fixed = first && prev == nullptr;
+
+                // Link to the spanning tree parent (strongest covisibility), else to the previous keyframe.
+                const Frame *from = prev;
+                auto parent = keyframes.find(map.getSpanningParent(id));
+                if (parent != keyframes.end() && graph.vertices.count(parent->first)) from = &parent->second;
+
+                if (from) {
+                    PoseGraphEdge e;
+                    e.from = from->id;
+                    e.to = id;
+                    e.measurement = Sim3(from->pose.inverse() * kf.pose);
+                    graph.edges.push_back(e);
+                }
+            }
+            prev = &kf;
+        }
+    }
+
+    int PoseGraph::solve(Problem &p, int iterations) {
+        std::lock_guard<std::mutex> lock(solveMtx);
+        const int dof = estimateScale ? 7 : 6;
+
+        // State index of every free vertex, the first vertex fixes the gauge if nothing else does.
+        bool anyFixed = false;
+        for (auto &[id, v] : p.vertices) anyFixed |= v.fixed;
+
+        std::map<int, int> index;
+        std::vector<Vertex *> active;
+        for (auto &[id, v] : p.vertices) {
+            if (v.fixed || (!anyFixed && id == p.vertices.begin()->first)) continue;
+            index[id] = int(active.size());
+            active.push_back(&v);
+        }
+        if (active.empty()) return 0;
+
+        // Resolve edges once, missing vertices drop the edge. Every edge writes up to
+        // three blocks of the lower triangle of H: (i, i), (j, j) and (max, min).
+        struct Linked {
+            Sim3 *Si, *Sj;
+            int i, j;
+            Sim3 Zinv;
+            const Matrix7d *info;
+            int ii, jj, ij;
+        };
+        std::vector<Linked> linked;
+        std::vector<std::pair<int, int>> blocks;
+        linked.reserve(p.edges.size());
+        for (int k = 0; k < int(active.size()); k++) blocks.emplace_back(k, k);
+        for (auto &e : p.edges) {
+            auto vi = p.vertices.find(e.from), vj = p.vertices.find(e.to);
+            if (vi == p.vertices.end() || vj == p.vertices.end() || e.from == e.to) continue;
+
+            auto ii = index.find(e.from), jj = index.find(e.to);
+            const int i = ii == index.end() ? -1 : ii->second;
+            const int j = jj == index.end() ? -1 : jj->second;
+            if (i < 0 && j < 0) continue;
+            linked.push_back({&vi->second.pose, &vj->second.pose, i, j, e.measurement.inverse(), &e.information, -1, -1, -1});
+            if (i >= 0 && j >= 0) blocks.emplace_back(std::max(i, j), std::min(i, j));
+        }
+        std::sort(blocks.begin(), blocks.end(), [](auto &a, auto &b) { return a.second != b.second ? a.second < b.second : a.first < b.first; });
+        blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+
+        auto slotOf = [&](int r, int c) {
+            return int(std::lower_bound(blocks.begin(), blocks.end(), std::make_pair(r, c), [](auto &a, auto &b) {
+                return a.second != b.second ? a.second < b.second : a.first < b.first;
+            }) - blocks.begin());
+        };
+        std::vector<int> diagonal(active.size());
+        for (int k = 0; k < int(active.size()); k++) diagonal[k] = slotOf(k, k);
+        for (auto &l : linked) {
+            if (l.i >= 0) l.ii = diagonal[l.i];
+            if (l.j >= 0) l.jj = diagonal[l.j];
+            if (l.i >= 0 && l.j >= 0) l.ij = slotOf(std::max(l.i, l.j), std::min(l.i, l.j));
+        }
+
+        // Build the pattern once, iterations then write straight into the value array.
+        const int n = int(active.size()) * dof;
+        Eigen::SparseMatrix<double> H(n, n);
+        {
+            std::vector<Eigen::Triplet<double>> triplets;
+            triplets.reserve(blocks.size() * dof * dof);
+            for (auto &[br, bc] : blocks)
+                for (int c = 0; c < dof; c++)
+                    for (int r = 0; r < dof; r++) triplets.emplace_back(br * dof + r, bc * dof + c, 0.0);
+            H.setFromTriplets(triplets.begin(), triplets.end());
+            H.makeCompressed();
+        }
+
+        // Offset of the first row of every block column inside the value array.
+        std::vector<int> offsets(blocks.size() * dof);
+        for (size_t k = 0; k < blocks.size(); k++) {
+            for (int c = 0; c < dof; c++) {
+                const int col = blocks[k].second * dof + c;
+                const int *begin = H.innerIndexPtr() + H.outerIndexPtr()[col];
+                const int *end = H.innerIndexPtr() + H.outerIndexPtr()[col + 1];
+                offsets[k * dof + c] = int(std::lower_bound(begin, end, blocks[k].first * dof) - H.innerIndexPtr());
+            }
+        }
+
+        // Redo the symbolic analysis only when the block pattern changed, i.e. after new edges.
+        // The numeric factorization is always redone in full.
+        bool analyze = blocks != pattern;
+        if (analyze) pattern = blocks;
+
+        double *values = H.valuePtr();
+        auto addBlock = [&](int slot, const Matrix7d &blk) {
+            for (int c = 0; c < dof; c++) {
+                double *dst = values + offsets[slot * dof + c];
+                for (int r = 0; r < dof; r++) dst[r] += blk(r, c);
+            }
+        };
+
+        Eigen::VectorXd b(n);
+        double lastChi2 = std::numeric_limits<double>::max();
+        int it = 0;
+        for (; it < iterations; it++) {
+            std::fill(values, values + H.nonZeros(), 0.0);
+            b.setZero();
+
+            double chi2 = 0.0;
+            for (auto &l : linked) {
+                const Sim3 E = l.Zinv * l.Si->inverse() * *l.Sj;
+                const Vector7d r = residual(E);
+                const Matrix7d &W = *l.info;
+                Matrix7d Ji, Jj;
+                jacobians(E, r, *l.Si, *l.Sj, Ji, Jj);
+                chi2 += r.dot(W * r);
+
+                if (l.i >= 0) {
+                    const Matrix7d JtW = Ji.transpose() * W;
+                    addBlock(l.ii, JtW * Ji);
+                    b.segment(l.i * dof, dof) -= (JtW * r).head(dof);
+                }
+                if (l.j >= 0) {
+                    const Matrix7d JtW = Jj.transpose() * W;
+                    addBlock(l.jj, JtW * Jj);
+                    b.segment(l.j * dof, dof) -= (JtW * r).head(dof);
+                }
+                if (l.ij >= 0) {
+                    if (l.i > l.j) addBlock(l.ij, Ji.transpose() * W * Jj);
+                    else addBlock(l.ij, Jj.transpose() * W * Ji);
+                }
+            }
+
+            if (it > 0 && lastChi2 - chi2 < 1e-3 * lastChi2) break;
+            lastChi2 = chi2;
+
+            // Keeps the system positive definite for weakly constrained vertices.
+            for (int k = 0; k < int(active.size()); k++)
+                for (int c = 0; c < dof; c++) values[offsets[diagonal[k] * dof + c] + c] += 1e-9;
+
+            if (analyze) {
+                solver.analyzePattern(H);
+                analyze = false;
+            }
+            solver.factorize(H);
+            if (solver.info() != Eigen::Success) break;
+
+            const Eigen::VectorXd dx = solver.solve(b);
+            if (solver.info() != Eigen::Success || !dx.allFinite()) break;
+
+            Vector7d d = Vector7d::Zero();
+            for (size_t v = 0; v < active.size(); v++) {
+                d.head(dof) = dx.segment(v * dof, dof);
+                active[v]->pose = retract(active[v]->pose, d);
+            }
+            if (dx.lpNorm<Eigen::Infinity>() < 1e-6) {
+                it++;
+                break;
+            }
+        }
+        return it;
+    }
+
+    void PoseGraph::publish(const Problem &p) {
+        // Called with mtx held, p is the optimized snapshot.
+        if (p.vertices.empty()) return;
+
+        // Vertices added while solving follow the newest optimized one.
+        const int newest = p.vertices.rbegin()->first;
+        const auto cur = graph.vertices.find(newest);
+        const Sim3 corr = cur == graph.vertices.end() ? Sim3() : p.vertices.rbegin()->second.pose * cur->second.pose.inverse();
+
+        for (auto &[id, v] : graph.vertices) {
+            auto it = p.vertices.find(id);
+            if (it != p.vertices.end()) v.pose = it->second.pose;
+            else if (id > newest) v.pose = corr * v.pose;
+        }
+    }
+
+    int PoseGraph::optimize(int iterations) {
+        Problem p;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            p = graph;
+        }
+
+        const int it = solve(p, iterations);
+
+        std::lock_guard<std::mutex> lock(mtx);
+        publish(p);
+        return it;
+    }
+
+    bool PoseGraph::optimizeAsync(int iterations, std::function<void()> done) {
+        if (running) return false;
+        if (worker.joinable()) worker.join();
+
+        running = true;
+        worker = std::thread([this, iterations, done] {
+            this->optimize(iterations);
+            running = false;
+            if (done) done();
+        });
+        return true;
+    }
+
+    void PoseGraph::wait() {
+        if (worker.joinable()) worker.join();
+    }
+
+    bool PoseGraph::getPose(int id, Sim3 &pose) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = graph.vertices.find(id);
+        if (it == graph.vertices.end()) return false;
+        pose = it->second.pose;
+        return true;
+    }
+
+    void PoseGraph::apply(Map &map) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        const auto &keyframes = map.getKeyframes();
+
+        // Landmarks first, they need the keyframe poses from before the correction.
+        for (auto &[id, lm] : map.getLandmarks()) {
+            if (lm.observations.empty()) continue;
+            auto kf = keyframes.find(lm.observations.front());
+            auto v = graph.vertices.find(lm.observations.front());
+            if (kf == keyframes.end() || v == graph.vertices.end()) continue;
+
+            const Eigen::Vector3d local = kf->second.pose.inverse() * Eigen::Vector3d(lm.pos.x, lm.pos.y, lm.pos.z);
+            const Eigen::Vector3d world = v->second.pose * local;
+            map.setLandmarkPosition(id, cv::Point3f(float(world.x()), float(world.y()), float(world.z())));
+        }
+
+        for (auto &[id, v] : graph.vertices) map.setKeyframePose(id, v.pose.toSE3());
+    }
+
+} // namespace StringSLAM::Estimation
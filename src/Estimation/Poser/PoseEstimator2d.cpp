@@ -3,6 +3,16 @@
 
 namespace StringSLAM::Estimation::Poser
 {
+    namespace
+    {
+        // Prior residual with theta wrapped to [-pi, pi], so a prior near +-pi pulls the short way.
+        Eigen::Vector3d priorResidual(const Pose2D &pose, const Pose2D &prior) {
+            Eigen::Vector3d rp = pose.pos - prior.pos;
+            rp.z() = std::remainder(rp.z(), 2.0 * EIGEN_PI);
+            return rp;
+        }
+    } // namespace
+
     Eigen::Vector2d PoseEstimator2d::transform(const Pose2D &pose, const Eigen::Vector2d &p, double c, double s) {
         return Eigen::Vector2d(c*p.x() - s*p.y() + pose.pos.x(),
                                s*p.x() + c*p.y() + pose.pos.y());
@@ -22,6 +32,22 @@ namespace StringSLAM::Estimation::Poser
     bool PoseEstimator2d::solvePose2D_GN(
         const std::vector<Eigen::Vector2d> &pts_p, const std::vector<Eigen::Vector2d> &pts_q,
         Pose2D &pose, int max_iters, double tol, bool useLM, double init_damping
+    ) {
+        return solve(pts_p, pts_q, nullptr, Eigen::Vector3d::Zero(), pose, max_iters, tol, useLM, init_damping);
+    }
+
+    bool PoseEstimator2d::solvePose2D_GN_Prior(
+        const std::vector<Eigen::Vector2d> &pts_p, const std::vector<Eigen::Vector2d> &pts_q,
+        const Pose2D &prior, const Eigen::Vector3d &priorInfo,
+        Pose2D &pose, int max_iters, double tol, bool useLM, double init_damping
+    ) {
+        return solve(pts_p, pts_q, &prior, priorInfo, pose, max_iters, tol, useLM, init_damping);
+    }
+
+    bool PoseEstimator2d::solve(
+        const std::vector<Eigen::Vector2d> &pts_p, const std::vector<Eigen::Vector2d> &pts_q,
+        const Pose2D *prior, const Eigen::Vector3d &priorInfo,
+        Pose2D &pose, int max_iters, double tol, bool useLM, double init_damping
     ) {
         if (pts_p.size() != pts_q.size() || pts_p.empty()) return false;
         const size_t N = pts_p.size();
@@ -59,6 +85,14 @@ namespace StringSLAM::Estimation::Poser
                 b.noalias() += J.transpose() * r;
             }
 
+            // Prior residual has an identity Jacobian.
+            if (prior) {
+                Eigen::Vector3d rp = priorResidual(pose, *prior);
+                total_error += rp.dot(priorInfo.cwiseProduct(rp));
+                H.diagonal() += priorInfo;
+                b += priorInfo.cwiseProduct(rp);
+            }
+
             if (useLM) H.diagonal().array() += lambda;
 
             Eigen::LLT<Eigen::Matrix3d> llt(H);
@@ -91,6 +125,11 @@ namespace StringSLAM::Estimation::Poser
                     new_error += r.squaredNorm();
                 }
 
+                if (prior) {
+                    Eigen::Vector3d rp = priorResidual(new_pose, *prior);
+                    new_error += rp.dot(priorInfo.cwiseProduct(rp));
+                }
+
                 if (new_error < total_error) {
                     pose = new_pose;
                     lambda = std::max(1e-9, lambda * 0.1);
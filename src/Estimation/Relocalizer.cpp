@@ -0,0 +1,85 @@
+#include <StringSLAM/Estimation/Relocalizer.hpp>
+#include <opencv2/calib3d.hpp>
+
+namespace StringSLAM::Estimation
+{
+    Relocalizer::Relocalizer(std::shared_ptr<Map> map_, const CameraIntrinsic &cI_, std::shared_ptr<Utils::ThreadPool> pool_) :
+        map(map_), cI(cI_), pool(pool_) {
+        // Only a handful of candidates are verified, a small pool is enough.
+        if (!pool) pool = Utils::ThreadPool::create(2);
+    }
+
+    bool Relocalizer::verify(const Frame &f, int kfId, RelocResult &out) const {
+        std::vector<cv::DMatch> matches;
+        map->matchLandmarks(f.desc, map->getKeyframeLandmarks(kfId), matches, maxDistance, ratio);
+        if (int(matches.size()) < minInliers) return false;
+
+        const auto &landmarks = map->getLandmarks();
+        std::vector<cv::Point3f> obj;
+        std::vector<cv::Point2f> img;
+        obj.reserve(matches.size());
+        img.reserve(matches.size());
+        for (auto &m : matches) {
+            obj.push_back(landmarks.at(m.trainIdx).pos);
+            img.push_back(f.undistorted(m.queryIdx));
+        }
+
+        const cv::Mat K = cI.getK();
+        cv::Mat rvec, tvec;
+        std::vector<int> inliers;
+        if (!cv::solvePnPRansac(obj, img, K, cv::noArray(), rvec, tvec, false, ransacIterations, reprojError, 0.99,
+                inliers, cv::SOLVEPNP_EPNP))
+            return false;
+        if (int(inliers.size()) < minInliers) return false;
+
+        // Refine on the inliers only, RANSAC leaves the minimal-set pose.
+        std::vector<cv::Point3f> objIn;
+        std::vector<cv::Point2f> imgIn;
+        objIn.reserve(inliers.size());
+        imgIn.reserve(inliers.size());
+        for (int i : inliers) {
+            objIn.push_back(obj[i]);
+            imgIn.push_back(img[i]);
+        }
+        cv::solvePnPRefineLM(objIn, imgIn, K, cv::noArray(), rvec, tvec);
+
+        // PnP gives world -> camera.
+        cv::Mat R;
+        cv::Rodrigues(rvec, R);
+        out.keyframeId = kfId;
+        out.pose = SE3::fromCv(R, tvec).inverse();
+        out.inliers = int(inliers.size());
+        return true;
+    }
+
+    bool Relocalizer::relocalize(Frame &f, RelocResult &result) const {
+        result = RelocResult();
+        if (!map || f.desc.empty() || f.kp.empty()) return false;
+
+        // The word index finds the keyframes, only their landmarks are matched in full.
+        std::vector<int> candidates;
+        map->getKeyframeCandidates(f.desc, maxCandidates, candidates, maxDistance);
+        if (candidates.empty()) return false;
+
+        std::atomic<bool> found{false};
+        std::mutex mtx;
+        pool->parallelFor(0, candidates.size(), [&](size_t i) {
+            // Candidates are ranked, skip the rest once one has been accepted.
+            if (found) return;
+
+            RelocResult r;
+            if (!verify(f, candidates[i], r)) return;
+
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!found) {
+                result = r;
+                found = true;
+            }
+        });
+
+        if (!found) return false;
+        f.pose = result.pose;
+        return true;
+    }
+
+} // namespace StringSLAM::Estimation
@@ -1,39 +1,65 @@
 #include "opencv2/core/mat.hpp"
 #include "opencv2/core/types.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <opencv2/video.hpp>
 #include <StringSLAM/Feature/FeatureFinder.hpp>
 
 namespace StringSLAM::Feature
 {
-    FeatureFinder::FeatureFinder(std::shared_ptr<OrbWrapper> &orb_) : orb(orb_) {
-        matcher = cv::BFMatcher::create(cv::NORM_HAMMING, false);
-    }
+    FeatureFinder::FeatureFinder(std::shared_ptr<OrbWrapper> &orb_) : core(Policy::OrbRuntime(orb_)) {}
 
     void FeatureFinder::getKeypoints(Frame &f) {
-        // Clear and reserve descriptors and keypoints
-        f.kp.clear();
-        f.desc.release();
-
-        if (f.frame.empty())
-            return;
+        core.extract(f);
+    }
 
-        // Detect and compute the frame and grab the kp and desc.
-        orb->detectAndCompute(f.frame, f.kp, f.desc);
+    // Wrapped YUV frames only hold luminance in f.frame, convert chroma just for drawing.
+    static const cv::Mat &visualFrame(const Frame &f, cv::Mat &tmp) {
+        if (!f.raw.valid() || f.raw.format == PixelFormat::GRAY8) return f.frame;
+        f.toBGR(tmp);
+        return tmp;
     }
 
     void FeatureFinder::drawKeypoint(Frame &f, cv::Mat &out, cv::Scalar &color) {
+        cv::Mat tmp;
         cv::drawKeypoints(
-            f.frame,
+            visualFrame(f, tmp),
             f.kp,
             out,
             color
         );
     }
 
+    const std::vector<cv::DMatch> FeatureFinder::matchFrames(Frame &f1, Frame &f2) {
+        core.match(f1, f2, matches);
+        return matches;
+    }
+
+    const std::vector<cv::DMatch> FeatureFinder::matchFramesLK(
+        Frame &f1,
+        Frame &f2,
+        cv::Size winSize,
+        int maxLevel
+    ) {
+        return matchLK(f1, f2, nullptr, winSize, maxLevel);
+    }
+
     const std::vector<cv::DMatch> FeatureFinder::matchFramesLK(
         Frame &f1,
         Frame &f2,
+        const std::vector<cv::Point2f> &predicted,
+        cv::Size winSize,
+        int maxLevel
+    ) {
+        return matchLK(f1, f2, &predicted, winSize, maxLevel);
+    }
+
+    const std::vector<cv::DMatch> FeatureFinder::matchLK(
+        Frame &f1,
+        Frame &f2,
+        const std::vector<cv::Point2f> *predicted,
         cv::Size winSize,
         int maxLevel
     ) {
@@ -52,7 +78,19 @@ namespace StringSLAM::Feature
         std::vector<uchar> status;
         std::vector<float> err;
 
+        // A prediction for every point seeds the flow instead of starting at zero motion.
+        int flags = 0;
+        if (predicted && predicted->size() == pointsPrev.size()) {
+            pointsNext = *predicted;
+            flags = cv::OPTFLOW_USE_INITIAL_FLOW;
+        }
+
         cv::TermCriteria criteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 30, 0.01);
+        if (verify) {
+            verifiedLK(f1, f2, pointsPrev, pointsNext, flags, winSize, maxLevel, criteria);
+            return matches;
+        }
+
         cv::calcOpticalFlowPyrLK(
             f1.frame,
             f2.frame,
@@ -62,7 +100,8 @@ namespace StringSLAM::Feature
             err,
             winSize,
             maxLevel,
-            criteria
+            criteria,
+            flags
         );
 
         // Build matches for successfully tracked points
@@ -97,6 +136,127 @@ namespace StringSLAM::Feature
         return matches;
     }
 
+    void FeatureFinder::verifiedLK(
+        Frame &f1,
+        Frame &f2,
+        const std::vector<cv::Point2f> &pointsPrev,
+        std::vector<cv::Point2f> &pointsNext,
+        int flags,
+        cv::Size winSize,
+        int maxLevel,
+        const cv::TermCriteria &criteria
+    ) {
+        // Both directions read the same two pyramids, built once with their derivatives.
+        int levels = std::min(
+            cv::buildOpticalFlowPyramid(f1.frame, pyrPrev, winSize, maxLevel, true),
+            cv::buildOpticalFlowPyramid(f2.frame, pyrNext, winSize, maxLevel, true)
+        );
+
+        std::vector<uchar> status;
+        std::vector<float> err;
+        cv::calcOpticalFlowPyrLK(pyrPrev, pyrNext, pointsPrev, pointsNext, status, err, winSize, levels, criteria, flags);
+
+        // Backward flow only for the forward survivors, seeded where the forward flow landed
+        // so it has to find its own way back (seeding at the origin would converge in place).
+        std::vector<int> idx;
+        std::vector<cv::Point2f> fwd, back, origin;
+        std::vector<float> fwdErr;
+        idx.reserve(pointsPrev.size());
+        for (size_t i = 0; i < pointsPrev.size(); i++) {
+            if (!status[i]) continue;
+            idx.push_back(static_cast<int>(i));
+            fwd.push_back(pointsNext[i]);
+            origin.push_back(pointsPrev[i]);
+            fwdErr.push_back(err[i]);
+        }
+        if (idx.empty()) return;
+        back = fwd;
+
+        std::vector<uchar> backStatus;
+        std::vector<float> backErr;
+        cv::calcOpticalFlowPyrLK(pyrNext, pyrPrev, fwd, back, backStatus, backErr, winSize, levels, criteria,
+            cv::OPTFLOW_USE_INITIAL_FLOW);
+
+        // Round trip and residual tests, branchless over contiguous arrays (origin is a packed
+        // copy of the survivors' starting points) so the loop vectorizes.
+        const size_t n = idx.size();
+        const float maxRoundTrip2 = maxRoundTrip * maxRoundTrip;
+        std::vector<uchar> keep(n);
+        for (size_t k = 0; k < n; k++) {
+            const float dx = back[k].x - origin[k].x;
+            const float dy = back[k].y - origin[k].y;
+            keep[k] = uchar((dx * dx + dy * dy <= maxRoundTrip2) & (fwdErr[k] <= maxResidual) & (backErr[k] <= maxResidual) &
+                (backStatus[k] != 0));
+        }
+
+        // Snap to the nearest f2 keypoint within snapRadius, bucketed in snapRadius cells.
+        const float cell = std::max(snapRadius, 1.0f);
+        const int gridCols = std::max(1, static_cast<int>(std::ceil(f2.frame.cols / cell)));
+        const int gridRows = std::max(1, static_cast<int>(std::ceil(f2.frame.rows / cell)));
+        auto cellOf = [&](const cv::Point2f &p, int &cx, int &cy) {
+            cx = std::min(std::max(static_cast<int>(p.x / cell), 0), gridCols - 1);
+            cy = std::min(std::max(static_cast<int>(p.y / cell), 0), gridRows - 1);
+        };
+
+        gridStart.assign(size_t(gridCols) * gridRows + 1, 0);
+        gridItems.resize(f2.kp.size());
+        int cx, cy;
+        for (auto &kp : f2.kp) {
+            cellOf(kp.pt, cx, cy);
+            gridStart[size_t(cy) * gridCols + cx + 1]++;
+        }
+        for (size_t c = 1; c < gridStart.size(); c++) gridStart[c] += gridStart[c - 1];
+        std::vector<int> fill(gridStart.begin(), gridStart.end() - 1);
+        for (size_t j = 0; j < f2.kp.size(); j++) {
+            cellOf(f2.kp[j].pt, cx, cy);
+            gridItems[fill[size_t(cy) * gridCols + cx]++] = static_cast<int>(j);
+        }
+
+        // One track per keypoint, the closest one wins.
+        const float snapRadius2 = snapRadius * snapRadius;
+        std::vector<int> owner(f2.kp.size(), -1);
+        std::vector<float> ownerDist(f2.kp.size(), std::numeric_limits<float>::max());
+        for (size_t k = 0; k < n; k++) {
+            if (!keep[k]) continue;
+            const cv::Point2f &p = fwd[k];
+            cellOf(p, cx, cy);
+
+            int bestIdx = -1;
+            float bestDist = snapRadius2;
+            for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, gridRows - 1); y++) {
+                for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, gridCols - 1); x++) {
+                    const size_t c = size_t(y) * gridCols + x;
+                    for (int e = gridStart[c]; e < gridStart[c + 1]; e++) {
+                        const int j = gridItems[e];
+                        const float dx = f2.kp[j].pt.x - p.x;
+                        const float dy = f2.kp[j].pt.y - p.y;
+                        const float dist = dx * dx + dy * dy;
+                        if (dist <= bestDist) {
+                            bestDist = dist;
+                            bestIdx = j;
+                        }
+                    }
+                }
+            }
+
+            if (bestIdx >= 0 && bestDist < ownerDist[bestIdx]) {
+                owner[bestIdx] = idx[k];
+                ownerDist[bestIdx] = bestDist;
+            }
+        }
+
+        for (size_t j = 0; j < owner.size(); j++) {
+            if (owner[j] < 0) continue;
+            cv::DMatch m;
+            m.queryIdx = owner[j];
+            m.trainIdx = static_cast<int>(j);
+            m.imgIdx   = 0;
+            m.distance = std::sqrt(ownerDist[j]);
+            matches.push_back(m);
+        }
+        std::sort(matches.begin(), matches.end(), [](const cv::DMatch &a, const cv::DMatch &b) { return a.queryIdx < b.queryIdx; });
+    }
+
 
     void FeatureFinder::drawMatches(Frame &frame1, Frame &frame2, std::vector<cv::DMatch> &matches, cv::Mat &out) {
         matches.erase(
@@ -107,7 +267,8 @@ namespace StringSLAM::Feature
         }),
     matches.end()
     );
-        cv::drawMatches(frame1.frame, frame1.kp, frame2.frame, frame2.kp, matches, out);
+        cv::Mat tmp1, tmp2;
+        cv::drawMatches(visualFrame(frame1, tmp1), frame1.kp, visualFrame(frame2, tmp2), frame2.kp, matches, out);
     }
 
 } // namespace StringSLAM::Feature
@@ -0,0 +1,169 @@
+#include <StringSLAM/SessionHost.hpp>
+
+namespace StringSLAM
+{
+    namespace
+    {
+        bool sameModel(const CameraModel &a, const CameraModel &b) {
+            const CameraIntrinsic &i = a.cI, &j = b.cI;
+            const CameraDistortion &d = a.cD, &e = b.cD;
+            if (a.capSize != b.capSize || i.fx != j.fx || i.fy != j.fy || i.cx != j.cx || i.cy != j.cy) return false;
+            if (d.k1 != e.k1 || d.k2 != e.k2 || d.k3 != e.k3 || d.k4 != e.k4 || d.k5 != e.k5 || d.k6 != e.k6 || d.p1 != e.p1 || d.p2 != e.p2)
+                return false;
+
+            if (d.R.empty() || e.R.empty()) return d.R.empty() == e.R.empty();
+            for (int r = 0; r < 3; r++)
+                for (int c = 0; c < 3; c++)
+                    if (d.R.at<double>(r, c) != e.R.at<double>(r, c)) return false;
+            return true;
+        }
+    } // namespace
+
+    std::shared_ptr<const UndistortLUT> SharedAssets::getUndistortLUT(const CameraModel &cm, int step) {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (auto &e : luts)
+            if (e.step == step && sameModel(e.cm, cm)) return e.lut;
+
+        luts.push_back({cm, step, UndistortLUT::create(cm, step)});
+        return luts.back().lut;
+    }
+
+    size_t SharedAssets::size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return luts.size() + assets.size();
+    }
+
+    SessionHost::SessionHost(std::shared_ptr<Utils::ThreadPool> pool_, std::shared_ptr<SharedAssets> assets_, bool serialOpenCV)
+        : pool(pool_ ? std::move(pool_) : Utils::ThreadPool::create()), assets(assets_ ? std::move(assets_) : SharedAssets::create()) {
+        // OpenCV's own thread pool would compete with ours for the same cores.
+        if (serialOpenCV) cv::setNumThreads(1);
+    }
+
+    SessionHost::~SessionHost() { wait(); }
+
+    int SessionHost::addSession(const CameraModel &cm, FrameSource source, int features) {
+        auto s = std::make_unique<Session>();
+        s->system = System::create(cm, pool, features);
+        s->source = std::move(source);
+
+        const CameraDistortion &d = cm.cD;
+        const bool distorted = d.k1 != 0.0 || d.k2 != 0.0 || d.k3 != 0.0 || d.k4 != 0.0 || d.k5 != 0.0 || d.k6 != 0.0 || d.p1 != 0.0 || d.p2 != 0.0;
+        if (distorted && cm.capSize.area() > 0) s->system->setUndistortLUT(assets->getUndistortLUT(cm));
+
+        std::lock_guard<std::mutex> lock(mtx);
+        s->id = int(sessions.size());
+        sessions.push_back(std::move(s));
+        return sessions.back()->id;
+    }
+
+    void SessionHost::setResultSink(ResultSink sink_) {
+        std::lock_guard<std::mutex> lock(mtx);
+        sink = std::move(sink_);
+    }
+
+    void SessionHost::setQuantum(int frames) {
+        std::lock_guard<std::mutex> lock(mtx);
+        quantum = std::max(1, frames);
+    }
+
+    void SessionHost::start() {
+        std::vector<Session *> added;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (auto &s : sessions) {
+                if (s->scheduled) continue;
+                s->scheduled = true;
+                running++;
+                added.push_back(s.get());
+            }
+        }
+        for (Session *s : added) schedule(*s);
+    }
+
+    void SessionHost::schedule(Session &s) {
+        // The future is not needed, step() reports through the stats.
+        pool->submit([this, &s] { step(s); });
+    }
+
+    void SessionHost::step(Session &s) {
+        int frames;
+        ResultSink out;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            frames = quantum;
+            out = sink;
+        }
+
+        bool more = true, failed = false;
+        try {
+            for (int i = 0; i < frames && more; i++) {
+                more = s.source(s.frame);
+                if (!more) break;
+
+                const auto t = std::chrono::steady_clock::now();
+                const TrackResult res = s.system->track(s.frame);
+                const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
+                if (out) out(s.id, res);
+
+                std::lock_guard<std::mutex> lock(mtx);
+                s.stats.frames++;
+                s.stats.tracked += res.ok();
+                s.stats.busyMs += ms;
+            }
+        } catch (...) {
+            more = false;
+            failed = true;
+        }
+
+        // Yield: the next quantum queues up behind the other sessions.
+        if (more) {
+            schedule(s);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            s.stats.finished = true;
+            s.stats.failed = failed;
+            running--;
+        }
+        doneCv.notify_all();
+    }
+
+    void SessionHost::wait() {
+        std::unique_lock<std::mutex> lock(mtx);
+        doneCv.wait(lock, [this] { return running == 0; });
+    }
+
+    SessionStats SessionHost::getSessionStats(int id) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (id < 0 || size_t(id) >= sessions.size()) return SessionStats();
+        return sessions[id]->stats;
+    }
+
+    SessionStats SessionHost::getTotalStats() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        SessionStats total;
+        total.finished = true;
+        for (auto &s : sessions) {
+            total.frames += s->stats.frames;
+            total.tracked += s->stats.tracked;
+            total.busyMs += s->stats.busyMs;
+            total.finished = total.finished && s->stats.finished;
+            total.failed = total.failed || s->stats.failed;
+        }
+        return total;
+    }
+
+    std::shared_ptr<System> SessionHost::getSystem(int id) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (id < 0 || size_t(id) >= sessions.size()) return nullptr;
+        return sessions[id]->system;
+    }
+
+    size_t SessionHost::getSessionCount() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return sessions.size();
+    }
+
+} // namespace StringSLAM
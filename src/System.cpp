@@ -0,0 +1,566 @@
+#include <StringSLAM/System.hpp>
+#include <opencv2/calib3d.hpp>
+
+namespace StringSLAM
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        constexpr int MIN_FEATURES = 100;
+        constexpr int MIN_INLIERS = 20;
+
+        double elapsedMs(Clock::time_point since) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+        }
+    } // namespace
+
+    System::System(const CameraModel &cm_, std::shared_ptr<Utils::ThreadPool> pool_, int features)
+        : cm(cm_), pool(pool_ ? std::move(pool_) : Utils::ThreadPool::create()) {
+        K = cm.cI.getK();
+        const CameraDistortion &d = cm.cD;
+        distorted = d.k1 != 0.0 || d.k2 != 0.0 || d.k3 != 0.0 || d.k4 != 0.0 || d.k5 != 0.0 || d.k6 != 0.0 || d.p1 != 0.0 || d.p2 != 0.0;
+
+        orb = OrbWrapper::create(features, 1.2f, 8, 31, 0, 2, cv::ORB::HARRIS_SCORE, 31, 20);
+        finder = Feature::FeatureFinder::create(orb);
+        initializer = Estimation::Initializer::create(cm.cI, pool);
+        relocalizer = Estimation::Relocalizer::create(map, cm.cI, pool);
+        stats.queueCapacity = capacity;
+        lastResult.state = TrackingState::INITIALIZING;
+    }
+
+    System::~System() { stop(); }
+
+    void System::extract(Frame &f) {
+        finder->getKeypoints(f);
+        if (!distorted || f.kp.empty()) return;
+
+        if (!lut) {
+            cm.capSize = f.frame.size();
+            lut = UndistortLUT::create(cm);
+        }
+        lut->undistort(f);
+    }
+
+    void System::setKeyframe(const Frame &f, const std::vector<int> &kpLandmark, bool inMap) {
+        keyframe = f;
+        keyframeLandmarks = kpLandmark;
+        keyframeInMap = inMap;
+        keyframeTracked = std::count_if(kpLandmark.begin(), kpLandmark.end(), [](int id) { return id >= 0; });
+        sinceKeyframe = 0;
+        if (mode == TrackingMode::SEMI_DIRECT) direct->setReference(keyframe, keyframeLandmarks, *map);
+    }
+
+    bool System::initialize(Frame &f) {
+        if (int(f.kp.size()) < MIN_FEATURES) return false;
+        if (referenceAge < 0) {
+            reference = f;
+            referenceAge = 0;
+            return false;
+        }
+
+        const std::vector<cv::DMatch> matches = finder->matchFrames(reference, f);
+        Estimation::InitResult res;
+        if (!initializer->initialize(reference, f, matches, *map, res)) {
+            // Restart from a fresh reference when this one no longer overlaps.
+            if (++referenceAge > 30 || int(matches.size()) < MIN_FEATURES) {
+                reference = f;
+                referenceAge = 0;
+            }
+            return false;
+        }
+
+        std::vector<int> kpLandmark(f.kp.size(), -1);
+        tracked.clear();
+        for (size_t i = 0; i < res.matchIdx.size(); i++) {
+            kpLandmark[matches[res.matchIdx[i]].trainIdx] = res.landmarkIds[i];
+            tracked.push_back(res.landmarkIds[i]);
+        }
+        setKeyframe(f, kpLandmark);
+        initialized = true;
+        return true;
+    }
+
+    bool System::trackLocalMap(Frame &f, std::vector<int> &kpLandmark, int &inliers) {
+        std::vector<int> kfIds, local;
+        map->getLocalMap(tracked, 20, kfIds, local);
+        if (local.empty()) local = map->getKeyframeLandmarks(keyframe.id);
+
+        std::vector<cv::DMatch> matches;
+        map->matchLandmarks(f.desc, local, matches);
+        if (int(matches.size()) < MIN_INLIERS) return false;
+
+        const auto &landmarks = map->getLandmarks();
+        std::vector<cv::Point3f> obj;
+        std::vector<cv::Point2f> img;
+        for (auto &m : matches) {
+            obj.push_back(landmarks.at(m.trainIdx).pos);
+            img.push_back(f.undistorted(m.queryIdx));
+        }
+
+        // Seed with the previous pose, PnP works in T_camera_world.
+        cv::Mat R, tvec, rvec;
+        lastPose.inverse().toCv(R, tvec);
+        cv::Rodrigues(R, rvec);
+        std::vector<int> inlierIdx;
+        if (!cv::solvePnPRansac(obj, img, K, cv::noArray(), rvec, tvec, true, 100, 4.0f, 0.99, inlierIdx, cv::SOLVEPNP_ITERATIVE))
+            return false;
+        if (int(inlierIdx.size()) < MIN_INLIERS) return false;
+
+        cv::Rodrigues(rvec, R);
+        f.pose = SE3::fromCv(R, tvec).inverse();
+
+        kpLandmark.assign(f.kp.size(), -1);
+        tracked.clear();
+        for (int i : inlierIdx) {
+            kpLandmark[matches[i].queryIdx] = matches[i].trainIdx;
+            tracked.push_back(matches[i].trainIdx);
+        }
+        inliers = int(inlierIdx.size());
+        return true;
+    }
+
+    bool System::insertKeyframe(Frame &f, std::vector<int> &kpLandmark) {
+        // The frame only becomes the tracking reference when inserting it could exceed the
+        // map budget. Every keypoint without a landmark may get one by triangulation.
+        const int partner = keyframeInMap ? keyframe.id : -1;
+        if (mapAccount.valid() && !mapAccount.fits(mapAccount.getBytes() + map->estimateInsertion(f, kpLandmark, partner)) &&
+            map->getStorage() == MapStorage::FULL) {
+            map->setStorage(MapStorage::COMPACT);
+            mapAccount.set(map->getMemoryUsage().totalBytes());
+        }
+        if (mapAccount.valid() && !mapAccount.fits(mapAccount.getBytes() + map->estimateInsertion(f, kpLandmark, partner))) {
+            setKeyframe(f, kpLandmark, false);
+            return false;
+        }
+
+        map->addKeyframe(f);
+        for (int lm : kpLandmark)
+            if (lm >= 0) map->addObservation(lm, f.id);
+
+        // A reference that never made it into the map cannot observe new landmarks,
+        // this keyframe only re-anchors the map and triangulation resumes from it.
+        if (!keyframeInMap) {
+            setKeyframe(f, kpLandmark);
+            return true;
+        }
+
+        // Triangulate keyframe-to-keyframe matches that have no landmark yet.
+        const std::vector<cv::DMatch> matches = finder->matchFrames(keyframe, f);
+        const SE3 T1 = keyframe.pose.inverse(), T2 = f.pose.inverse();
+        const Eigen::Matrix3d R1 = T1.rotation(), R2 = T2.rotation();
+        const Eigen::Vector3d t1 = T1.translation(), t2 = T2.translation();
+        const Eigen::Vector3d O1 = keyframe.pose.translation(), O2 = f.pose.translation();
+        const CameraIntrinsic &cI = cm.cI;
+
+        for (auto &m : matches) {
+            if (keyframeLandmarks[m.queryIdx] >= 0 || kpLandmark[m.trainIdx] >= 0) continue;
+            const cv::Point2f &p1 = keyframe.undistorted(m.queryIdx), &p2 = f.undistorted(m.trainIdx);
+            const double x1 = (p1.x - cI.cx) / cI.fx, y1 = (p1.y - cI.cy) / cI.fy;
+            const double x2 = (p2.x - cI.cx) / cI.fx, y2 = (p2.y - cI.cy) / cI.fy;
+
+            Eigen::Matrix<double, 4, 3> A;
+            Eigen::Vector4d b;
+            A << x1 * R1.row(2) - R1.row(0), y1 * R1.row(2) - R1.row(1), x2 * R2.row(2) - R2.row(0), y2 * R2.row(2) - R2.row(1);
+            b << t1(0) - x1 * t1(2), t1(1) - y1 * t1(2), t2(0) - x2 * t2(2), t2(1) - y2 * t2(2);
+            const Eigen::Vector3d X = (A.transpose() * A).ldlt().solve(A.transpose() * b);
+            if (!X.allFinite()) continue;
+
+            const Eigen::Vector3d c1 = T1 * X, c2 = T2 * X;
+            if (c1.z() <= 0.0 || c2.z() <= 0.0) continue;
+            if ((X - O1).normalized().dot((X - O2).normalized()) > 0.9998) continue;
+
+            const double e1 = std::hypot(cI.fx * c1.x() / c1.z() + cI.cx - p1.x, cI.fy * c1.y() / c1.z() + cI.cy - p1.y);
+            const double e2 = std::hypot(cI.fx * c2.x() / c2.z() + cI.cx - p2.x, cI.fy * c2.y() / c2.z() + cI.cy - p2.y);
+            if (e1 > 2.0 || e2 > 2.0) continue;
+
+            MapPoint mp;
+            mp.pos = cv::Point3f(float(X.x()), float(X.y()), float(X.z()));
+            mp.observations = {keyframe.id, f.id};
+            kpLandmark[m.trainIdx] = map->addLandmark(mp, f.id, m.trainIdx);
+        }
+        setKeyframe(f, kpLandmark);
+        return true;
+    }
+
+    void System::accountMap() {
+        if (!mapAccount.valid() || mapAccount.set(map->getMemoryUsage().totalBytes())) return;
+        if (map->getStorage() == MapStorage::FULL) {
+            map->setStorage(MapStorage::COMPACT);
+            mapAccount.set(map->getMemoryUsage().totalBytes());
+        }
+    }
+
+    bool System::trackDirect(Frame &f, TrackResult &res) {
+        auto t = Clock::now();
+        Estimation::DirectResult d;
+        const bool ok = direct->track(f.frame, lastPose, d);
+        if (latency) latency->add("direct", elapsedMs(t));
+        if (!ok) return false;
+
+        f.pose = d.pose;
+        lastPose = f.pose;
+        tracked = d.landmarks;
+        res.state = TrackingState::TRACKING;
+        res.pose = f.pose;
+        res.inliers = d.inliers;
+
+        sinceKeyframe++;
+        if (size_t(d.inliers) >= direct->getPointCount() * 7 / 10 && sinceKeyframe < 20) return true;
+
+        // Keyframes need descriptors: extract and match them seeded with the direct pose.
+        t = Clock::now();
+        extract(f);
+        if (latency) latency->add("features", elapsedMs(t));
+
+        t = Clock::now();
+        std::vector<int> kpLandmark;
+        int inliers = 0;
+        const bool matched = trackLocalMap(f, kpLandmark, inliers);
+        if (latency) latency->add("tracking", elapsedMs(t));
+        // Without a match the direct pose stands and the next frame tries again.
+        if (!matched) return true;
+
+        lastPose = f.pose;
+        res.pose = f.pose;
+        res.inliers = inliers;
+        t = Clock::now();
+        res.keyframe = insertKeyframe(f, kpLandmark);
+        if (latency) latency->add("mapping", elapsedMs(t));
+        return true;
+    }
+
+    TrackResult System::process(Frame &f) {
+        TrackResult res;
+        res.frameId = f.id;
+        res.timestamp = f.timestamp;
+        if (initialized && mode == TrackingMode::SEMI_DIRECT && direct->hasReference() && trackDirect(f, res)) return res;
+
+        auto t = Clock::now();
+        extract(f);
+        if (latency) latency->add("features", elapsedMs(t));
+
+        if (!initialized) {
+            t = Clock::now();
+            const bool ok = initialize(f);
+            if (latency) latency->add("initialization", elapsedMs(t));
+            if (!ok) {
+                res.state = TrackingState::INITIALIZING;
+                return res;
+            }
+
+            lastPose = f.pose;
+            res.state = TrackingState::TRACKING;
+            res.pose = f.pose;
+            res.inliers = int(tracked.size());
+            res.keyframe = true;
+            return res;
+        }
+
+        t = Clock::now();
+        std::vector<int> kpLandmark;
+        res.state = TrackingState::TRACKING;
+        bool ok = trackLocalMap(f, kpLandmark, res.inliers);
+        if (latency) latency->add("tracking", elapsedMs(t));
+
+        if (!ok) {
+            t = Clock::now();
+            Estimation::RelocResult r;
+            if (relocalizer->relocalize(f, r)) {
+                lastPose = f.pose;
+                tracked = map->getKeyframeLandmarks(r.keyframeId);
+                ok = trackLocalMap(f, kpLandmark, res.inliers);
+            }
+            if (latency) latency->add("relocalization", elapsedMs(t));
+            if (!ok) {
+                res.state = TrackingState::LOST;
+                return res;
+            }
+            res.state = TrackingState::RELOCALIZED;
+        }
+        lastPose = f.pose;
+        res.pose = f.pose;
+
+        // A frame the direct tracker lost also becomes its new reference.
+        const bool directLost = mode == TrackingMode::SEMI_DIRECT && direct->hasReference();
+        sinceKeyframe++;
+        if (size_t(res.inliers) < keyframeTracked * 7 / 10 || sinceKeyframe >= 20 || directLost) {
+            t = Clock::now();
+            res.keyframe = insertKeyframe(f, kpLandmark);
+            if (latency) latency->add("mapping", elapsedMs(t));
+        }
+        return res;
+    }
+
+    bool System::skip(const Frame &f) {
+        std::lock_guard<std::mutex> lock(gateMtx);
+        return gate && !gate->accept(f);
+    }
+
+    TrackResult System::repeatLast(const Frame &f) const {
+        std::lock_guard<std::mutex> lock(gateMtx);
+        TrackResult res = lastResult;
+        res.frameId = f.id;
+        res.timestamp = f.timestamp;
+        res.inliers = 0;
+        res.keyframe = false;
+        res.skipped = true;
+        return res;
+    }
+
+    TrackResult System::run(Frame &f, bool gated, bool skipped) {
+        std::lock_guard<std::mutex> lock(trackMtx);
+        f.id = nextId++;
+        if (skipped || (gated && skip(f))) return repeatLast(f);
+
+        TrackResult res = process(f);
+        if (res.keyframe) accountMap();
+        if (exporter) exporter->update(*map);
+        std::lock_guard<std::mutex> gateLock(gateMtx);
+        lastResult = res;
+        return res;
+    }
+
+    TrackResult System::track(Frame &f) {
+        return run(f, true);
+    }
+
+    std::future<TrackResult> System::submit(const Frame &f) {
+        Pending p;
+        p.frame.timestamp = f.timestamp;
+        p.frame.pose = f.pose;
+
+        // Static frames are gated here, while the pixels are still valid, and queued without
+        // them: the worker answers them in order with the result of the frame before.
+        p.skipped = skip(f);
+
+        // The capture buffer is reused by the next read (or owned by the caller when
+        // wrapped), so the pixels are copied.
+        if (!p.skipped) p.frame.frame = f.frame.clone();
+        p.bytes = p.frame.memoryBytes();
+        std::future<TrackResult> result = p.result.get_future();
+
+        std::unique_lock<std::mutex> lock(queueMtx);
+        stats.submitted++;
+        if (p.skipped) stats.skipped++;
+        if (!running) {
+            running = true;
+            worker = std::thread(&System::workerLoop, this);
+        }
+
+        if (queueFull(p.bytes)) {
+            switch (backpressure) {
+            case Backpressure::BLOCK:
+                spaceCv.wait(lock, [this, &p] { return !queueFull(p.bytes) || !running; });
+                break;
+            case Backpressure::DROP_OLDEST:
+                while (queueFull(p.bytes)) {
+                    queuedBytes -= queue.front().bytes;
+                    discard(queue.front());
+                    queue.pop_front();
+                    stats.droppedOldest++;
+                }
+                break;
+            case Backpressure::DROP_NEWEST:
+                stats.droppedNewest++;
+                lock.unlock();
+                discard(p);
+                return result;
+            }
+        }
+
+        // stop() was called while waiting for space.
+        if (!running) {
+            lock.unlock();
+            discard(p);
+            return result;
+        }
+
+        queuedBytes += p.bytes;
+        queueAccount.set(queuedBytes);
+        queue.push_back(std::move(p));
+        stats.peakQueueDepth = std::max(stats.peakQueueDepth, queue.size());
+        lock.unlock();
+        queueCv.notify_one();
+        return result;
+    }
+
+    bool System::queueFull(size_t bytes) const {
+        return !queue.empty() && (queue.size() >= capacity || !queueAccount.fits(queuedBytes + bytes));
+    }
+
+    void System::discard(Pending &p) {
+        TrackResult res;
+        res.timestamp = p.frame.timestamp;
+        res.state = TrackingState::DROPPED;
+        p.result.set_value(res);
+    }
+
+    void System::workerLoop() {
+        std::function<void()> init;
+        {
+            std::lock_guard<std::mutex> lock(queueMtx);
+            init = threadInit;
+        }
+        if (init) init();
+
+        for (;;) {
+            Pending p;
+            std::function<void(const TrackResult &)> cb;
+            {
+                std::unique_lock<std::mutex> lock(queueMtx);
+                queueCv.wait(lock, [this] { return !queue.empty() || !running; });
+                if (queue.empty()) break;
+
+                p = std::move(queue.front());
+                queue.pop_front();
+                queuedBytes -= p.bytes;
+                queueAccount.set(queuedBytes);
+                busy = true;
+                cb = callback;
+            }
+            spaceCv.notify_one();
+
+            // Already gated by submit().
+            const TrackResult res = run(p.frame, false, p.skipped);
+            if (cb && !p.skipped) cb(res);
+            p.result.set_value(res);
+
+            {
+                std::lock_guard<std::mutex> lock(queueMtx);
+                busy = false;
+                if (!p.skipped) stats.processed++;
+            }
+            idleCv.notify_all();
+        }
+    }
+
+    void System::setCallback(std::function<void(const TrackResult &)> callback_) {
+        std::lock_guard<std::mutex> lock(queueMtx);
+        callback = std::move(callback_);
+    }
+
+    void System::setMotionGate(std::shared_ptr<Tracker::MotionGate> gate_) {
+        std::lock_guard<std::mutex> lock(gateMtx);
+        gate = std::move(gate_);
+    }
+
+    std::shared_ptr<Tracker::MotionGate> System::getMotionGate() const {
+        std::lock_guard<std::mutex> lock(gateMtx);
+        return gate;
+    }
+
+    Tracker::MotionGateStats System::getMotionGateStats() const {
+        std::lock_guard<std::mutex> lock(gateMtx);
+        return gate ? gate->getStats() : Tracker::MotionGateStats();
+    }
+
+    void System::setThreadInit(std::function<void()> init) {
+        std::lock_guard<std::mutex> lock(queueMtx);
+        threadInit = std::move(init);
+    }
+
+    void System::setBackpressure(Backpressure mode, size_t capacity_) {
+        {
+            std::lock_guard<std::mutex> lock(queueMtx);
+            backpressure = mode;
+            capacity = std::max<size_t>(1, capacity_);
+            stats.queueCapacity = capacity;
+        }
+        spaceCv.notify_all();
+    }
+
+    void System::drain() {
+        std::unique_lock<std::mutex> lock(queueMtx);
+        idleCv.wait(lock, [this] { return queue.empty() && !busy; });
+    }
+
+    void System::stop() {
+        std::deque<Pending> pending;
+        {
+            std::lock_guard<std::mutex> lock(queueMtx);
+            if (!running) return;
+            running = false;
+            pending.swap(queue);
+            queuedBytes = 0;
+            queueAccount.set(0);
+        }
+        queueCv.notify_all();
+        spaceCv.notify_all();
+        if (worker.joinable()) worker.join();
+        idleCv.notify_all();
+
+        for (auto &p : pending) discard(p);
+    }
+
+    SystemStats System::getStats() const {
+        std::lock_guard<std::mutex> lock(queueMtx);
+        SystemStats s = stats;
+        s.queueDepth = queue.size();
+        return s;
+    }
+
+    size_t System::getQueueDepth() const {
+        std::lock_guard<std::mutex> lock(queueMtx);
+        return queue.size();
+    }
+
+    void System::setTrackingMode(TrackingMode mode_) {
+        std::lock_guard<std::mutex> lock(trackMtx);
+        if (mode_ == mode) return;
+        mode = mode_;
+        if (mode == TrackingMode::FEATURES) {
+            direct.reset();
+            return;
+        }
+        direct = Estimation::DirectTracker::create(cm);
+        if (initialized) direct->setReference(keyframe, keyframeLandmarks, *map);
+    }
+
+    TrackingMode System::getTrackingMode() const {
+        std::lock_guard<std::mutex> lock(trackMtx);
+        return mode;
+    }
+
+    void System::setLatencyRecorder(std::shared_ptr<Utils::LatencyRecorder> latency_) {
+        std::lock_guard<std::mutex> lock(trackMtx);
+        latency = std::move(latency_);
+    }
+
+    void System::setUndistortLUT(std::shared_ptr<const UndistortLUT> lut_) {
+        std::lock_guard<std::mutex> lock(trackMtx);
+        lut = std::move(lut_);
+    }
+
+    void System::setMemoryRegistry(std::shared_ptr<MemoryRegistry> registry) {
+        {
+            std::lock_guard<std::mutex> lock(trackMtx);
+            mapAccount = registry ? MemoryAccount(registry, "map") : MemoryAccount();
+            accountMap();
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMtx);
+            queueAccount = registry ? MemoryAccount(registry, "queue") : MemoryAccount();
+            queueAccount.set(queuedBytes);
+        }
+        spaceCv.notify_all();
+    }
+
+    void System::setMapExporter(std::shared_ptr<MapExporter> exporter_) {
+        std::lock_guard<std::mutex> lock(trackMtx);
+        // The detached exporter owned the change log, nothing trims it any more.
+        if (exporter && exporter != exporter_) map->setChangeLog(false);
+        exporter = std::move(exporter_);
+    }
+
+    size_t System::getKeyframeCount() const {
+        std::lock_guard<std::mutex> lock(trackMtx);
+        return map->getKeyframes().size();
+    }
+
+    size_t System::getLandmarkCount() const {
+        std::lock_guard<std::mutex> lock(trackMtx);
+        return map->getLandmarks().size();
+    }
+
+} // namespace StringSLAM
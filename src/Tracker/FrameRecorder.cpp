@@ -0,0 +1,202 @@
+#include <StringSLAM/Tracker/FrameLog.hpp>
+#include <StringSLAM/Tracker/FrameRecorder.hpp>
+#include <cstring>
+
+namespace StringSLAM::Tracker {
+    static int64_t toNanoseconds(const std::chrono::system_clock::time_point &t) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    }
+
+    FrameRecorder::FrameRecorder(const std::string &path_, const std::vector<CameraModel> &cms_, size_t chunkSize_, size_t maxQueue_) :
+        path(path_), cms(cms_), chunkSize(std::max<size_t>(chunkSize_, 1)), maxQueue(std::max<size_t>(maxQueue_, 1)) { }
+
+    FrameRecorder::~FrameRecorder() {
+        this->close();
+    }
+
+    bool FrameRecorder::open() {
+        if (file) return true;
+        if (cms.empty()) return false;
+
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        offset = 0;
+        failed = false;
+        index.clear();
+        chunk.clear();
+        chunkCount = 0;
+
+        // File header followed by the camera model of every view.
+        std::vector<uint8_t> header;
+        FrameLog::FileHeader fh{};
+        std::memcpy(fh.magic, FrameLog::FILE_MAGIC, sizeof(fh.magic));
+        fh.version = FrameLog::VERSION;
+        fh.views = static_cast<uint32_t>(cms.size());
+        header.insert(header.end(), reinterpret_cast<uint8_t *>(&fh), reinterpret_cast<uint8_t *>(&fh) + sizeof(fh));
+
+        for (auto &cm : cms) {
+            FrameLog::CameraRecord cr{
+                cm.cI.fx, cm.cI.fy, cm.cI.cx, cm.cI.cy,
+                cm.cD.k1, cm.cD.k2, cm.cD.k3, cm.cD.k4, cm.cD.k5, cm.cD.k6, cm.cD.p1, cm.cD.p2,
+                cm.capSize.width, cm.capSize.height
+            };
+            header.insert(header.end(), reinterpret_cast<uint8_t *>(&cr), reinterpret_cast<uint8_t *>(&cr) + sizeof(cr));
+        }
+        pad(header, 0);
+        if (!writeRaw(header.data(), header.size())) {
+            std::fclose(file);
+            file = nullptr;
+            return false;
+        }
+
+        running = true;
+        writer = std::thread(&FrameRecorder::writerLoop, this);
+        return true;
+    }
+
+    bool FrameRecorder::close() {
+        if (!file) return !failed;
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            running = false;
+        }
+        queueCv.notify_all();
+        if (writer.joinable()) writer.join();
+
+        flushChunk();
+
+        // Index and footer make the log seekable without a scan. After a failed
+        // write they would point past the data, so the log is left without them.
+        if (!failed) {
+            FrameLog::Footer footer{};
+            footer.indexOffset = offset;
+            footer.count = index.size();
+            std::memcpy(footer.magic, FrameLog::INDEX_MAGIC, sizeof(footer.magic));
+            if (!index.empty()) writeRaw(index.data(), index.size() * sizeof(FrameLog::IndexEntry));
+            writeRaw(&footer, sizeof(footer));
+        }
+
+        if (std::fclose(file) != 0) failed = true;
+        file = nullptr;
+        return !failed;
+    }
+
+    bool FrameRecorder::record(const Frame &f) {
+        if (cms.size() != 1 || f.frame.empty()) return false;
+
+        // The capture buffer is reused by the next read, so the pixels are copied here.
+        Entry e{toNanoseconds(f.timestamp), f.id, {f.frame.clone()}};
+        return enqueue(std::move(e));
+    }
+
+    bool FrameRecorder::record(const StereoFrame &sf) {
+        if (cms.size() != 2 || sf.frameLeft.frame.empty() || sf.frameRight.frame.empty()) return false;
+
+        Entry e{toNanoseconds(sf.timestamp), sf.id, {sf.frameLeft.frame.clone(), sf.frameRight.frame.clone()}};
+        return enqueue(std::move(e));
+    }
+
+    bool FrameRecorder::enqueue(Entry &&e) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!running || failed) return false;
+            if (queue.size() >= maxQueue) {
+                dropped++;
+                return false;
+            }
+            queue.push_back(std::move(e));
+        }
+        recorded++;
+        queueCv.notify_one();
+        return true;
+    }
+
+    void FrameRecorder::writerLoop() {
+        if (threadInit) threadInit();
+
+        std::deque<Entry> batch;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                queueCv.wait(lock, [&] { return !queue.empty() || !running; });
+                if (queue.empty() && !running) return;
+                batch.swap(queue);
+            }
+
+            // Serialize without holding the lock so record() never blocks on disk.
+            for (auto &e : batch) {
+                if (failed) break;
+                appendEntry(e);
+                if (chunkCount >= chunkSize) flushChunk();
+            }
+            batch.clear();
+        }
+    }
+
+    void FrameRecorder::appendEntry(const Entry &e) {
+        // Offsets are absolute so pixel data stays aligned once the log is mapped.
+        if (chunk.empty()) chunk.resize(sizeof(FrameLog::ChunkHeader));
+        const uint64_t base = offset;
+
+        FrameLog::IndexEntry ie{};
+        ie.offset = base + chunk.size();
+        ie.timestampNs = e.timestampNs;
+        ie.id = e.id;
+        index.push_back(ie);
+
+        FrameLog::FrameRecord fr{e.timestampNs, e.id, static_cast<uint32_t>(e.views.size())};
+        chunk.insert(chunk.end(), reinterpret_cast<uint8_t *>(&fr), reinterpret_cast<uint8_t *>(&fr) + sizeof(fr));
+
+        for (auto &img : e.views) {
+            FrameLog::ImageRecord ir{};
+            ir.rows = img.rows;
+            ir.cols = img.cols;
+            ir.type = img.type();
+            ir.step = static_cast<uint32_t>(img.cols * img.elemSize());
+            ir.bytes = static_cast<uint64_t>(ir.step) * img.rows;
+            chunk.insert(chunk.end(), reinterpret_cast<uint8_t *>(&ir), reinterpret_cast<uint8_t *>(&ir) + sizeof(ir));
+            pad(chunk, base);
+
+            // Rows are packed tightly, clone() already made img continuous.
+            const uint8_t *data = img.ptr<uint8_t>(0);
+            chunk.insert(chunk.end(), data, data + ir.bytes);
+            pad(chunk, base);
+        }
+        chunkCount++;
+    }
+
+    void FrameRecorder::flushChunk() {
+        if (chunk.empty()) return;
+        if (failed) {
+            chunk.clear();
+            chunkCount = 0;
+            return;
+        }
+
+        FrameLog::ChunkHeader ch{};
+        ch.magic = FrameLog::CHUNK_MAGIC;
+        ch.count = static_cast<uint32_t>(chunkCount);
+        ch.bytes = chunk.size() - sizeof(FrameLog::ChunkHeader);
+        std::memcpy(chunk.data(), &ch, sizeof(ch));
+
+        if (writeRaw(chunk.data(), chunk.size()) && std::fflush(file) != 0) failed = true;
+
+        chunk.clear();
+        chunkCount = 0;
+    }
+
+    bool FrameRecorder::writeRaw(const void *data, size_t bytes) {
+        if (failed) return false;
+        if (std::fwrite(data, 1, bytes, file) != bytes) {
+            failed = true;
+            return false;
+        }
+        offset += bytes;
+        return true;
+    }
+
+    void FrameRecorder::pad(std::vector<uint8_t> &buf, uint64_t base) {
+        buf.resize(FrameLog::align(base + buf.size()) - base, 0);
+    }
+}
@@ -25,18 +25,84 @@ namespace StringSLAM::Tracker {
 
         f.setTimestamp();
         cap.read(f.frame);
+
+        // Raw capture is recorded before any undistortion so replays see the same input.
+        if (recorder) recorder->record(f);
     }
 
     void MonoTracker::readUndistorted(Frame &f) {
         this->read(f);
+        this->undistort(f);
+    }
+
+    void MonoTracker::undistort(Frame &f) {
+        if (f.frame.empty() || undistortion == Undistortion::KEYPOINTS) return;
 
         if (kD.empty()) {
             // If optimal K matrix is empty then create it and initialize undistortion map.
             kD = cv::getOptimalNewCameraMatrix(cm.cI.getK(), cm.cD.getD(), cm.capSize, 1.0);
             cv::initUndistortRectifyMap(cm.cI.getK(), cm.cD.getD(), cm.cD.R, kD, cm.capSize, CV_16FC1, m1, m2);
+            accountUndistortion();
+        }
+
+        // Maps dropped to fit the memory budget.
+        if (m1.empty()) {
+            cv::Mat out;
+            cv::undistort(f.frame, out, cm.cI.getK(), cm.cD.getD(), kD);
+            f.frame = out;
+            return;
         }
         
         // Undistort frame using the optimized undistortion map
         cv::remap(f.frame, f.frame, m1, m2, cv::INTER_LINEAR);
     }
-}
\ No newline at end of file
+
+    void MonoTracker::undistortKeypoints(Frame &f) {
+        if (undistortion != Undistortion::KEYPOINTS) return;
+        getUndistortLUT()->undistort(f);
+    }
+
+    void MonoTracker::setUndistortion(Undistortion mode, int step) {
+        undistortion = mode;
+        if (mode == Undistortion::KEYPOINTS && (!lut || lut->getStep() != step)) {
+            lut = UndistortLUT::create(cm, step);
+            accountUndistortion();
+        }
+    }
+
+    std::shared_ptr<UndistortLUT> MonoTracker::getUndistortLUT() {
+        if (!lut) {
+            lut = UndistortLUT::create(cm);
+            accountUndistortion();
+        }
+        return lut;
+    }
+
+    void MonoTracker::setMemoryRegistry(std::shared_ptr<MemoryRegistry> registry, const std::string &name) {
+        account = registry ? std::make_shared<MemoryAccount>(registry, name) : nullptr;
+        accountUndistortion();
+    }
+
+    size_t MonoTracker::getMemoryUsage() const {
+        size_t bytes = m1.total() * m1.elemSize() + m2.total() * m2.elemSize();
+        if (lut) bytes += lut->getMemoryUsage();
+        return bytes;
+    }
+
+    void MonoTracker::accountUndistortion() {
+        if (!account || account->set(getMemoryUsage())) return;
+
+        // cv::undistort has no rectification, keep the maps when there is one.
+        const bool rectified = !cm.cD.R.empty() && cv::norm(cm.cD.R, cv::Mat::eye(3, 3, CV_64F)) > 1e-12;
+        if (!m1.empty() && !rectified) {
+            m1.release();
+            m2.release();
+            if (account->set(getMemoryUsage())) return;
+        }
+
+        while (lut && lut->getStep() < 64) {
+            lut = UndistortLUT::create(cm, lut->getStep() * 2);
+            if (account->set(getMemoryUsage())) return;
+        }
+    }
+}
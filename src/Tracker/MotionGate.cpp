@@ -0,0 +1,90 @@
+#include <StringSLAM/Tracker/MotionGate.hpp>
+
+namespace StringSLAM::Tracker
+{
+    MotionGate::MotionGate(double threshold_, int maxInterval_, cv::Size thumbSize_)
+        : threshold(threshold_), maxInterval(std::max(1, maxInterval_)), thumbSize(std::max(1, thumbSize_.width), std::max(1, thumbSize_.height)) {
+        reference.reserve(size_t(thumbSize.area()));
+        current.reserve(size_t(thumbSize.area()));
+    }
+
+    bool MotionGate::sample(const cv::Mat &img, std::vector<float> &out) const {
+        if (img.empty() || img.depth() != CV_8U || (img.channels() != 1 && img.channels() != 3)) return false;
+
+        // Green (or gray) carries most of the luminance.
+        const int cn = img.channels(), g = cn == 3 ? 1 : 0;
+        const float cellW = float(img.cols) / thumbSize.width, cellH = float(img.rows) / thumbSize.height;
+        out.resize(size_t(thumbSize.area()));
+
+        // Four samples per cell, at its quarter points, damp sensor noise and sub-pixel jitter.
+        size_t k = 0;
+        for (int j = 0; j < thumbSize.height; j++) {
+            const int y0 = std::min(img.rows - 1, int((j + 0.25f) * cellH)), y1 = std::min(img.rows - 1, int((j + 0.75f) * cellH));
+            const uint8_t *r0 = img.ptr<uint8_t>(y0), *r1 = img.ptr<uint8_t>(y1);
+            for (int i = 0; i < thumbSize.width; i++) {
+                const int x0 = std::min(img.cols - 1, int((i + 0.25f) * cellW)) * cn, x1 = std::min(img.cols - 1, int((i + 0.75f) * cellW)) * cn;
+                out[k++] = 0.25f * (float(r0[x0 + g]) + float(r0[x1 + g]) + float(r1[x0 + g]) + float(r1[x1 + g]));
+            }
+        }
+        return true;
+    }
+
+    double MotionGate::score() const {
+        const size_t n = current.size();
+        double mc = 0.0, mr = 0.0;
+        for (size_t k = 0; k < n; k++) {
+            mc += current[k];
+            mr += reference[k];
+        }
+
+        // Remove the global brightness change (auto exposure) before comparing.
+        const double offset = (mc - mr) / double(n);
+        double diff = 0.0;
+        for (size_t k = 0; k < n; k++) diff += std::abs(double(current[k]) - double(reference[k]) - offset);
+        return diff / double(n);
+    }
+
+    bool MotionGate::accept(const Frame &f) {
+        stats.frames++;
+        if (!sample(f.frame, current)) {
+            stats.processed++;
+            return true;
+        }
+
+        bool run;
+        if (!hasReference) {
+            hasReference = true;
+            run = true;
+        } else {
+            stats.lastScore = score();
+            if (stats.lastScore > threshold) {
+                // Motion: back to full rate.
+                stats.interval = 1;
+                run = true;
+            } else if (++sinceProcessed >= stats.interval) {
+                // Static: process this one and wait twice as long for the next.
+                stats.interval = std::min(stats.interval * 2, maxInterval);
+                run = true;
+            } else {
+                run = false;
+            }
+        }
+
+        if (!run) {
+            stats.skipped++;
+            return false;
+        }
+
+        reference.swap(current);
+        sinceProcessed = 0;
+        stats.processed++;
+        return true;
+    }
+
+    void MotionGate::reset() {
+        hasReference = false;
+        sinceProcessed = 0;
+        stats.interval = 1;
+    }
+
+} // namespace StringSLAM::Tracker
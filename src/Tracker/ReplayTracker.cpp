@@ -0,0 +1,187 @@
+#include <StringSLAM/Tracker/ReplayTracker.hpp>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace StringSLAM::Tracker {
+    ReplayTracker::ReplayTracker(const std::string &path_, Playback mode_) : path(path_), mode(mode_) { }
+
+    ReplayTracker::~ReplayTracker() {
+        this->release();
+    }
+
+    bool ReplayTracker::open() {
+        if (data) return true;
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FrameLog::FileHeader)) {
+            ::close(fd);
+            return false;
+        }
+        size = static_cast<size_t>(st.st_size);
+
+        // Private + writable so callers may modify frames in place without touching the file.
+        void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            size = 0;
+            return false;
+        }
+        data = static_cast<uint8_t *>(map);
+        madvise(data, size, MADV_SEQUENTIAL);
+
+        FrameLog::FileHeader fh;
+        std::memcpy(&fh, data, sizeof(fh));
+        const uint64_t camerasEnd = sizeof(fh) + static_cast<uint64_t>(fh.views) * sizeof(FrameLog::CameraRecord);
+        if (std::memcmp(fh.magic, FrameLog::FILE_MAGIC, sizeof(fh.magic)) != 0 || fh.version != FrameLog::VERSION ||
+            fh.views == 0 || camerasEnd > size) {
+            this->release();
+            return false;
+        }
+
+        cms.clear();
+        for (uint32_t v = 0; v < fh.views; v++) {
+            FrameLog::CameraRecord cr;
+            std::memcpy(&cr, data + sizeof(fh) + v * sizeof(cr), sizeof(cr));
+
+            CameraDistortion cD(cr.k1, cr.k2, cr.k3, cr.p1, cr.p2);
+            cD.k4 = cr.k4;
+            cD.k5 = cr.k5;
+            cD.k6 = cr.k6;
+            cms.emplace_back(CameraIntrinsic(cr.fx, cr.fy, cr.cx, cr.cy), cD, cv::Size(cr.width, cr.height));
+        }
+
+        if (!buildIndex(FrameLog::align(camerasEnd))) {
+            this->release();
+            return false;
+        }
+
+        cursor = 0;
+        paced = false;
+        return true;
+    }
+
+    void ReplayTracker::release() {
+        if (data) munmap(data, size);
+        data = nullptr;
+        size = 0;
+        index.clear();
+        cursor = 0;
+    }
+
+    bool ReplayTracker::buildIndex(uint64_t start) {
+        index.clear();
+
+        // Cleanly closed log, the footer points to the index.
+        if (size >= start + sizeof(FrameLog::Footer)) {
+            FrameLog::Footer footer;
+            std::memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+            if (std::memcmp(footer.magic, FrameLog::INDEX_MAGIC, sizeof(footer.magic)) == 0 &&
+                footer.indexOffset + footer.count * sizeof(FrameLog::IndexEntry) + sizeof(footer) <= size) {
+                index.resize(footer.count);
+                if (footer.count) std::memcpy(index.data(), data + footer.indexOffset, footer.count * sizeof(FrameLog::IndexEntry));
+                return true;
+            }
+        }
+
+        // Recorder did not close (crash, power loss): walk the chunks that made it to disk.
+        uint64_t off = start;
+        while (off + sizeof(FrameLog::ChunkHeader) <= size) {
+            FrameLog::ChunkHeader ch;
+            std::memcpy(&ch, data + off, sizeof(ch));
+            if (ch.magic != FrameLog::CHUNK_MAGIC || off + sizeof(ch) + ch.bytes > size) break;
+
+            uint64_t rec = off + sizeof(ch);
+            for (uint32_t i = 0; i < ch.count; i++) {
+                FrameLog::FrameRecord fr;
+                std::memcpy(&fr, data + rec, sizeof(fr));
+                index.push_back({rec, fr.timestampNs, fr.id, 0});
+
+                rec += sizeof(fr);
+                for (uint32_t v = 0; v < fr.views; v++) {
+                    FrameLog::ImageRecord ir;
+                    std::memcpy(&ir, data + rec, sizeof(ir));
+                    rec = FrameLog::align(FrameLog::align(rec + sizeof(ir)) + ir.bytes);
+                }
+            }
+            off += sizeof(ch) + ch.bytes;
+        }
+        return true;
+    }
+
+    bool ReplayTracker::readViews(std::vector<cv::Mat> &views, int64_t &timestampNs, int &id) {
+        if (!data || cursor >= index.size()) return false;
+
+        const FrameLog::IndexEntry &ie = index[cursor++];
+        FrameLog::FrameRecord fr;
+        std::memcpy(&fr, data + ie.offset, sizeof(fr));
+        timestampNs = fr.timestampNs;
+        id = fr.id;
+
+        uint64_t rec = ie.offset + sizeof(fr);
+        views.clear();
+        for (uint32_t v = 0; v < fr.views; v++) {
+            FrameLog::ImageRecord ir;
+            std::memcpy(&ir, data + rec, sizeof(ir));
+            const uint64_t pixels = FrameLog::align(rec + sizeof(ir));
+            if (pixels + ir.bytes > size) return false;
+
+            // Header over the mapped pixels, zero copy.
+            views.emplace_back(ir.rows, ir.cols, ir.type, data + pixels, ir.step);
+            rec = FrameLog::align(pixels + ir.bytes);
+        }
+
+        if (mode == Playback::REAL_TIME) {
+            if (!paced) {
+                startWall = std::chrono::steady_clock::now();
+                startLogNs = timestampNs;
+                paced = true;
+            }
+            std::this_thread::sleep_until(startWall + std::chrono::nanoseconds(timestampNs - startLogNs));
+        }
+        return true;
+    }
+
+    bool ReplayTracker::read(Frame &f) {
+        std::vector<cv::Mat> views;
+        int64_t ts;
+        int id;
+        if (!readViews(views, ts, id) || views.empty()) return false;
+
+        f.id = id;
+        f.timestamp = std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ts)));
+        f.frame = views[0];
+        f.raw = RawBuffer();
+        return true;
+    }
+
+    bool ReplayTracker::read(StereoFrame &sf) {
+        std::vector<cv::Mat> views;
+        int64_t ts;
+        int id;
+        if (cms.size() < 2 || !readViews(views, ts, id) || views.size() < 2) return false;
+
+        sf.id = id;
+        sf.timestamp = std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ts)));
+        sf.frameLeft.id = sf.frameRight.id = id;
+        sf.frameLeft.timestamp = sf.frameRight.timestamp = sf.timestamp;
+        sf.frameLeft.frame = views[0];
+        sf.frameRight.frame = views[1];
+        return true;
+    }
+
+    bool ReplayTracker::seek(size_t i) {
+        if (i >= index.size()) return false;
+        cursor = i;
+        paced = false;
+        return true;
+    }
+}
@@ -0,0 +1,143 @@
+#include <StringSLAM/Tracker/RigTracker.hpp>
+
+namespace StringSLAM::Tracker {
+    RigTracker::RigTracker(const std::vector<std::shared_ptr<MonoTracker>> &cams_, const std::vector<SE3> &extrinsics_,
+        std::chrono::microseconds tolerance_, std::shared_ptr<Utils::ThreadPool> pool_) :
+        cams(cams_), extrinsics(extrinsics_), tolerance(tolerance_), pool(pool_), pending(cams_.size()) {
+        // Missing extrinsics default to identity so the rig is still usable for capture.
+        extrinsics.resize(cams.size());
+
+        if (!pool) pool = Utils::ThreadPool::create(cams.size());
+    }
+
+    RigTracker::~RigTracker() {
+        this->release();
+    }
+
+    bool RigTracker::open() {
+        if (running) return true;
+
+        for (auto &cam : cams)
+            if (!cam || !cam->open()) return false;
+
+        running = true;
+        for (size_t i = 0; i < cams.size(); i++)
+            captureThreads.emplace_back(&RigTracker::captureLoop, this, i);
+        return true;
+    }
+
+    void RigTracker::release() {
+        running = false;
+        frameCv.notify_all();
+        for (auto &t : captureThreads) t.join();
+        captureThreads.clear();
+
+        for (auto &cam : cams)
+            if (cam) cam->release();
+
+        std::lock_guard<std::mutex> lock(mtx);
+        for (auto &q : pending) q.clear();
+    }
+
+    void RigTracker::setFeatureFinders(const std::vector<std::shared_ptr<Feature::FeatureFinder>> &finders_) {
+        finders = finders_;
+        if (!finders.empty()) finders.resize(cams.size());
+    }
+
+    void RigTracker::captureLoop(size_t cam) {
+        while (running) {
+            Frame f;
+            cams[cam]->read(f);
+            if (f.frame.empty()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                // A stalled consumer must not grow memory, drop the oldest frame.
+                if (pending[cam].size() >= MAX_PENDING) pending[cam].pop_front();
+                pending[cam].push_back(std::move(f));
+            }
+            frameCv.notify_all();
+        }
+    }
+
+    bool RigTracker::assemble(RigFrame &rf) {
+        // Called with mtx held.
+        for (auto &q : pending)
+            if (q.empty()) return false;
+
+        // Candidate sets are walked by position, nothing is popped until one is chosen.
+        std::vector<size_t> pos(pending.size(), 0), best;
+        std::chrono::system_clock::time_point newest, bestNewest;
+        for (;;) {
+            // Heads further than the window behind the newest head can never match it
+            // or anything captured later. Skipping one can raise the newest head, so
+            // repeat until every head fits.
+            bool ok = true, skipped = true;
+            while (ok && skipped) {
+                newest = pending[0][pos[0]].timestamp;
+                for (size_t i = 1; i < pending.size(); i++) newest = std::max(newest, pending[i][pos[i]].timestamp);
+
+                skipped = false;
+                for (size_t i = 0; i < pending.size() && ok; i++) {
+                    while (pos[i] < pending[i].size() && newest - pending[i][pos[i]].timestamp > tolerance) {
+                        pos[i]++;
+                        skipped = true;
+                    }
+                    ok = pos[i] < pending[i].size();
+                }
+            }
+            if (!ok) break;
+
+            // Complete set, look for a newer one behind the oldest head.
+            best = pos;
+            bestNewest = newest;
+            size_t oldest = 0;
+            for (size_t i = 1; i < pending.size(); i++)
+                if (pending[i][pos[i]].timestamp < pending[oldest][pos[oldest]].timestamp) oldest = i;
+            if (++pos[oldest] == pending[oldest].size()) break;
+        }
+
+        if (best.empty()) {
+            // Only the heads skipped before the first mismatch are stale for good.
+            for (size_t i = 0; i < pending.size(); i++) {
+                while (!pending[i].empty() && newest - pending[i].front().timestamp > tolerance) pending[i].pop_front();
+            }
+            return false;
+        }
+
+        // Frames older than the chosen set are superseded by it.
+        rf.frames.resize(pending.size());
+        for (size_t i = 0; i < pending.size(); i++) {
+            pending[i].erase(pending[i].begin(), pending[i].begin() + best[i]);
+            rf.frames[i] = std::move(pending[i].front());
+            pending[i].pop_front();
+        }
+        rf.timestamp = bestNewest;
+        rf.id = nextId++;
+        return true;
+    }
+
+    bool RigTracker::read(RigFrame &rf, std::chrono::milliseconds timeout) {
+        if (!running && !this->open()) return false;
+
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            if (!frameCv.wait_for(lock, timeout, [&] { return !running || assemble(rf); }) || !running)
+                return false;
+        }
+
+        for (auto &f : rf.frames) f.id = rf.id;
+
+        // Per-camera work is independent, fan it out over the pool.
+        if (undistortFrames || !finders.empty()) {
+            pool->parallelFor(0, rf.frames.size(), [&](size_t i) {
+                if (undistortFrames) cams[i]->undistort(rf.frames[i]);
+                if (!finders.empty() && finders[i]) finders[i]->getKeypoints(rf.frames[i]);
+            });
+        }
+        return true;
+    }
+}
@@ -13,6 +13,8 @@ namespace StringSLAM::Tracker {
         sf.setTimestamp();
         mt1.read(sf.frameLeft);
         mt2.read(sf.frameRight);
+
+        if (recorder) recorder->record(sf);
     }
 
     void StereoTracker::readDepth(StereoFrame &sf) {
@@ -60,9 +62,41 @@ namespace StringSLAM::Tracker {
         }
 
         // Undistort capture frames from pre-calculated rectify maps
-        cv::remap(sf.frameLeft.frame, sf.frameLeft.frame, m1x, m1y, cv::INTER_LINEAR);
-        cv::remap(sf.frameRight.frame, sf.frameRight.frame, m2x, m2y, cv::INTER_LINEAR);
+        cv::remap(sf.frameLeft.frame, sf.frameLeft.frame, m1x, m1y, interpolation);
+        cv::remap(sf.frameRight.frame, sf.frameRight.frame, m2x, m2y, interpolation);
 
         sgbm.compute(sf);
+        depthBytes = sf.depthFrame.total() * sf.depthFrame.elemSize();
+        accountStereo();
+    }
+
+    void StereoTracker::setMemoryRegistry(std::shared_ptr<MemoryRegistry> registry, const std::string &name) {
+        account = registry ? std::make_shared<MemoryAccount>(registry, name) : nullptr;
+        accountStereo();
+    }
+
+    size_t StereoTracker::getMemoryUsage() const {
+        size_t bytes = sgbm.getMemoryUsage() + depthBytes;
+        for (const cv::Mat *m : {&m1x, &m1y, &m2x, &m2y}) bytes += m->total() * m->elemSize();
+        return bytes;
+    }
+
+    void StereoTracker::accountStereo() {
+        if (!account || account->set(getMemoryUsage()) || m1x.type() != CV_32FC1) return;
+
+        // Fixed point keeps bilinear interpolation, nearest-neighbour drops the fraction table.
+        const size_t pixels = m1x.total() + m2x.total();
+        const size_t rest = getMemoryUsage() - pixels * 2 * sizeof(float);
+        const bool linear = account->fits(rest + pixels * (2 * sizeof(int16_t) + sizeof(uint16_t)));
+
+        cv::Mat a, b;
+        cv::convertMaps(m1x, m1y, a, b, CV_16SC2, !linear);
+        m1x = a;
+        m1y = b;
+        cv::convertMaps(m2x, m2y, a, b, CV_16SC2, !linear);
+        m2x = a;
+        m2y = b;
+        interpolation = linear ? cv::INTER_LINEAR : cv::INTER_NEAREST;
+        account->set(getMemoryUsage());
     }
 }
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include <StringSLAM/Utils/Evaluation.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <sys/resource.h>
+
+namespace StringSLAM::Utils
+{
+    ErrorStats ErrorStats::compute(std::vector<double> &values) {
+        ErrorStats s;
+        s.count = values.size();
+        if (values.empty()) return s;
+
+        double sum = 0.0, sq = 0.0;
+        for (double v : values) {
+            sum += v;
+            sq += v * v;
+            s.max = std::max(s.max, v);
+        }
+        s.mean = sum / double(values.size());
+        s.rmse = std::sqrt(sq / double(values.size()));
+
+        std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+        s.median = values[values.size() / 2];
+        return s;
+    }
+
+    bool TrajectoryEvaluator::align(const std::vector<Eigen::Vector3d> &src, const std::vector<Eigen::Vector3d> &dst,
+        bool withScale, Sim3 &S_dst_src) {
+        const size_t n = src.size();
+        if (n < 3 || dst.size() != n) return false;
+
+        Eigen::Vector3d muSrc = Eigen::Vector3d::Zero(), muDst = Eigen::Vector3d::Zero();
+        for (size_t i = 0; i < n; i++) {
+            muSrc += src[i];
+            muDst += dst[i];
+        }
+        muSrc /= double(n);
+        muDst /= double(n);
+
+        Eigen::Matrix3d cov = Eigen::Matrix3d::Zero();
+        double varSrc = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            const Eigen::Vector3d a = src[i] - muSrc, b = dst[i] - muDst;
+            cov += b * a.transpose();
+            varSrc += a.squaredNorm();
+        }
+        cov /= double(n);
+        varSrc /= double(n);
+        if (varSrc < 1e-12) return false;
+
+        Eigen::JacobiSVD<Eigen::Matrix3d> svd(cov, Eigen::ComputeFullU | Eigen::ComputeFullV);
+        Eigen::Matrix3d D = Eigen::Matrix3d::Identity();
+        if (svd.matrixU().determinant() * svd.matrixV().determinant() < 0.0) D(2, 2) = -1.0;
+
+        const Eigen::Matrix3d R = svd.matrixU() * D * svd.matrixV().transpose();
+        const double s = withScale ? (svd.singularValues().asDiagonal() * D).trace() / varSrc : 1.0;
+        S_dst_src = Sim3(SO3(R), muDst - s * (R * muSrc), s);
+        return true;
+    }
+
+    bool TrajectoryEvaluator::evaluate(const std::vector<StampedPose> &estimate, const std::vector<StampedPose> &groundTruth,
+        TrajectoryErrors &errors) const {
+        errors = TrajectoryErrors();
+        if (estimate.empty() || groundTruth.empty()) return false;
+
+        // Nearest ground truth pose of every estimate, both sorted by time.
+        std::vector<std::pair<size_t, size_t>> pairs;
+        size_t g = 0;
+        for (size_t e = 0; e < estimate.size(); e++) {
+            const double t = estimate[e].timestamp;
+            while (g + 1 < groundTruth.size() && std::abs(groundTruth[g + 1].timestamp - t) <= std::abs(groundTruth[g].timestamp - t)) g++;
+            if (std::abs(groundTruth[g].timestamp - t) <= maxTimeDifference) pairs.emplace_back(e, g);
+        }
+
+        std::vector<Eigen::Vector3d> src, dst;
+        src.reserve(pairs.size());
+        dst.reserve(pairs.size());
+        for (auto &[e, gi] : pairs) {
+            src.push_back(estimate[e].pose.translation());
+            dst.push_back(groundTruth[gi].pose.translation());
+        }
+        if (!align(src, dst, alignScale, errors.alignment)) return false;
+        errors.matched = pairs.size();
+
+        std::vector<double> ate(pairs.size());
+        std::vector<SE3> aligned(pairs.size());
+        for (size_t i = 0; i < pairs.size(); i++) {
+            ate[i] = (errors.alignment * src[i] - dst[i]).norm();
+            aligned[i] = (errors.alignment * Sim3(estimate[pairs[i].first].pose)).toSE3();
+        }
+        errors.ate = ErrorStats::compute(ate);
+
+        // RPE between every pose and the first one at least rpeDelta later.
+        std::vector<double> rpeT, rpeR;
+        size_t j = 0;
+        for (size_t i = 0; i < pairs.size(); i++) {
+            const double ti = groundTruth[pairs[i].second].timestamp;
+            j = std::max(j, i + 1);
+            while (j < pairs.size() && groundTruth[pairs[j].second].timestamp - ti < rpeDelta) j++;
+            if (j >= pairs.size()) break;
+
+            const SE3 &Gi = groundTruth[pairs[i].second].pose, &Gj = groundTruth[pairs[j].second].pose;
+            const SE3 E = (Gi.inverse() * Gj).inverse() * (aligned[i].inverse() * aligned[j]);
+            rpeT.push_back(E.translation().norm());
+            rpeR.push_back(E.so3().log().norm() * 180.0 / EIGEN_PI);
+        }
+        errors.rpeTranslation = ErrorStats::compute(rpeT);
+        errors.rpeRotation = ErrorStats::compute(rpeR);
+        return true;
+    }
+
+    bool TrajectoryEvaluator::loadTUM(const std::string &path, std::vector<StampedPose> &poses) {
+        std::ifstream in(path);
+        if (!in) return false;
+
+        poses.clear();
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::replace(line.begin(), line.end(), ',', ' ');
+
+            std::istringstream ss(line);
+            double t, x, y, z, qx, qy, qz, qw;
+            if (!(ss >> t >> x >> y >> z >> qx >> qy >> qz >> qw)) continue;
+            poses.push_back({t, SE3(SO3(Eigen::Quaterniond(qw, qx, qy, qz)), Eigen::Vector3d(x, y, z))});
+        }
+        std::stable_sort(poses.begin(), poses.end(), [](auto &a, auto &b) { return a.timestamp < b.timestamp; });
+        return true;
+    }
+
+    bool TrajectoryEvaluator::saveTUM(const std::string &path, const std::vector<StampedPose> &poses) {
+        std::ofstream out(path);
+        if (!out) return false;
+
+        out << std::fixed;
+        for (auto &p : poses) {
+            const Eigen::Vector3d &t = p.pose.translation();
+            const Eigen::Quaterniond &q = p.pose.so3().quaternion();
+            out << std::setprecision(6) << p.timestamp << std::setprecision(9) << ' ' << t.x() << ' ' << t.y() << ' ' << t.z()
+                << ' ' << q.x() << ' ' << q.y() << ' ' << q.z() << ' ' << q.w() << '\n';
+        }
+        return bool(out);
+    }
+
+    LatencyRecorder::Summary LatencyRecorder::summary(const std::string &stage) const {
+        Summary s;
+        auto it = samples.find(stage);
+        if (it == samples.end() || it->second.empty()) return s;
+
+        std::vector<double> v = it->second;
+        std::sort(v.begin(), v.end());
+        s.count = v.size();
+
+        double sum = 0.0;
+        for (double x : v) sum += x;
+        s.mean = sum / double(v.size());
+
+        // Nearest-rank percentiles.
+        auto rank = [&](double p) { return v[std::min(v.size() - 1, size_t(std::ceil(p * double(v.size()))) - 1)]; };
+        s.p50 = rank(0.50);
+        s.p90 = rank(0.90);
+        s.p99 = rank(0.99);
+        s.max = v.back();
+        return s;
+    }
+
+    std::vector<std::string> LatencyRecorder::stages() const {
+        std::vector<std::string> names;
+        names.reserve(samples.size());
+        for (auto &[name, v] : samples) names.push_back(name);
+        return names;
+    }
+
+    size_t getPeakMemoryKB() {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+        // Linux reports KiB.
+        return size_t(usage.ru_maxrss);
+    }
+
+} // namespace StringSLAM::Utils
@@ -0,0 +1,131 @@
+#include <StringSLAM/Utils/ThreadPool.hpp>
+
+namespace StringSLAM::Utils
+{
+    namespace
+    {
+        // Pool and queue of the worker running on this thread.
+        thread_local const ThreadPool *currentPool = nullptr;
+        thread_local size_t currentIndex = 0;
+    } // namespace
+
+    ThreadPool::ThreadPool(size_t threads, std::function<void()> init) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+        queues.reserve(threads);
+        for (size_t i = 0; i < threads; i++) queues.push_back(std::make_unique<Queue>());
+
+        workers.reserve(threads);
+        for (size_t i = 0; i < threads; i++)
+            workers.emplace_back(&ThreadPool::workerLoop, this, i, init);
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        taskCv.notify_all();
+        for (auto &w : workers) w.join();
+    }
+
+    size_t ThreadPool::localQueue() {
+        if (currentPool == this) return currentIndex;
+        return nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    }
+
+    void ThreadPool::push(std::function<void()> task) {
+        Queue &q = *queues[localQueue()];
+        {
+            // Counted before it becomes visible, so a worker popping it never underflows pending.
+            std::lock_guard<std::mutex> lock(q.mtx);
+            pending.fetch_add(1);
+            q.tasks.push_back(std::move(task));
+        }
+
+        // Taking mtx orders the wakeup after a sleeping worker checked pending.
+        { std::lock_guard<std::mutex> lock(mtx); }
+        taskCv.notify_one();
+    }
+
+    bool ThreadPool::pop(size_t index, std::function<void()> &task) {
+        // Own queue first, in submission order.
+        {
+            Queue &q = *queues[index];
+            std::lock_guard<std::mutex> lock(q.mtx);
+            if (!q.tasks.empty()) {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+                pending.fetch_sub(1);
+                return true;
+            }
+        }
+
+        // Steal the newest task of another worker, the owner keeps working on the oldest.
+        for (size_t k = 1; k < queues.size(); k++) {
+            Queue &q = *queues[(index + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.mtx);
+            if (!q.tasks.empty()) {
+                task = std::move(q.tasks.back());
+                q.tasks.pop_back();
+                pending.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::workerLoop(size_t index, const std::function<void()> &init) {
+        currentPool = this;
+        currentIndex = index;
+        if (init) init();
+
+        for (;;) {
+            std::function<void()> task;
+            if (pop(index, task)) {
+                task();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mtx);
+            taskCv.wait(lock, [&] { return stopping || pending.load() > 0; });
+            if (stopping && pending.load() == 0) return;
+        }
+    }
+
+    void ThreadPool::parallelFor(size_t begin, size_t end, const std::function<void(size_t)> &fn) {
+        if (begin >= end) return;
+        const size_t n = end - begin;
+
+        // Shared loop state, helpers that start after the loop finished find no work.
+        struct Loop {
+            std::atomic<size_t> next;
+            std::atomic<size_t> done{0};
+            std::mutex mtx;
+            std::condition_variable cv;
+        };
+        auto loop = std::make_shared<Loop>();
+        loop->next = begin;
+
+        auto body = [loop, &fn, end, n] {
+            size_t i, finished = 0;
+            while ((i = loop->next.fetch_add(1)) < end) {
+                fn(i);
+                finished++;
+            }
+            if (finished && loop->done.fetch_add(finished) + finished == n) {
+                std::lock_guard<std::mutex> lock(loop->mtx);
+                loop->cv.notify_all();
+            }
+        };
+
+        const size_t helpers = std::min(n - 1, workers.size());
+        for (size_t h = 0; h < helpers; h++) push(body);
+
+        body();
+
+        std::unique_lock<std::mutex> lock(loop->mtx);
+        loop->cv.wait(lock, [&] { return loop->done.load() == n; });
+    }
+
+} // namespace StringSLAM::Utils
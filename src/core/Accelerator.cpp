@@ -0,0 +1,186 @@
+#include <StringSLAM/core.hpp>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace StringSLAM
+{
+    namespace
+    {
+        // Clusters below these fractions of the fastest core count as little.
+        constexpr double LITTLE_CAPACITY = 0.6;
+        constexpr double LITTLE_FREQUENCY = 0.8;
+
+        bool readText(const std::string &path, std::string &out) {
+            std::ifstream in(path);
+            return in && std::getline(in, out);
+        }
+
+        bool readInt(const std::string &path, int &out) {
+            std::string s;
+            if (!readText(path, s)) return false;
+            try {
+                out = std::stoi(s);
+            } catch (const std::exception &) {
+                return false;
+            }
+            return true;
+        }
+
+        // Kernel cpulist format, e.g. "0-3,6,8-9".
+        std::vector<int> parseCpuList(const std::string &list) {
+            std::vector<int> cpus;
+            std::stringstream ss(list);
+            std::string range;
+            while (std::getline(ss, range, ',')) {
+                if (range.empty()) continue;
+                const size_t dash = range.find('-');
+                try {
+                    const int first = std::stoi(range.substr(0, dash));
+                    const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                    for (int c = first; c <= last; c++) cpus.push_back(c);
+                } catch (const std::exception &) {
+                    return {};
+                }
+            }
+            return cpus;
+        }
+    } // namespace
+
+    Accelerator::Accelerator() : features(CpuFeatures::detect()), stageCpus(size_t(Stage::IO) + 1) {
+        selectHammingKernels(features.best());
+        detectTopology();
+
+        setStageAffinity(Stage::CAPTURE, CoreClass::LITTLE);
+        setStageAffinity(Stage::FEATURES, CoreClass::BIG);
+        setStageAffinity(Stage::TRACKING, CoreClass::BIG);
+        setStageAffinity(Stage::MAPPING, CoreClass::BIG);
+        setStageAffinity(Stage::IO, CoreClass::LITTLE);
+    }
+
+    void Accelerator::detectTopology() {
+        cores.clear();
+
+#if defined(__linux__)
+        const std::string root = "/sys/devices/system/cpu/";
+        std::string online;
+        std::vector<int> ids = readText(root + "online", online) ? parseCpuList(online) : std::vector<int>();
+
+        // Only the CPUs this process may run on (containers, taskset).
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            if (ids.empty())
+                for (int c = 0; c < CPU_SETSIZE; c++)
+                    if (CPU_ISSET(c, &allowed)) ids.push_back(c);
+            ids.erase(std::remove_if(ids.begin(), ids.end(), [&](int c) { return c >= CPU_SETSIZE || !CPU_ISSET(c, &allowed); }), ids.end());
+        }
+
+        bool hasCapacity = false;
+        for (int id : ids) {
+            CpuCore c;
+            c.id = id;
+            const std::string dir = root + "cpu" + std::to_string(id) + "/";
+            readInt(dir + "topology/physical_package_id", c.package);
+            readInt(dir + "cpufreq/cpuinfo_max_freq", c.maxFreqKHz);
+            c.capacity = 0;
+            if (readInt(dir + "cpu_capacity", c.capacity)) hasCapacity = true;
+            cores.push_back(c);
+        }
+
+        if (!cores.empty()) {
+            // Intel hybrid CPUs list their performance cores directly.
+            std::string list;
+            std::vector<int> performance;
+            if (readText("/sys/devices/cpu_core/cpus", list)) performance = parseCpuList(list);
+
+            int maxCapacity = 0, maxFreq = 0;
+            for (auto &c : cores) {
+                maxCapacity = std::max(maxCapacity, c.capacity);
+                maxFreq = std::max(maxFreq, c.maxFreqKHz);
+            }
+
+            for (auto &c : cores) {
+                if (!hasCapacity) c.capacity = maxFreq > 0 && c.maxFreqKHz > 0 ? int(1024LL * c.maxFreqKHz / maxFreq) : 1024;
+                else if (maxCapacity > 0) c.capacity = int(1024LL * c.capacity / maxCapacity);
+
+                if (!performance.empty()) c.big = std::find(performance.begin(), performance.end(), c.id) != performance.end();
+                else if (hasCapacity) c.big = c.capacity >= LITTLE_CAPACITY * 1024;
+                else c.big = maxFreq == 0 || c.maxFreqKHz == 0 || c.maxFreqKHz >= LITTLE_FREQUENCY * maxFreq;
+            }
+            return;
+        }
+#endif
+
+        const int n = int(std::max(1u, std::thread::hardware_concurrency()));
+        for (int i = 0; i < n; i++) {
+            CpuCore c;
+            c.id = i;
+            cores.push_back(c);
+        }
+    }
+
+    IsaLevel Accelerator::setKernelLevel(IsaLevel maxLevel) {
+        return selectHammingKernels(maxLevel);
+    }
+
+    IsaLevel Accelerator::getKernelLevel() const {
+        return getHammingKernels().level;
+    }
+
+    bool Accelerator::isHeterogeneous() const {
+        return std::any_of(cores.begin(), cores.end(), [](const CpuCore &c) { return c.big; }) &&
+            std::any_of(cores.begin(), cores.end(), [](const CpuCore &c) { return !c.big; });
+    }
+
+    std::vector<int> Accelerator::getCpus(CoreClass cls) const {
+        std::vector<int> cpus;
+        const bool mixed = isHeterogeneous();
+        for (auto &c : cores) {
+            if (cls == CoreClass::ANY || !mixed || (cls == CoreClass::BIG) == c.big) cpus.push_back(c.id);
+        }
+        return cpus;
+    }
+
+    void Accelerator::setStageAffinity(Stage stage, CoreClass cls) {
+        stageCpus[size_t(stage)] = getCpus(cls);
+    }
+
+    void Accelerator::setStageAffinity(Stage stage, const std::vector<int> &cpus) {
+        stageCpus[size_t(stage)] = cpus.empty() ? getCpus(CoreClass::ANY) : cpus;
+    }
+
+    bool Accelerator::pinCurrentThread(const std::vector<int> &cpus) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (cpus.empty()) {
+            for (int c = 0; c < CPU_SETSIZE; c++) CPU_SET(c, &set);
+        } else {
+            for (int c : cpus)
+                if (c >= 0 && c < CPU_SETSIZE) CPU_SET(c, &set);
+        }
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)cpus;
+        return false;
+#endif
+    }
+
+    std::function<void()> Accelerator::threadInit(Stage stage) const {
+        const std::vector<int> cpus = getStageCpus(stage);
+        return [cpus] { pinCurrentThread(cpus); };
+    }
+
+    std::shared_ptr<Utils::ThreadPool> Accelerator::createPool(Stage stage, size_t threads) const {
+        if (threads == 0) threads = getStageCpus(stage).size();
+        return Utils::ThreadPool::create(threads, threadInit(stage));
+    }
+
+} // namespace StringSLAM
@@ -0,0 +1,468 @@
+#include <StringSLAM/core/CameraModels.hpp>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace StringSLAM
+{
+    namespace
+    {
+        // ------------------ 4-lane float vector ------------------
+        // Masks are vectors too: all bits set (SSE/NEON) or non-zero (scalar) lanes are true.
+
+#if defined(__SSE2__) || defined(_M_X64)
+        struct F4 { __m128 v; };
+
+        inline F4 set1(float s) { return {_mm_set1_ps(s)}; }
+        inline F4 loadu(const float *p) { return {_mm_loadu_ps(p)}; }
+        inline void storeu(float *p, F4 a) { _mm_storeu_ps(p, a.v); }
+        inline F4 operator+(F4 a, F4 b) { return {_mm_add_ps(a.v, b.v)}; }
+        inline F4 operator-(F4 a, F4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+        inline F4 operator*(F4 a, F4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+        inline F4 operator/(F4 a, F4 b) { return {_mm_div_ps(a.v, b.v)}; }
+        inline F4 vsqrt(F4 a) { return {_mm_sqrt_ps(a.v)}; }
+        inline F4 vmin(F4 a, F4 b) { return {_mm_min_ps(a.v, b.v)}; }
+        inline F4 vmax(F4 a, F4 b) { return {_mm_max_ps(a.v, b.v)}; }
+        inline F4 operator<(F4 a, F4 b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+        inline F4 operator>(F4 a, F4 b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+        inline F4 operator&(F4 a, F4 b) { return {_mm_and_ps(a.v, b.v)}; }
+        inline F4 select(F4 m, F4 a, F4 b) { return {_mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v))}; }
+        inline int movemask(F4 m) { return _mm_movemask_ps(m.v); }
+#elif defined(__ARM_NEON)
+        struct F4 { float32x4_t v; };
+
+        inline F4 set1(float s) { return {vdupq_n_f32(s)}; }
+        inline F4 loadu(const float *p) { return {vld1q_f32(p)}; }
+        inline void storeu(float *p, F4 a) { vst1q_f32(p, a.v); }
+        inline F4 operator+(F4 a, F4 b) { return {vaddq_f32(a.v, b.v)}; }
+        inline F4 operator-(F4 a, F4 b) { return {vsubq_f32(a.v, b.v)}; }
+        inline F4 operator*(F4 a, F4 b) { return {vmulq_f32(a.v, b.v)}; }
+        inline F4 vmin(F4 a, F4 b) { return {vminq_f32(a.v, b.v)}; }
+        inline F4 vmax(F4 a, F4 b) { return {vmaxq_f32(a.v, b.v)}; }
+        inline F4 operator<(F4 a, F4 b) { return {vreinterpretq_f32_u32(vcltq_f32(a.v, b.v))}; }
+        inline F4 operator>(F4 a, F4 b) { return {vreinterpretq_f32_u32(vcgtq_f32(a.v, b.v))}; }
+        inline F4 operator&(F4 a, F4 b) {
+            return {vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v)))};
+        }
+        inline F4 select(F4 m, F4 a, F4 b) { return {vbslq_f32(vreinterpretq_u32_f32(m.v), a.v, b.v)}; }
+        inline int movemask(F4 m) {
+            uint32_t b[4];
+            vst1q_u32(b, vreinterpretq_u32_f32(m.v));
+            return int((b[0] >> 31) | ((b[1] >> 31) << 1) | ((b[2] >> 31) << 2) | ((b[3] >> 31) << 3));
+        }
+#if defined(__aarch64__)
+        inline F4 operator/(F4 a, F4 b) { return {vdivq_f32(a.v, b.v)}; }
+        inline F4 vsqrt(F4 a) { return {vsqrtq_f32(a.v)}; }
+#else
+        // ARMv7 has no vector divide or square root, refine the estimates with Newton-Raphson.
+        inline F4 operator/(F4 a, F4 b) {
+            float32x4_t r = vrecpeq_f32(b.v);
+            r = vmulq_f32(vrecpsq_f32(b.v, r), r);
+            r = vmulq_f32(vrecpsq_f32(b.v, r), r);
+            return {vmulq_f32(a.v, r)};
+        }
+        inline F4 vsqrt(F4 a) {
+            float32x4_t r = vrsqrteq_f32(a.v);
+            r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a.v, r), r), r);
+            r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a.v, r), r), r);
+            const uint32x4_t zero = vceqq_f32(a.v, vdupq_n_f32(0.0f));
+            return {vbslq_f32(zero, vdupq_n_f32(0.0f), vmulq_f32(a.v, r))};
+        }
+#endif
+#else
+        struct F4 { float v[4]; };
+
+        template <class Op>
+        inline F4 map(F4 a, F4 b, Op op) {
+            F4 r;
+            for (int i = 0; i < 4; i++) r.v[i] = op(a.v[i], b.v[i]);
+            return r;
+        }
+
+        inline F4 set1(float s) { return {{s, s, s, s}}; }
+        inline F4 loadu(const float *p) { return {{p[0], p[1], p[2], p[3]}}; }
+        inline void storeu(float *p, F4 a) { for (int i = 0; i < 4; i++) p[i] = a.v[i]; }
+        inline F4 operator+(F4 a, F4 b) { return map(a, b, [](float x, float y) { return x + y; }); }
+        inline F4 operator-(F4 a, F4 b) { return map(a, b, [](float x, float y) { return x - y; }); }
+        inline F4 operator*(F4 a, F4 b) { return map(a, b, [](float x, float y) { return x * y; }); }
+        inline F4 operator/(F4 a, F4 b) { return map(a, b, [](float x, float y) { return x / y; }); }
+        inline F4 vsqrt(F4 a) { return map(a, a, [](float x, float) { return std::sqrt(x); }); }
+        inline F4 vmin(F4 a, F4 b) { return map(a, b, [](float x, float y) { return x < y ? x : y; }); }
+        inline F4 vmax(F4 a, F4 b) { return map(a, b, [](float x, float y) { return x > y ? x : y; }); }
+        inline F4 operator<(F4 a, F4 b) { return map(a, b, [](float x, float y) { return x < y ? 1.0f : 0.0f; }); }
+        inline F4 operator>(F4 a, F4 b) { return map(a, b, [](float x, float y) { return x > y ? 1.0f : 0.0f; }); }
+        inline F4 operator&(F4 a, F4 b) { return map(a, b, [](float x, float y) { return x != 0.0f && y != 0.0f ? 1.0f : 0.0f; }); }
+        inline F4 select(F4 m, F4 a, F4 b) {
+            F4 r;
+            for (int i = 0; i < 4; i++) r.v[i] = m.v[i] != 0.0f ? a.v[i] : b.v[i];
+            return r;
+        }
+        inline int movemask(F4 m) {
+            int b = 0;
+            for (int i = 0; i < 4; i++) b |= int(m.v[i] != 0.0f) << i;
+            return b;
+        }
+#endif
+
+        inline F4 operator+(F4 a, float b) { return a + set1(b); }
+        inline F4 operator-(F4 a, float b) { return a - set1(b); }
+        inline F4 operator*(F4 a, float b) { return a * set1(b); }
+        inline F4 operator+(float a, F4 b) { return set1(a) + b; }
+        inline F4 operator-(float a, F4 b) { return set1(a) - b; }
+        inline F4 operator*(float a, F4 b) { return set1(a) * b; }
+        inline F4 operator/(float a, F4 b) { return set1(a) / b; }
+        inline F4 vabs(F4 a) { return vmax(a, set1(0.0f) - a); }
+
+        // Partial blocks go through a padded stack copy.
+        inline F4 load(const float *p, size_t n, float pad) {
+            if (n == 4) return loadu(p);
+            float t[4] = {pad, pad, pad, pad};
+            for (size_t i = 0; i < n; i++) t[i] = p[i];
+            return loadu(t);
+        }
+
+        inline void store(float *p, F4 a, size_t n) {
+            if (n == 4) return storeu(p, a);
+            float t[4];
+            storeu(t, a);
+            for (size_t i = 0; i < n; i++) p[i] = t[i];
+        }
+
+        inline void storeMask(uint8_t *p, F4 m, size_t n) {
+            const int bits = movemask(m);
+            for (size_t i = 0; i < n; i++) p[i] = uint8_t((bits >> i) & 1);
+        }
+
+        template <class Kernel>
+        inline void forEachBlock(size_t n, Kernel &&kernel) {
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) kernel(i, size_t(4));
+            if (i < n) kernel(i, n - i);
+        }
+
+        constexpr float PI = float(CV_PI);
+
+        // atan(x) for x >= 0 (+inf allowed), Cephes atanf range reduction and polynomial.
+        inline F4 atanPositive(F4 x) {
+            const F4 big = x > set1(2.414213562373095f), mid = x > set1(0.4142135623730950f);
+            const F4 y0 = select(big, set1(PI / 2.0f), select(mid, set1(PI / 4.0f), set1(0.0f)));
+            const F4 xr = select(big, -1.0f / x, select(mid, (x - 1.0f) / (x + 1.0f), x));
+            const F4 z = xr * xr;
+            const F4 p = (((z * 8.05374449538e-2f - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z;
+            return y0 + p * xr + xr;
+        }
+
+        // sin and cos for t within [0, pi], Taylor series on [0, pi/2].
+        inline void sinCos(F4 t, F4 &s, F4 &c) {
+            const F4 upper = t > set1(PI / 2.0f);
+            const F4 x = select(upper, PI - t, t);
+            const F4 x2 = x * x;
+            s = x * (1.0f + x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f + x2 * (-1.0f / 5040.0f + x2 * (1.0f / 362880.0f + x2 * (-1.0f / 39916800.0f))))));
+            const F4 cr = 1.0f + x2 * (-0.5f + x2 * (1.0f / 24.0f + x2 * (-1.0f / 720.0f + x2 * (1.0f / 40320.0f + x2 * (-1.0f / 3628800.0f + x2 * (1.0f / 479001600.0f))))));
+            c = select(upper, 0.0f - cr, cr);
+        }
+
+        struct Intrinsics {
+            float fx, fy, cx, cy, ifx, ify;
+
+            explicit Intrinsics(const CameraIntrinsic &cI)
+                : fx(float(cI.fx)), fy(float(cI.fy)), cx(float(cI.cx)), cy(float(cI.cy)), ifx(float(1.0 / cI.fx)), ify(float(1.0 / cI.fy)) {}
+        };
+
+        inline void resizeOutputs(size_t n, Points2 &uv, ProjectionJacobians *J, std::vector<uint8_t> &valid) {
+            uv.resize(n);
+            valid.resize(n);
+            if (J) J->resize(n);
+        }
+
+        inline void storeJacobian(ProjectionJacobians &J, size_t i, size_t n, F4 ux, F4 uy, F4 uz, F4 vx, F4 vy, F4 vz) {
+            store(J.du_dx.data() + i, ux, n);
+            store(J.du_dy.data() + i, uy, n);
+            store(J.du_dz.data() + i, uz, n);
+            store(J.dv_dx.data() + i, vx, n);
+            store(J.dv_dy.data() + i, vy, n);
+            store(J.dv_dz.data() + i, vz, n);
+        }
+
+        // ------------------ Kernels ------------------
+
+        struct RadTan {
+            float k1, k2, k3, k4, k5, k6, p1, p2;
+
+            explicit RadTan(const CameraDistortion &d)
+                : k1(float(d.k1)), k2(float(d.k2)), k3(float(d.k3)), k4(float(d.k4)), k5(float(d.k5)), k6(float(d.k6)),
+                  p1(float(d.p1)), p2(float(d.p2)) {}
+
+            // Distorted normalized coordinates and their 2x2 Jacobian (symmetric off-diagonal).
+            inline void distort(F4 xn, F4 yn, F4 &xd, F4 &yd, F4 &a00, F4 &a01, F4 &a11) const {
+                const F4 r2 = xn * xn + yn * yn, xy = xn * yn;
+
+                // Rational radial term and its derivative w.r.t. r2, the denominator is 1 without k4..k6.
+                const F4 num = 1.0f + r2 * (k1 + r2 * (k2 + r2 * k3));
+                const F4 den = 1.0f + r2 * (k4 + r2 * (k5 + r2 * k6));
+                const F4 iden = 1.0f / den;
+                const F4 radial = num * iden;
+                const F4 dR = (k1 + r2 * (2.0f * k2 + r2 * (3.0f * k3)) - radial * (k4 + r2 * (2.0f * k5 + r2 * (3.0f * k6)))) * iden;
+
+                xd = xn * radial + (2.0f * p1) * xy + p2 * (r2 + 2.0f * xn * xn);
+                yd = yn * radial + p1 * (r2 + 2.0f * yn * yn) + (2.0f * p2) * xy;
+                a00 = radial + 2.0f * xn * xn * dR + (2.0f * p1) * yn + (6.0f * p2) * xn;
+                a01 = 2.0f * xy * dR + (2.0f * p1) * xn + (2.0f * p2) * yn;
+                a11 = radial + 2.0f * yn * yn * dR + (6.0f * p1) * yn + (2.0f * p2) * xn;
+            }
+        };
+
+        template <bool Jacobian>
+        void projectRadTan(const Intrinsics &in, const RadTan &d, const Points3 &p, Points2 &uv, ProjectionJacobians *J,
+            std::vector<uint8_t> &valid) {
+            resizeOutputs(p.size(), uv, J, valid);
+            forEachBlock(p.size(), [&](size_t i, size_t n) {
+                const F4 x = load(p.x.data() + i, n, 0.0f), y = load(p.y.data() + i, n, 0.0f), z = load(p.z.data() + i, n, 1.0f);
+                const F4 ok = z > set1(1e-6f);
+                const F4 iz = 1.0f / select(ok, z, set1(1.0f));
+                const F4 xn = x * iz, yn = y * iz;
+
+                F4 xd, yd, a00, a01, a11;
+                d.distort(xn, yn, xd, yd, a00, a01, a11);
+                store(uv.u.data() + i, xd * in.fx + in.cx, n);
+                store(uv.v.data() + i, yd * in.fy + in.cy, n);
+                storeMask(valid.data() + i, ok, n);
+
+                if constexpr (Jacobian) {
+                    // d(xn, yn)/d(x, y, z) = [1 0 -xn; 0 1 -yn] / z
+                    const F4 fxz = in.fx * iz, fyz = in.fy * iz;
+                    storeJacobian(*J, i, n, fxz * a00, fxz * a01, set1(0.0f) - fxz * (a00 * xn + a01 * yn),
+                        fyz * a01, fyz * a11, set1(0.0f) - fyz * (a01 * xn + a11 * yn));
+                }
+            });
+        }
+
+        struct Fisheye {
+            float k1, k2, k3, k4, maxTheta;
+
+            inline F4 distort(F4 theta) const {
+                const F4 t2 = theta * theta;
+                return theta * (1.0f + t2 * (k1 + t2 * (k2 + t2 * (k3 + t2 * k4))));
+            }
+
+            inline F4 derivative(F4 theta) const {
+                const F4 t2 = theta * theta;
+                return 1.0f + t2 * (3.0f * k1 + t2 * (5.0f * k2 + t2 * (7.0f * k3 + t2 * (9.0f * k4))));
+            }
+        };
+
+        template <bool Jacobian>
+        void projectFisheye(const Intrinsics &in, const Fisheye &d, const Points3 &p, Points2 &uv, ProjectionJacobians *J,
+            std::vector<uint8_t> &valid) {
+            resizeOutputs(p.size(), uv, J, valid);
+            forEachBlock(p.size(), [&](size_t i, size_t n) {
+                const F4 x = load(p.x.data() + i, n, 0.0f), y = load(p.y.data() + i, n, 0.0f), z = load(p.z.data() + i, n, 1.0f);
+                const F4 r2 = x * x + y * y, R2 = r2 + z * z;
+                const F4 r = vsqrt(r2);
+
+                // Incidence angle, atan2(r, z) for r >= 0.
+                const F4 a = atanPositive(r / vabs(z));
+                const F4 theta = select(z < set1(0.0f), PI - a, a);
+                const F4 thetad = d.distort(theta);
+
+                // Close to the axis thetad / r tends to 1 / z. Behind the camera (theta near pi)
+                // the image radius is not small, so those lanes are invalid whatever the fov.
+                const F4 small = r < vabs(z) * 1e-6f;
+                const F4 rs = select(small, set1(1.0f), r);
+                const F4 s = select(small, 1.0f / select(small, z, set1(1.0f)), thetad / rs);
+                const F4 ok = (theta < set1(d.maxTheta)) & (R2 > set1(0.0f)) & (select(small, z, set1(1.0f)) > set1(0.0f));
+
+                store(uv.u.data() + i, x * s * in.fx + in.cx, n);
+                store(uv.v.data() + i, y * s * in.fy + in.cy, n);
+                storeMask(valid.data() + i, ok, n);
+
+                if constexpr (Jacobian) {
+                    // s = thetad / r: ds/dx = c * x, ds/dy = c * y, ds/dz = -thetad' / R2
+                    const F4 dthetad = d.derivative(theta);
+                    const F4 ir2 = 1.0f / (rs * rs);
+                    const F4 iR2 = 1.0f / select(R2 > set1(0.0f), R2, set1(1.0f));
+                    const F4 c = select(small, set1(0.0f), (dthetad * z * iR2 - thetad / rs) * ir2);
+                    const F4 dsdz = set1(0.0f) - dthetad * iR2;
+                    storeJacobian(*J, i, n, in.fx * (s + x * x * c), in.fx * x * y * c, in.fx * x * dsdz,
+                        in.fy * x * y * c, in.fy * (s + y * y * c), in.fy * y * dsdz);
+                }
+            });
+        }
+
+        struct DoubleSphere {
+            float xi, alpha, w2;
+        };
+
+        template <bool Jacobian>
+        void projectDoubleSphere(const Intrinsics &in, const DoubleSphere &d, const Points3 &p, Points2 &uv, ProjectionJacobians *J,
+            std::vector<uint8_t> &valid) {
+            resizeOutputs(p.size(), uv, J, valid);
+            forEachBlock(p.size(), [&](size_t i, size_t n) {
+                const F4 x = load(p.x.data() + i, n, 0.0f), y = load(p.y.data() + i, n, 0.0f), z = load(p.z.data() + i, n, 1.0f);
+                const F4 xy2 = x * x + y * y;
+                const F4 d1 = vsqrt(xy2 + z * z);
+                const F4 e = d.xi * d1 + z;
+                const F4 d2 = vsqrt(xy2 + e * e);
+                const F4 den = d.alpha * d2 + (1.0f - d.alpha) * e;
+
+                const F4 ok = (z > (0.0f - d.w2) * d1) & (den > set1(1e-9f));
+                const F4 iden = 1.0f / select(ok, den, set1(1.0f));
+                store(uv.u.data() + i, x * iden * in.fx + in.cx, n);
+                store(uv.v.data() + i, y * iden * in.fy + in.cy, n);
+                storeMask(valid.data() + i, ok, n);
+
+                if constexpr (Jacobian) {
+                    const F4 id1 = 1.0f / select(d1 > set1(0.0f), d1, set1(1.0f));
+                    const F4 id2 = 1.0f / select(d2 > set1(0.0f), d2, set1(1.0f));
+                    const F4 ex = d.xi * x * id1, ey = d.xi * y * id1, ez = d.xi * z * id1 + 1.0f;
+                    const F4 dx = d.alpha * (x + e * ex) * id2 + (1.0f - d.alpha) * ex;
+                    const F4 dy = d.alpha * (y + e * ey) * id2 + (1.0f - d.alpha) * ey;
+                    const F4 dz = d.alpha * (e * ez) * id2 + (1.0f - d.alpha) * ez;
+                    const F4 fx2 = in.fx * iden * iden, fy2 = in.fy * iden * iden;
+                    storeJacobian(*J, i, n, fx2 * (den - x * dx), set1(0.0f) - fx2 * x * dy, set1(0.0f) - fx2 * x * dz,
+                        set1(0.0f) - fy2 * y * dx, fy2 * (den - y * dy), set1(0.0f) - fy2 * y * dz);
+                }
+            });
+        }
+
+    } // namespace
+
+    // ------------------ PinholeRadTanModel ------------------
+
+    PinholeRadTanModel::PinholeRadTanModel(const CameraIntrinsic &cI_, const CameraDistortion &cD_) : ProjectionModel(cI_), cD(cD_) {
+        D = cD.getD();
+    }
+
+    void PinholeRadTanModel::project(const Points3 &p, Points2 &uv, std::vector<uint8_t> &valid) const {
+        projectRadTan<false>(Intrinsics(cI), RadTan(cD), p, uv, nullptr, valid);
+    }
+
+    void PinholeRadTanModel::projectJacobian(const Points3 &p, Points2 &uv, ProjectionJacobians &J, std::vector<uint8_t> &valid) const {
+        projectRadTan<true>(Intrinsics(cI), RadTan(cD), p, uv, &J, valid);
+    }
+
+    void PinholeRadTanModel::unproject(const Points2 &uv, Points3 &rays, std::vector<uint8_t> &valid) const {
+        const Intrinsics in(cI);
+        const RadTan d(cD);
+
+        rays.resize(uv.size());
+        valid.resize(uv.size());
+        forEachBlock(uv.size(), [&](size_t i, size_t n) {
+            const F4 mx = (load(uv.u.data() + i, n, 0.0f) - in.cx) * in.ifx;
+            const F4 my = (load(uv.v.data() + i, n, 0.0f) - in.cy) * in.ify;
+
+            // Gauss-Newton on distort(xn, yn) = (mx, my), starting from the distorted point.
+            F4 xn = mx, yn = my, xd, yd, a00, a01, a11;
+            for (int it = 0; it < 6; it++) {
+                d.distort(xn, yn, xd, yd, a00, a01, a11);
+                const F4 ex = xd - mx, ey = yd - my;
+                const F4 idet = 1.0f / (a00 * a11 - a01 * a01);
+                xn = xn - (a11 * ex - a01 * ey) * idet;
+                yn = yn - (a00 * ey - a01 * ex) * idet;
+            }
+            d.distort(xn, yn, xd, yd, a00, a01, a11);
+            const F4 ex = xd - mx, ey = yd - my;
+            const F4 ok = ex * ex + ey * ey < set1(1e-8f);
+
+            const F4 norm = 1.0f / vsqrt(xn * xn + yn * yn + 1.0f);
+            store(rays.x.data() + i, xn * norm, n);
+            store(rays.y.data() + i, yn * norm, n);
+            store(rays.z.data() + i, norm, n);
+            storeMask(valid.data() + i, ok, n);
+        });
+    }
+
+    // ------------------ FisheyeModel ------------------
+
+    FisheyeModel::FisheyeModel(const CameraIntrinsic &cI_, double k1_, double k2_, double k3_, double k4_, double fov)
+        : ProjectionModel(cI_), k1(k1_), k2(k2_), k3(k3_), k4(k4_), maxTheta(std::min(fov, 360.0) * CV_PI / 360.0) {
+        D = (cv::Mat_<double>(1, 4) << k1, k2, k3, k4);
+    }
+
+    void FisheyeModel::project(const Points3 &p, Points2 &uv, std::vector<uint8_t> &valid) const {
+        projectFisheye<false>(Intrinsics(cI), {float(k1), float(k2), float(k3), float(k4), float(maxTheta)}, p, uv, nullptr, valid);
+    }
+
+    void FisheyeModel::projectJacobian(const Points3 &p, Points2 &uv, ProjectionJacobians &J, std::vector<uint8_t> &valid) const {
+        projectFisheye<true>(Intrinsics(cI), {float(k1), float(k2), float(k3), float(k4), float(maxTheta)}, p, uv, &J, valid);
+    }
+
+    void FisheyeModel::unproject(const Points2 &uv, Points3 &rays, std::vector<uint8_t> &valid) const {
+        const Intrinsics in(cI);
+        const Fisheye d{float(k1), float(k2), float(k3), float(k4), float(maxTheta)};
+
+        rays.resize(uv.size());
+        valid.resize(uv.size());
+        forEachBlock(uv.size(), [&](size_t i, size_t n) {
+            const F4 mx = (load(uv.u.data() + i, n, 0.0f) - in.cx) * in.ifx;
+            const F4 my = (load(uv.v.data() + i, n, 0.0f) - in.cy) * in.ify;
+            const F4 thetad = vsqrt(mx * mx + my * my);
+
+            // Newton on distort(theta) = thetad.
+            F4 theta = thetad;
+            for (int it = 0; it < 8; it++) {
+                theta = theta - (d.distort(theta) - thetad) / d.derivative(theta);
+                theta = vmin(vmax(theta, set1(0.0f)), set1(PI));
+            }
+            const F4 residual = vabs(d.distort(theta) - thetad);
+            const F4 ok = (residual < set1(1e-5f)) & (theta < set1(d.maxTheta)) & (d.derivative(theta) > set1(0.0f));
+
+            F4 s, c;
+            sinCos(theta, s, c);
+            const F4 small = thetad < set1(1e-8f);
+            const F4 scale = select(small, set1(1.0f), s / select(small, set1(1.0f), thetad));
+            store(rays.x.data() + i, mx * scale, n);
+            store(rays.y.data() + i, my * scale, n);
+            store(rays.z.data() + i, c, n);
+            storeMask(valid.data() + i, ok, n);
+        });
+    }
+
+    // ------------------ DoubleSphereModel ------------------
+
+    static DoubleSphere doubleSphere(double xi, double alpha) {
+        // Projection is defined for z > -w2 * |p|.
+        const double w1 = alpha <= 0.5 ? alpha / (1.0 - alpha) : (1.0 - alpha) / alpha;
+        const double w2 = (w1 + xi) / std::sqrt(2.0 * w1 * xi + xi * xi + 1.0);
+        return {float(xi), float(alpha), float(w2)};
+    }
+
+    void DoubleSphereModel::project(const Points3 &p, Points2 &uv, std::vector<uint8_t> &valid) const {
+        projectDoubleSphere<false>(Intrinsics(cI), doubleSphere(xi, alpha), p, uv, nullptr, valid);
+    }
+
+    void DoubleSphereModel::projectJacobian(const Points3 &p, Points2 &uv, ProjectionJacobians &J, std::vector<uint8_t> &valid) const {
+        projectDoubleSphere<true>(Intrinsics(cI), doubleSphere(xi, alpha), p, uv, &J, valid);
+    }
+
+    void DoubleSphereModel::unproject(const Points2 &uv, Points3 &rays, std::vector<uint8_t> &valid) const {
+        const Intrinsics in(cI);
+        const float fxi = float(xi), fa = float(alpha);
+
+        // Unprojection is defined for r^2 <= 1 / (2 alpha - 1) when alpha > 0.5.
+        const float maxR2 = alpha > 0.5 ? float(1.0 / (2.0 * alpha - 1.0)) : std::numeric_limits<float>::max();
+
+        rays.resize(uv.size());
+        valid.resize(uv.size());
+        forEachBlock(uv.size(), [&](size_t i, size_t n) {
+            const F4 mx = (load(uv.u.data() + i, n, 0.0f) - in.cx) * in.ifx;
+            const F4 my = (load(uv.v.data() + i, n, 0.0f) - in.cy) * in.ify;
+            const F4 r2 = mx * mx + my * my;
+            const F4 ok = r2 < set1(maxR2);
+
+            const F4 mz = (1.0f - (fa * fa) * r2) / (fa * vsqrt(vmax(1.0f - (2.0f * fa - 1.0f) * r2, set1(0.0f))) + (1.0f - fa));
+            const F4 mz2 = mz * mz;
+            const F4 k = (mz * fxi + vsqrt(vmax(mz2 + (1.0f - fxi * fxi) * r2, set1(0.0f)))) / (mz2 + r2);
+
+            store(rays.x.data() + i, k * mx, n);
+            store(rays.y.data() + i, k * my, n);
+            store(rays.z.data() + i, k * mz - fxi, n);
+            storeMask(valid.data() + i, ok, n);
+        });
+    }
+
+} // namespace StringSLAM
@@ -0,0 +1,294 @@
+#include <StringSLAM/core/CompactMap.hpp>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace StringSLAM
+{
+    namespace
+    {
+        constexpr size_t WIDTH = DescriptorArena::WIDTH;
+
+        inline void putVarint(std::vector<uint8_t> &out, uint32_t v) {
+            while (v >= 0x80) {
+                out.push_back(uint8_t(v | 0x80));
+                v >>= 7;
+            }
+            out.push_back(uint8_t(v));
+        }
+
+        inline uint32_t getVarint(const uint8_t *&p) {
+            uint32_t v = 0;
+            for (int shift = 0;; shift += 7) {
+                const uint8_t b = *p++;
+                v |= uint32_t(b & 0x7f) << shift;
+                if (!(b & 0x80)) return v;
+            }
+        }
+
+        // Signed deltas with small magnitude become small unsigned values.
+        inline uint32_t zigzag(int32_t v) { return (uint32_t(v) << 1) ^ uint32_t(v >> 31); }
+        inline int32_t unzigzag(uint32_t v) { return int32_t(v >> 1) ^ -int32_t(v & 1); }
+
+        inline uint64_t hashDescriptor(const uint8_t *d) {
+            uint64_t w[WIDTH / 8];
+            std::memcpy(w, d, WIDTH);
+            uint64_t h = 0;
+            for (uint64_t x : w) h = (h ^ x) * 0x9E3779B97F4A7C15ULL;
+            return h;
+        }
+
+        struct CellHash {
+            size_t operator()(const std::array<int32_t, 3> &c) const {
+                return (size_t(uint32_t(c[0])) * 73856093u) ^ (size_t(uint32_t(c[1])) * 19349663u) ^ (size_t(uint32_t(c[2])) * 83492791u);
+            }
+        };
+    } // namespace
+
+    CompactMap::CompactMap(double resolution_) : resolution(resolution_ > 0.0 ? resolution_ : 0.001) {}
+
+    void CompactMap::clear() {
+        cellSize = 65534.0 * resolution;
+        cells.clear();
+        landmarkCount = 0;
+        positions.clear();
+        landmarkCell.clear();
+        observations.clear();
+        blockOffset.clear();
+        descriptors.clear();
+        hasDescriptor.clear();
+        keyframes.clear();
+        keypoints.clear();
+        keypointDescriptor.clear();
+    }
+
+    bool CompactMap::build(const Map &map) {
+        clear();
+        const auto &landmarks = map.getLandmarks();
+        const DescriptorArena &arena = *map.getDescriptorArena();
+        landmarkCount = landmarks.size();
+
+        // Exact deduplication of descriptor rows.
+        std::unordered_multimap<uint64_t, uint32_t> rows;
+        auto addRow = [&](const uint8_t *d) {
+            const uint64_t h = hashDescriptor(d);
+            auto range = rows.equal_range(h);
+            for (auto it = range.first; it != range.second; ++it)
+                if (std::memcmp(&descriptors[size_t(it->second) * WIDTH], d, WIDTH) == 0) return it->second;
+            const uint32_t row = uint32_t(descriptors.size() / WIDTH);
+            descriptors.insert(descriptors.end(), d, d + WIDTH);
+            rows.emplace(h, row);
+            return row;
+        };
+
+        descriptors.assign(landmarkCount * WIDTH, 0);
+        hasDescriptor.assign(landmarkCount, false);
+        positions.reserve(3 * landmarkCount);
+        landmarkCell.reserve(landmarkCount);
+
+        std::unordered_map<std::array<int32_t, 3>, uint16_t, CellHash> cellIndex;
+        size_t i = 0;
+        int prevFirst = 0;
+        for (auto &[id, lm] : landmarks) {
+            if (id != int(i)) {
+                clear();
+                return false;
+            }
+
+            // Position relative to the center of its submap cell.
+            const double p[3] = {lm.pos.x, lm.pos.y, lm.pos.z};
+            std::array<int32_t, 3> cell;
+            for (int k = 0; k < 3; k++) cell[k] = int32_t(std::floor(p[k] / cellSize));
+            auto c = cellIndex.find(cell);
+            if (c == cellIndex.end()) {
+                if (cells.size() >= std::numeric_limits<uint16_t>::max()) {
+                    clear();
+                    return false;
+                }
+                c = cellIndex.emplace(cell, uint16_t(cells.size())).first;
+                cells.push_back(cell);
+            }
+            landmarkCell.push_back(c->second);
+            for (int k = 0; k < 3; k++) {
+                const double q = std::round((p[k] - (cell[k] + 0.5) * cellSize) / resolution);
+                positions.push_back(int16_t(std::clamp(q, -32767.0, 32767.0)));
+            }
+
+            // Observations, the first one relative to the previous landmark's, then to each other.
+            if (i % BLOCK == 0) {
+                blockOffset.push_back(uint32_t(observations.size()));
+                prevFirst = 0;
+            }
+            putVarint(observations, uint32_t(lm.observations.size()));
+            int prev = prevFirst;
+            for (int o : lm.observations) {
+                putVarint(observations, zigzag(o - prev));
+                prev = o;
+            }
+            if (!lm.observations.empty()) prevFirst = lm.observations.front();
+
+            if (arena.valid(lm.descriptor)) {
+                std::memcpy(&descriptors[i * WIDTH], arena.get(lm.descriptor), WIDTH);
+                hasDescriptor[i] = true;
+                rows.emplace(hashDescriptor(arena.get(lm.descriptor)), uint32_t(i));
+            }
+            i++;
+        }
+
+        // Fixed point keypoints, the finest step that fits 16 bits.
+        const auto &kfs = map.getKeyframes();
+        float maxCoord = 0.0f;
+        size_t kpTotal = 0;
+        for (auto &[id, kf] : kfs) {
+            kpTotal += kf.kp.size();
+            for (auto &k : kf.kp) maxCoord = std::max({maxCoord, k.pt.x, k.pt.y});
+        }
+        keypointScale = 8.0f;
+        while (keypointScale > 1.0f && maxCoord * keypointScale > 65535.0f) keypointScale *= 0.5f;
+        keypoints.reserve(2 * kpTotal);
+        keypointDescriptor.reserve(kpTotal);
+
+        keyframes.reserve(kfs.size());
+        for (auto &[id, kf] : kfs) {
+            Keyframe k;
+            k.id = id;
+            k.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(kf.timestamp.time_since_epoch()).count();
+            const Eigen::Quaterniond q(kf.pose.rotation());
+            k.q[0] = float(q.w());
+            k.q[1] = float(q.x());
+            k.q[2] = float(q.y());
+            k.q[3] = float(q.z());
+            const Eigen::Vector3d t = kf.pose.translation();
+            for (int a = 0; a < 3; a++) k.t[a] = t(a);
+            k.kpBegin = uint32_t(keypointDescriptor.size());
+            k.kpCount = uint32_t(kf.kp.size());
+
+            for (size_t j = 0; j < kf.kp.size(); j++) {
+                const cv::Point2f &pt = kf.kp[j].pt;
+                keypoints.push_back(uint16_t(std::clamp(std::round(pt.x * keypointScale), 0.0f, 65535.0f)));
+                keypoints.push_back(uint16_t(std::clamp(std::round(pt.y * keypointScale), 0.0f, 65535.0f)));
+                const bool has = j < kf.descIdx.size() && arena.valid(kf.descIdx[j]);
+                keypointDescriptor.push_back(has ? addRow(arena.get(kf.descIdx[j])) : NONE);
+            }
+            keyframes.push_back(k);
+        }
+
+        positions.shrink_to_fit();
+        landmarkCell.shrink_to_fit();
+        observations.shrink_to_fit();
+        descriptors.shrink_to_fit();
+        return true;
+    }
+
+    cv::Point3f CompactMap::decodePosition(size_t i) const {
+        const std::array<int32_t, 3> &cell = cells[landmarkCell[i]];
+        float p[3];
+        for (int k = 0; k < 3; k++) p[k] = float((cell[k] + 0.5) * cellSize + positions[3 * i + size_t(k)] * resolution);
+        return cv::Point3f(p[0], p[1], p[2]);
+    }
+
+    size_t CompactMap::seekObservations(size_t i, int &prevFirst) const {
+        // Walk from the start of the block, where the first observation deltas restart.
+        const size_t first = i / BLOCK * BLOCK;
+        const uint8_t *p = observations.data() + blockOffset[i / BLOCK];
+        prevFirst = 0;
+        for (size_t j = first; j < i; j++) {
+            const uint32_t n = getVarint(p);
+            int prev = prevFirst;
+            for (uint32_t k = 0; k < n; k++) {
+                prev += unzigzag(getVarint(p));
+                if (k == 0) prevFirst = prev;
+            }
+        }
+        return size_t(p - observations.data());
+    }
+
+    bool CompactMap::getLandmark(int id, cv::Point3f &pos, std::vector<int> &obs) const {
+        if (id < 0 || size_t(id) >= landmarkCount) return false;
+        pos = decodePosition(size_t(id));
+
+        int prev;
+        const uint8_t *p = observations.data() + seekObservations(size_t(id), prev);
+        const uint32_t n = getVarint(p);
+        obs.resize(n);
+        for (uint32_t k = 0; k < n; k++) {
+            prev += unzigzag(getVarint(p));
+            obs[k] = prev;
+        }
+        return true;
+    }
+
+    const uint8_t *CompactMap::getDescriptor(int id) const {
+        if (id < 0 || size_t(id) >= landmarkCount || !hasDescriptor[size_t(id)]) return nullptr;
+        return &descriptors[size_t(id) * WIDTH];
+    }
+
+    bool CompactMap::restore(Map &map) const {
+        if (!map.getKeyframes().empty() || !map.getLandmarks().empty()) return false;
+
+        // First keyframe keypoint holding each landmark representative, so the Map can share it.
+        std::vector<std::pair<int, int>> source(landmarkCount, {-1, -1});
+        for (const Keyframe &k : keyframes) {
+            Frame f;
+            f.id = k.id;
+            f.timestamp = std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(k.timestamp)));
+            const Eigen::Quaterniond q(k.q[0], k.q[1], k.q[2], k.q[3]);
+            f.pose = SE3(q.normalized().toRotationMatrix(), Eigen::Vector3d(k.t[0], k.t[1], k.t[2]));
+
+            f.kp.resize(k.kpCount);
+            bool anyDescriptor = false;
+            for (uint32_t j = 0; j < k.kpCount; j++) {
+                const size_t idx = size_t(k.kpBegin + j);
+                f.kp[j] = cv::KeyPoint(keypoints[2 * idx] / keypointScale, keypoints[2 * idx + 1] / keypointScale, 31.0f);
+                anyDescriptor |= keypointDescriptor[idx] != NONE;
+            }
+
+            if (anyDescriptor) {
+                f.desc.create(int(k.kpCount), int(WIDTH), CV_8U);
+                for (uint32_t j = 0; j < k.kpCount; j++) {
+                    const uint32_t row = keypointDescriptor[size_t(k.kpBegin + j)];
+                    uint8_t *d = f.desc.ptr<uint8_t>(int(j));
+                    if (row == NONE) {
+                        std::memset(d, 0, WIDTH);
+                        continue;
+                    }
+                    std::memcpy(d, &descriptors[size_t(row) * WIDTH], WIDTH);
+                    if (row < landmarkCount && source[row].first < 0) source[row] = {k.id, int(j)};
+                }
+            }
+            map.addKeyframe(f);
+        }
+
+        const uint8_t *p = observations.data();
+        int prevFirst = 0;
+        for (size_t i = 0; i < landmarkCount; i++) {
+            if (i % BLOCK == 0) prevFirst = 0;
+            MapPoint mp;
+            mp.pos = decodePosition(i);
+            mp.observations.resize(getVarint(p));
+            int prev = prevFirst;
+            for (auto &o : mp.observations) {
+                prev += unzigzag(getVarint(p));
+                o = prev;
+            }
+            if (!mp.observations.empty()) prevFirst = mp.observations.front();
+
+            if (hasDescriptor[i] && source[i].first >= 0) map.addLandmark(mp, source[i].first, source[i].second);
+            else map.addLandmark(mp, hasDescriptor[i] ? &descriptors[i * WIDTH] : nullptr);
+        }
+        return true;
+    }
+
+    MapMemory CompactMap::getMemoryUsage() const {
+        MapMemory m;
+        m.landmarks = landmarkCount;
+        m.keyframes = keyframes.size();
+        m.landmarkBytes = positions.size() * sizeof(int16_t) + landmarkCell.size() * sizeof(uint16_t) + observations.size() +
+            blockOffset.size() * sizeof(uint32_t) + landmarkCount * WIDTH + (landmarkCount + 7) / 8 + cells.size() * sizeof(cells[0]);
+        m.keyframeBytes = keyframes.size() * sizeof(Keyframe) + keypoints.size() * sizeof(uint16_t) +
+            keypointDescriptor.size() * sizeof(uint32_t) + (descriptors.size() - landmarkCount * WIDTH);
+        return m;
+    }
+
+} // namespace StringSLAM
@@ -0,0 +1,147 @@
+#include <StringSLAM/core/DescriptorArena.hpp>
+#include <StringSLAM/core/Kernels.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace StringSLAM
+{
+    static inline void prefetch(const uint8_t *p) {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(p);
+#else
+        (void)p;
+#endif
+    }
+
+    void DescriptorArena::AlignedFree::operator()(uint8_t *p) const {
+        std::free(p);
+    }
+
+    DescriptorArena::DescriptorArena(size_t reserve_) {
+        if (reserve_) reserveSlots(reserve_);
+    }
+
+    void DescriptorArena::reserveSlots(size_t n) {
+        if (n <= capacity) return;
+
+        // Grow geometrically so appending is amortized O(1).
+        size_t newCapacity = std::max<size_t>(std::max(n, capacity * 2), 64);
+        uint8_t *p = static_cast<uint8_t *>(std::aligned_alloc(ALIGN, newCapacity * WIDTH));
+        if (!p) throw std::bad_alloc();
+
+        if (used) std::memcpy(p, data.get(), used * WIDTH);
+        data.reset(p);
+        capacity = newCapacity;
+    }
+
+    DescriptorArena::Index DescriptorArena::allocate() {
+        if (!freeSlots.empty()) {
+            Index i = freeSlots.back();
+            freeSlots.pop_back();
+            live[i] = true;
+            return i;
+        }
+
+        reserveSlots(used + 1);
+        live.push_back(true);
+        return Index(used++);
+    }
+
+    DescriptorArena::Index DescriptorArena::add(const uint8_t *d) {
+        Index i = allocate();
+        std::memcpy(data.get() + size_t(i) * WIDTH, d, WIDTH);
+        return i;
+    }
+
+    bool DescriptorArena::add(const cv::Mat &desc, std::vector<Index> &out) {
+        out.clear();
+        if (desc.empty()) return true;
+        if (desc.depth() != CV_8U || size_t(desc.cols) * desc.elemSize() != WIDTH) return false;
+
+        out.reserve(desc.rows);
+        reserveSlots(used + desc.rows);
+        for (int r = 0; r < desc.rows; r++) out.push_back(add(desc.ptr<uint8_t>(r)));
+        return true;
+    }
+
+    DescriptorArena::Index DescriptorArena::copy(Index i) {
+        if (!valid(i)) return INVALID;
+
+        // allocate() may move the buffer, so resolve the source afterwards.
+        Index j = allocate();
+        std::memcpy(data.get() + size_t(j) * WIDTH, data.get() + size_t(i) * WIDTH, WIDTH);
+        return j;
+    }
+
+    void DescriptorArena::set(Index i, const uint8_t *d) {
+        if (!valid(i)) return;
+        std::memcpy(data.get() + size_t(i) * WIDTH, d, WIDTH);
+    }
+
+    void DescriptorArena::release(Index i) {
+        if (!valid(i)) return;
+        live[i] = false;
+        freeSlots.push_back(i);
+    }
+
+    cv::Mat DescriptorArena::view(Index begin, size_t count) const {
+        if (size_t(begin) + count > used || count == 0) return cv::Mat();
+        return cv::Mat(int(count), int(WIDTH), CV_8UC1, const_cast<uint8_t *>(get(begin)), WIDTH);
+    }
+
+    int DescriptorArena::distance(const uint8_t *a, const uint8_t *b) {
+        return getHammingKernels().distance(a, b);
+    }
+
+    void DescriptorArena::distances(const uint8_t *q, Index begin, size_t count, int *out) const {
+        if (size_t(begin) + count > used) count = used > begin ? used - begin : 0;
+        if (count) getHammingKernels().distances(q, get(begin), count, out);
+    }
+
+    void DescriptorArena::nearest(const uint8_t *q, const Index *candidates, size_t n, Index &best, int &bestDist, int &secondDist) const {
+        best = INVALID;
+        bestDist = secondDist = std::numeric_limits<int>::max();
+
+        // Look a few slots ahead so gathered candidates are in cache when needed.
+        constexpr size_t AHEAD = 4;
+        const auto hamming = getHammingKernels().distance;
+        for (size_t k = 0; k < n; k++) {
+            if (k + AHEAD < n && candidates[k + AHEAD] < used) prefetch(get(candidates[k + AHEAD]));
+
+            const Index i = candidates[k];
+            if (!valid(i)) continue;
+
+            const int d = hamming(q, get(i));
+            if (d < bestDist) {
+                secondDist = bestDist;
+                bestDist = d;
+                best = i;
+            } else if (d < secondDist) {
+                secondDist = d;
+            }
+        }
+    }
+
+    void DescriptorArena::match(const cv::Mat &query, const std::vector<Index> &candidates, std::vector<cv::DMatch> &matches,
+        int maxDistance, float ratio) const {
+        matches.clear();
+        if (query.empty() || query.depth() != CV_8U || size_t(query.cols) * query.elemSize() != WIDTH) return;
+
+        // Query rows are copied to an aligned slot once instead of per comparison.
+        alignas(ALIGN) uint8_t q[WIDTH];
+        for (int r = 0; r < query.rows; r++) {
+            std::memcpy(q, query.ptr<uint8_t>(r), WIDTH);
+
+            Index best;
+            int bestDist, secondDist;
+            nearest(q, candidates.data(), candidates.size(), best, bestDist, secondDist);
+
+            if (best == INVALID || bestDist > maxDistance) continue;
+            if (secondDist != std::numeric_limits<int>::max() && bestDist >= ratio * secondDist) continue;
+            matches.emplace_back(r, int(best), float(bestDist));
+        }
+    }
+
+} // namespace StringSLAM
@@ -0,0 +1,269 @@
+#include <StringSLAM/core/Kernels.hpp>
+#include <atomic>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define STRINGSLAM_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__)
+#define STRINGSLAM_NEON_KERNELS
+#include <arm_neon.h>
+#endif
+
+#if defined(__linux__) && (defined(__aarch64__) || defined(__arm__))
+#include <sys/auxv.h>
+#endif
+
+#if defined(__APPLE__) && defined(__aarch64__)
+#include <sys/sysctl.h>
+#endif
+
+namespace StringSLAM
+{
+    namespace
+    {
+        constexpr size_t WIDTH = 32;
+
+        // ------------------ Scalar ------------------
+
+        inline int popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_popcountll(x);
+#else
+            x = x - ((x >> 1) & 0x5555555555555555ULL);
+            x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+            x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+            return int((x * 0x0101010101010101ULL) >> 56);
+#endif
+        }
+
+        int distanceScalar(const uint8_t *a, const uint8_t *b) {
+            uint64_t wa[WIDTH / 8], wb[WIDTH / 8];
+            std::memcpy(wa, a, WIDTH);
+            std::memcpy(wb, b, WIDTH);
+
+            int d = 0;
+            for (size_t k = 0; k < WIDTH / 8; k++) d += popcount64(wa[k] ^ wb[k]);
+            return d;
+        }
+
+        void distancesScalar(const uint8_t *q, const uint8_t *base, size_t count, int *out) {
+            for (size_t k = 0; k < count; k++, base += WIDTH) out[k] = distanceScalar(q, base);
+        }
+
+        // ------------------ x86 ------------------
+
+#ifdef STRINGSLAM_X86_KERNELS
+        __attribute__((target("popcnt"))) int distancePopcnt(const uint8_t *a, const uint8_t *b) {
+            uint64_t wa[WIDTH / 8], wb[WIDTH / 8];
+            std::memcpy(wa, a, WIDTH);
+            std::memcpy(wb, b, WIDTH);
+            return int(__builtin_popcountll(wa[0] ^ wb[0]) + __builtin_popcountll(wa[1] ^ wb[1]) + __builtin_popcountll(wa[2] ^ wb[2]) +
+                __builtin_popcountll(wa[3] ^ wb[3]));
+        }
+
+        __attribute__((target("popcnt"))) void distancesPopcnt(const uint8_t *q, const uint8_t *base, size_t count, int *out) {
+            for (size_t k = 0; k < count; k++, base += WIDTH) out[k] = distancePopcnt(q, base);
+        }
+
+        // Bits per byte through a nibble lookup, then summed per 64-bit lane.
+        __attribute__((target("avx2"))) inline __m256i popcountLanes256(__m256i x) {
+            const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+            const __m256i low = _mm256_set1_epi8(0x0f);
+            const __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lut, _mm256_and_si256(x, low)),
+                _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(x, 4), low)));
+            return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+        }
+
+        __attribute__((target("avx2"))) inline int sumLanes256(__m256i s) {
+            const __m128i h = _mm_add_epi64(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+            return int(_mm_cvtsi128_si64(h) + _mm_extract_epi64(h, 1));
+        }
+
+        __attribute__((target("avx2"))) int distanceAvx2(const uint8_t *a, const uint8_t *b) {
+            const __m256i x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a)),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b)));
+            return sumLanes256(popcountLanes256(x));
+        }
+
+        __attribute__((target("avx2"))) void distancesAvx2(const uint8_t *q, const uint8_t *base, size_t count, int *out) {
+            const __m256i vq = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(q));
+            for (size_t k = 0; k < count; k++, base += WIDTH) {
+                const __m256i x = _mm256_xor_si256(vq, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(base)));
+                out[k] = sumLanes256(popcountLanes256(x));
+            }
+        }
+
+        // Two descriptors per 512-bit register. The vectors are built and reduced through memory:
+        // the 256/512-bit cast and broadcast intrinsics trip GCC's uninitialized warnings at -O2 and up.
+        __attribute__((target("avx512f,avx512bw"))) void distancesAvx512(const uint8_t *q, const uint8_t *base, size_t count, int *out) {
+            // Bits per nibble, little endian dwords of 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4.
+            const __m512i lut = _mm512_set4_epi32(0x04030302, 0x03020201, 0x03020201, 0x02010100);
+            const __m512i low = _mm512_set1_epi8(0x0f);
+
+            alignas(64) uint8_t pair[2 * WIDTH];
+            std::memcpy(pair, q, WIDTH);
+            std::memcpy(pair + WIDTH, q, WIDTH);
+            const __m512i vq = _mm512_load_si512(pair);
+
+            alignas(64) uint64_t lanes[8];
+            size_t k = 0;
+            for (; k + 2 <= count; k += 2, base += 2 * WIDTH) {
+                const __m512i x = _mm512_xor_si512(vq, _mm512_loadu_si512(base));
+                const __m512i cnt = _mm512_add_epi8(_mm512_shuffle_epi8(lut, _mm512_and_si512(x, low)),
+                    _mm512_shuffle_epi8(lut, _mm512_and_si512(_mm512_srli_epi16(x, 4), low)));
+                _mm512_store_si512(lanes, _mm512_sad_epu8(cnt, _mm512_setzero_si512()));
+                out[k] = int(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+                out[k + 1] = int(lanes[4] + lanes[5] + lanes[6] + lanes[7]);
+            }
+            if (k < count) out[k] = distanceAvx2(q, base);
+        }
+#endif
+
+        // ------------------ ARM ------------------
+
+#ifdef STRINGSLAM_NEON_KERNELS
+        inline uint8x16_t countBytes(const uint8_t *a, const uint8_t *b) {
+            return vaddq_u8(vcntq_u8(veorq_u8(vld1q_u8(a), vld1q_u8(b))), vcntq_u8(veorq_u8(vld1q_u8(a + 16), vld1q_u8(b + 16))));
+        }
+
+        int distanceNeon(const uint8_t *a, const uint8_t *b) {
+            return int(vaddlvq_u8(countBytes(a, b)));
+        }
+
+        void distancesNeon(const uint8_t *q, const uint8_t *base, size_t count, int *out) {
+            for (size_t k = 0; k < count; k++, base += WIDTH) out[k] = distanceNeon(q, base);
+        }
+
+#ifdef __ARM_FEATURE_DOTPROD
+        // UDOT against ones sums the byte counts in one instruction.
+        int distanceDotprod(const uint8_t *a, const uint8_t *b) {
+            return int(vaddvq_u32(vdotq_u32(vdupq_n_u32(0), countBytes(a, b), vdupq_n_u8(1))));
+        }
+
+        void distancesDotprod(const uint8_t *q, const uint8_t *base, size_t count, int *out) {
+            for (size_t k = 0; k < count; k++, base += WIDTH) out[k] = distanceDotprod(q, base);
+        }
+#endif
+#endif
+
+        // ------------------ Dispatch ------------------
+
+        // Best first, every entry is only used when the CPU supports it.
+        const HammingKernels TABLES[] = {
+#ifdef STRINGSLAM_X86_KERNELS
+            {IsaLevel::AVX512, distanceAvx2, distancesAvx512},
+            {IsaLevel::AVX2, distanceAvx2, distancesAvx2},
+            {IsaLevel::SSE42, distancePopcnt, distancesPopcnt},
+#endif
+#if defined(STRINGSLAM_NEON_KERNELS) && defined(__ARM_FEATURE_DOTPROD)
+            {IsaLevel::NEON_DOTPROD, distanceDotprod, distancesDotprod},
+#endif
+#ifdef STRINGSLAM_NEON_KERNELS
+            {IsaLevel::NEON, distanceNeon, distancesNeon},
+#endif
+            {IsaLevel::SCALAR, distanceScalar, distancesScalar},
+        };
+
+        std::atomic<const HammingKernels *> active{nullptr};
+
+        int rank(IsaLevel level) {
+            switch (level) {
+            case IsaLevel::SCALAR: return 0;
+            case IsaLevel::SSE42:
+            case IsaLevel::NEON: return 1;
+            case IsaLevel::AVX2:
+            case IsaLevel::NEON_DOTPROD: return 2;
+            case IsaLevel::AVX512: return 3;
+            }
+            return 0;
+        }
+
+        const CpuFeatures &cpuFeatures() {
+            static const CpuFeatures features = CpuFeatures::detect();
+            return features;
+        }
+    } // namespace
+
+    CpuFeatures CpuFeatures::detect() {
+        CpuFeatures f;
+#ifdef STRINGSLAM_X86_KERNELS
+        __builtin_cpu_init();
+        f.sse42 = __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+        f.avx2 = __builtin_cpu_supports("avx2");
+        f.avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#elif defined(__aarch64__)
+        // Advanced SIMD is mandatory on AArch64.
+        f.neon = true;
+#if defined(__linux__)
+#ifndef HWCAP_ASIMDDP
+#define HWCAP_ASIMDDP (1 << 20)
+#endif
+        f.dotprod = (getauxval(AT_HWCAP) & HWCAP_ASIMDDP) != 0;
+#elif defined(__APPLE__)
+        int value = 0;
+        size_t size = sizeof(value);
+        f.dotprod = sysctlbyname("hw.optional.arm.FEAT_DotProd", &value, &size, nullptr, 0) == 0 && value;
+#endif
+#elif defined(__arm__) && defined(__linux__)
+#ifndef HWCAP_NEON
+#define HWCAP_NEON (1 << 12)
+#endif
+        f.neon = (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#endif
+        return f;
+    }
+
+    bool CpuFeatures::supports(IsaLevel level) const {
+        switch (level) {
+        case IsaLevel::SCALAR: return true;
+        case IsaLevel::SSE42: return sse42;
+        case IsaLevel::AVX2: return avx2;
+        case IsaLevel::AVX512: return avx512;
+        case IsaLevel::NEON: return neon;
+        case IsaLevel::NEON_DOTPROD: return neon && dotprod;
+        }
+        return false;
+    }
+
+    IsaLevel CpuFeatures::best() const {
+        for (IsaLevel l : {IsaLevel::AVX512, IsaLevel::AVX2, IsaLevel::NEON_DOTPROD, IsaLevel::SSE42, IsaLevel::NEON})
+            if (supports(l)) return l;
+        return IsaLevel::SCALAR;
+    }
+
+    const char *isaName(IsaLevel level) {
+        switch (level) {
+        case IsaLevel::SCALAR: return "scalar";
+        case IsaLevel::SSE42: return "sse4.2";
+        case IsaLevel::AVX2: return "avx2";
+        case IsaLevel::AVX512: return "avx512";
+        case IsaLevel::NEON: return "neon";
+        case IsaLevel::NEON_DOTPROD: return "neon-dotprod";
+        }
+        return "unknown";
+    }
+
+    const HammingKernels &getHammingKernels() {
+        const HammingKernels *k = active.load(std::memory_order_acquire);
+        if (!k) {
+            selectHammingKernels(IsaLevel::AVX512);
+            k = active.load(std::memory_order_acquire);
+        }
+        return *k;
+    }
+
+    IsaLevel selectHammingKernels(IsaLevel maxLevel) {
+        const CpuFeatures &f = cpuFeatures();
+        for (const HammingKernels &t : TABLES) {
+            if (rank(t.level) > rank(maxLevel) || !f.supports(t.level)) continue;
+            active.store(&t, std::memory_order_release);
+            return t.level;
+        }
+        return IsaLevel::SCALAR;
+    }
+
+} // namespace StringSLAM
@@ -0,0 +1,338 @@
+#include <StringSLAM/core/MapExporter.hpp>
+#include <cstring>
+
+namespace StringSLAM
+{
+    namespace
+    {
+        int64_t nowNanoseconds() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        // Records are written as they are in memory.
+        const char *plyFormat() {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            return "binary_big_endian";
+#else
+            return "binary_little_endian";
+#endif
+        }
+
+        constexpr uint8_t ADDED = 1, MOVED = 2;
+    } // namespace
+
+    MapExporter::MapExporter(const std::string &path_) : path(path_) {}
+
+    MapExporter::MapExporter(Sink sink_) : sink(std::move(sink_)) {}
+
+    MapExporter::~MapExporter() { close(); }
+
+    bool MapExporter::open() {
+        if (running) return true;
+        if (!sink) {
+            file = std::fopen(path.c_str(), "wb");
+            if (!file) return false;
+        }
+
+        // The header is the writer thread's first record, the caller never blocks on the sink.
+        Batch header;
+        header.kind = Kind::HEADER;
+        queue.clear();
+        queue.push_back(std::move(header));
+
+        synced = false;
+        cursor = 0;
+        streamFailed = false;
+        running = true;
+        writer = std::thread(&MapExporter::writerLoop, this);
+        return true;
+    }
+
+    void MapExporter::close() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!running) return;
+            running = false;
+        }
+        queueCv.notify_all();
+        if (writer.joinable()) writer.join();
+
+        if (file) {
+            std::fclose(file);
+            file = nullptr;
+        }
+    }
+
+    MapStream::KeyframeRecord MapExporter::keyframeRecord(int id, const SE3 &pose) {
+        const Eigen::Quaterniond q(pose.rotation());
+        const Eigen::Vector3d t = pose.translation();
+        return {id, float(q.w()), float(q.x()), float(q.y()), float(q.z()), float(t.x()), float(t.y()), float(t.z())};
+    }
+
+    bool MapExporter::update(Map &map) {
+        if (!running || streamFailed) return false;
+
+        // The log was disabled since the last call (e.g. detached and attached again), start over.
+        if (synced && !map.getChangeLog()) synced = false;
+
+        const auto now = std::chrono::steady_clock::now();
+        if (synced && now - lastUpdate < minInterval) return false;
+
+        Batch b;
+        b.timestampNs = nowNanoseconds();
+        const auto &landmarks = map.getLandmarks();
+        const auto &keyframes = map.getKeyframes();
+
+        if (!synced) {
+            // Everything so far is sent as added, the log covers what follows.
+            map.setChangeLog(true);
+            synced = true;
+            b.landmarksAdded.reserve(landmarks.size());
+            for (auto &[id, lm] : landmarks) b.landmarksAdded.push_back({id, lm.pos.x, lm.pos.y, lm.pos.z});
+            b.keyframesAdded.reserve(keyframes.size());
+            for (auto &[id, kf] : keyframes) b.keyframesAdded.push_back(keyframeRecord(id, kf.pose));
+        } else {
+            map.getChanges(cursor, changes);
+            if (changes.empty()) return false;
+
+            // One record per ID, added wins over moved. Landmark IDs are dense, keyframes are few.
+            // A landmark the map no longer has is sent as removed.
+            const size_t lmSpan = landmarks.empty() ? 0 : size_t(std::max(landmarks.rbegin()->first, 0)) + 1;
+            if (landmarkMark.size() < lmSpan) landmarkMark.resize(lmSpan, 0);
+            keyframeMark.clear();
+
+            for (auto &c : changes) {
+                switch (c.type) {
+                case MapChangeType::LANDMARK_ADDED:
+                case MapChangeType::LANDMARK_MOVED:
+                case MapChangeType::LANDMARK_REMOVED:
+                    if (c.id >= 0 && size_t(c.id) < landmarkMark.size()) landmarkMark[c.id] |= c.type == MapChangeType::LANDMARK_ADDED ? ADDED : MOVED;
+                    break;
+                case MapChangeType::KEYFRAME_ADDED:
+                case MapChangeType::KEYFRAME_MOVED:
+                    keyframeMark[c.id] |= c.type == MapChangeType::KEYFRAME_ADDED ? ADDED : MOVED;
+                    break;
+                }
+            }
+
+            for (auto &c : changes) {
+                if (c.type == MapChangeType::KEYFRAME_ADDED || c.type == MapChangeType::KEYFRAME_MOVED) continue;
+                if (c.id >= 0 && size_t(c.id) >= landmarkMark.size()) {
+                    b.landmarksRemoved.push_back(c.id);
+                    continue;
+                }
+                if (c.id < 0 || !landmarkMark[c.id]) continue;
+
+                const uint8_t mark = landmarkMark[c.id];
+                landmarkMark[c.id] = 0;
+                auto it = landmarks.find(c.id);
+                if (it == landmarks.end()) {
+                    b.landmarksRemoved.push_back(c.id);
+                    continue;
+                }
+                const cv::Point3f &p = it->second.pos;
+                (mark & ADDED ? b.landmarksAdded : b.landmarksMoved).push_back({c.id, p.x, p.y, p.z});
+            }
+
+            for (auto &[id, mark] : keyframeMark) {
+                auto it = keyframes.find(id);
+                if (it == keyframes.end()) continue;
+                (mark & ADDED ? b.keyframesAdded : b.keyframesMoved).push_back(keyframeRecord(id, it->second.pose));
+            }
+        }
+
+        b.revision = map.getRevision();
+        map.trimChanges(b.revision);
+        cursor = b.revision;
+        lastUpdate = now;
+        enqueue(std::move(b));
+        return true;
+    }
+
+    bool MapExporter::snapshot(const Map &map, const std::string &plyPath) {
+        if (!running) return false;
+
+        Batch b;
+        b.kind = Kind::MAP_PLY;
+        b.path = plyPath;
+        b.revision = map.getRevision();
+        b.timestampNs = nowNanoseconds();
+        b.landmarksAdded.reserve(map.getLandmarks().size());
+        for (auto &[id, lm] : map.getLandmarks()) b.landmarksAdded.push_back({id, lm.pos.x, lm.pos.y, lm.pos.z});
+        b.keyframesAdded.reserve(map.getKeyframes().size());
+        for (auto &[id, kf] : map.getKeyframes()) b.keyframesAdded.push_back(keyframeRecord(id, kf.pose));
+        enqueue(std::move(b));
+        return true;
+    }
+
+    bool MapExporter::snapshot(const PointCloud &cloud, const SE3 &T_world_camera, const std::string &plyPath) {
+        if (!running) return false;
+
+        Batch b;
+        b.kind = Kind::CLOUD_PLY;
+        b.path = plyPath;
+        b.timestampNs = nowNanoseconds();
+        b.pose = T_world_camera;
+        const size_t n = std::min(cloud.size, cloud.points.size());
+        b.points.assign(cloud.points.begin(), cloud.points.begin() + n);
+        if (cloud.colors.size() >= n) b.colors.assign(cloud.colors.begin(), cloud.colors.begin() + n);
+        enqueue(std::move(b));
+        return true;
+    }
+
+    void MapExporter::enqueue(Batch &&b) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            Batch *back = queue.empty() ? nullptr : &queue.back();
+            if (b.kind == Kind::DELTA && back && back->kind == Kind::DELTA) {
+                // Applied in order, so appending keeps the receiver's result.
+                auto append = [](auto &to, auto &from) { to.insert(to.end(), from.begin(), from.end()); };
+                append(back->landmarksAdded, b.landmarksAdded);
+                append(back->landmarksMoved, b.landmarksMoved);
+                append(back->landmarksRemoved, b.landmarksRemoved);
+                append(back->keyframesAdded, b.keyframesAdded);
+                append(back->keyframesMoved, b.keyframesMoved);
+                back->revision = b.revision;
+                back->timestampNs = b.timestampNs;
+            } else {
+                queue.push_back(std::move(b));
+            }
+        }
+        queueCv.notify_one();
+    }
+
+    void MapExporter::writerLoop() {
+        if (threadInit) threadInit();
+
+        std::deque<Batch> batch;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                queueCv.wait(lock, [&] { return !queue.empty() || !running; });
+                if (queue.empty() && !running) return;
+                batch.swap(queue);
+            }
+
+            for (auto &b : batch) {
+                if (b.kind == Kind::HEADER) {
+                    if (!writeHeader()) failed++;
+                } else if (b.kind == Kind::DELTA) {
+                    if (writeDelta(b)) batches++;
+                    else failed++;
+                } else if (writePly(b)) {
+                    snapshots++;
+                } else {
+                    failed++;
+                }
+            }
+            batch.clear();
+            if (file && !streamFailed && std::fflush(file) != 0) {
+                // The buffered batches never reached the file.
+                streamFailed = true;
+                failed++;
+            }
+        }
+    }
+
+    bool MapExporter::writeHeader() {
+        MapStream::FileHeader fh{};
+        std::memcpy(fh.magic, MapStream::FILE_MAGIC, sizeof(fh.magic));
+        fh.version = MapStream::VERSION;
+        return emit(&fh, sizeof(fh));
+    }
+
+    bool MapExporter::writeDelta(const Batch &b) {
+        MapStream::DeltaHeader h{};
+        h.magic = MapStream::DELTA_MAGIC;
+        h.landmarksAdded = uint32_t(b.landmarksAdded.size());
+        h.landmarksMoved = uint32_t(b.landmarksMoved.size());
+        h.landmarksRemoved = uint32_t(b.landmarksRemoved.size());
+        h.keyframesAdded = uint32_t(b.keyframesAdded.size());
+        h.keyframesMoved = uint32_t(b.keyframesMoved.size());
+        h.revision = b.revision;
+        h.timestampNs = b.timestampNs;
+
+        // A sink gets the batch in one piece.
+        std::vector<uint8_t> buf(sizeof(h) + (h.landmarksAdded + h.landmarksMoved) * sizeof(MapStream::LandmarkRecord) +
+            h.landmarksRemoved * sizeof(int32_t) + (h.keyframesAdded + h.keyframesMoved) * sizeof(MapStream::KeyframeRecord));
+        uint8_t *out = buf.data();
+        auto put = [&out](const void *data, size_t n) {
+            if (!n) return;
+            std::memcpy(out, data, n);
+            out += n;
+        };
+        put(&h, sizeof(h));
+        put(b.landmarksAdded.data(), b.landmarksAdded.size() * sizeof(MapStream::LandmarkRecord));
+        put(b.landmarksMoved.data(), b.landmarksMoved.size() * sizeof(MapStream::LandmarkRecord));
+        put(b.landmarksRemoved.data(), b.landmarksRemoved.size() * sizeof(int32_t));
+        put(b.keyframesAdded.data(), b.keyframesAdded.size() * sizeof(MapStream::KeyframeRecord));
+        put(b.keyframesMoved.data(), b.keyframesMoved.size() * sizeof(MapStream::KeyframeRecord));
+        return emit(buf.data(), buf.size());
+    }
+
+    bool MapExporter::writePly(const Batch &b) {
+        FILE *f = std::fopen(b.path.c_str(), "wb");
+        if (!f) return false;
+
+        std::string header = std::string("ply\nformat ") + plyFormat() + " 1.0\ncomment StringSLAM timestamp_ns " +
+            std::to_string(b.timestampNs) + "\n";
+        bool ok = true;
+        if (b.kind == Kind::MAP_PLY) {
+            header += "comment StringSLAM revision " + std::to_string(b.revision) + "\n";
+            header += "element vertex " + std::to_string(b.landmarksAdded.size()) +
+                "\nproperty int id\nproperty float x\nproperty float y\nproperty float z\n";
+            header += "element camera " + std::to_string(b.keyframesAdded.size()) +
+                "\nproperty int id\nproperty float qw\nproperty float qx\nproperty float qy\nproperty float qz\n"
+                "property float x\nproperty float y\nproperty float z\nend_header\n";
+            ok = std::fwrite(header.data(), 1, header.size(), f) == header.size();
+
+            // Property order matches the records, they are written as they are.
+            const size_t lm = b.landmarksAdded.size(), kf = b.keyframesAdded.size();
+            if (ok && lm) ok = std::fwrite(b.landmarksAdded.data(), sizeof(MapStream::LandmarkRecord), lm, f) == lm;
+            if (ok && kf) ok = std::fwrite(b.keyframesAdded.data(), sizeof(MapStream::KeyframeRecord), kf, f) == kf;
+        } else {
+            const bool color = !b.colors.empty();
+            header += "element vertex " + std::to_string(b.points.size()) + "\nproperty float x\nproperty float y\nproperty float z\n";
+            if (color) header += "property uchar red\nproperty uchar green\nproperty uchar blue\n";
+            header += "end_header\n";
+            ok = std::fwrite(header.data(), 1, header.size(), f) == header.size();
+
+            const Eigen::Matrix3f R = b.pose.rotation().cast<float>();
+            const Eigen::Vector3f t = b.pose.translation().cast<float>();
+            const size_t stride = 3 * sizeof(float) + (color ? 3 : 0);
+            std::vector<uint8_t> buf(std::min<size_t>(b.points.size(), 4096) * stride);
+            for (size_t i = 0; ok && i < b.points.size();) {
+                const size_t n = std::min(b.points.size() - i, buf.size() / stride);
+                uint8_t *out = buf.data();
+                for (size_t k = 0; k < n; k++, i++, out += stride) {
+                    const cv::Point3f &p = b.points[i];
+                    const Eigen::Vector3f w = R * Eigen::Vector3f(p.x, p.y, p.z) + t;
+                    std::memcpy(out, w.data(), 3 * sizeof(float));
+                    if (color) {
+                        const cv::Vec3b &c = b.colors[i];
+                        out[12] = c[2];
+                        out[13] = c[1];
+                        out[14] = c[0];
+                    }
+                }
+                ok = std::fwrite(buf.data(), stride, n, f) == n;
+            }
+        }
+
+        return std::fclose(f) == 0 && ok;
+    }
+
+    bool MapExporter::emit(const void *data, size_t n) {
+        // After a short write the stream is corrupt, anything appended would be misread.
+        if (streamFailed) return false;
+        if (sink) {
+            sink(static_cast<const uint8_t *>(data), n);
+        } else if (std::fwrite(data, 1, n, file) != n) {
+            streamFailed = true;
+            return false;
+        }
+        bytes += n;
+        return true;
+    }
+
+} // namespace StringSLAM
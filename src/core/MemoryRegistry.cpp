@@ -0,0 +1,112 @@
+#include <StringSLAM/core/MemoryRegistry.hpp>
+#include <algorithm>
+
+namespace StringSLAM
+{
+    bool MemoryRegistry::update(const std::string &name, size_t before, size_t after) {
+        std::lock_guard<std::mutex> lock(mtx);
+        Entry &e = entries[name];
+        e.bytes = e.bytes - before + after;
+        e.peak = std::max(e.peak, e.bytes);
+        total = total - before + after;
+        peakTotal = std::max(peakTotal, total);
+
+        const bool ok = (!e.budget || e.bytes <= e.budget) && (!totalBudget || total <= totalBudget);
+        if (!ok && after > before) e.overruns++;
+        return ok;
+    }
+
+    bool MemoryRegistry::fits(const std::string &name, size_t before, size_t after) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = entries.find(name);
+        const size_t bytes = (it != entries.end() ? it->second.bytes : 0) - before + after;
+        const size_t budget = it != entries.end() ? it->second.budget : 0;
+        return (!budget || bytes <= budget) && (!totalBudget || total - before + after <= totalBudget);
+    }
+
+    void MemoryRegistry::setBudget(const std::string &name, size_t bytes) {
+        std::lock_guard<std::mutex> lock(mtx);
+        entries[name].budget = bytes;
+    }
+
+    void MemoryRegistry::setTotalBudget(size_t bytes) {
+        std::lock_guard<std::mutex> lock(mtx);
+        totalBudget = bytes;
+    }
+
+    size_t MemoryRegistry::getTotalBytes() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return total;
+    }
+
+    size_t MemoryRegistry::getPeakBytes() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return peakTotal;
+    }
+
+    std::vector<MemoryUsage> MemoryRegistry::getUsage() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::vector<MemoryUsage> usage;
+        usage.reserve(entries.size());
+        for (auto &[name, e] : entries) {
+            MemoryUsage u;
+            u.name = name;
+            u.bytes = e.bytes;
+            u.peak = e.peak;
+            u.budget = e.budget;
+            u.overruns = e.overruns;
+            usage.push_back(u);
+        }
+        return usage;
+    }
+
+    bool MemoryRegistry::withinBudget() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (totalBudget && total > totalBudget) return false;
+        for (auto &[name, e] : entries)
+            if (e.budget && e.bytes > e.budget) return false;
+        return true;
+    }
+
+    MemoryAccount::MemoryAccount(std::shared_ptr<MemoryRegistry> registry_, std::string name_)
+        : registry(std::move(registry_)), name(std::move(name_)) {
+        // Listed in the breakdown before the first report.
+        if (registry) registry->update(name, 0, 0);
+    }
+
+    MemoryAccount::~MemoryAccount() {
+        if (registry) registry->update(name, bytes, 0);
+    }
+
+    MemoryAccount::MemoryAccount(MemoryAccount &&other) noexcept
+        : registry(std::move(other.registry)), name(std::move(other.name)), bytes(other.bytes) {
+        other.registry.reset();
+        other.bytes = 0;
+    }
+
+    MemoryAccount &MemoryAccount::operator=(MemoryAccount &&other) noexcept {
+        if (this == &other) return *this;
+        if (registry) registry->update(name, bytes, 0);
+        registry = std::move(other.registry);
+        name = std::move(other.name);
+        bytes = other.bytes;
+        other.registry.reset();
+        other.bytes = 0;
+        return *this;
+    }
+
+    bool MemoryAccount::set(size_t bytes_) {
+        if (!registry) {
+            bytes = bytes_;
+            return true;
+        }
+        const bool ok = registry->update(name, bytes, bytes_);
+        bytes = bytes_;
+        return ok;
+    }
+
+    bool MemoryAccount::fits(size_t bytes_) const {
+        return !registry || registry->fits(name, bytes, bytes_);
+    }
+
+} // namespace StringSLAM
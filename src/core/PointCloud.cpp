@@ -0,0 +1,139 @@
+#include <StringSLAM/core/PointCloud.hpp>
+#include <algorithm>
+
+namespace StringSLAM
+{
+    DisparityReprojector::DisparityReprojector(const cv::Mat &Q) {
+        cv::Mat Qd;
+        Q.convertTo(Qd, CV_64F);
+        for (int r = 0; r < 4; r++)
+            for (int c = 0; c < 4; c++) q[r][c] = Qd.empty() ? float(r == c) : float(Qd.at<double>(r, c));
+    }
+
+    void DisparityReprojector::setParallel(std::shared_ptr<Utils::ThreadPool> pool_, size_t stripes_) {
+        pool = pool_;
+        stripes = pool ? (stripes_ ? stripes_ : pool->size() + 1) : 1;
+    }
+
+    size_t DisparityReprojector::reprojectRows(const cv::Mat &disp, const cv::Mat &mask, const cv::Mat &color, int r0, int r1,
+        PointCloud &out, size_t offset, RowScratch &row) const {
+        const int n = (disp.cols + stride - 1) / stride;
+        const bool gray = !color.empty() && color.channels() == 1;
+        const bool withPixels = !out.pixels.empty();
+
+        // Row scratch in structure-of-arrays form so the kernel below vectorizes.
+        float *d = row.d.data(), *X = row.X.data(), *Y = row.Y.data(), *Z = row.Z.data();
+        uint8_t *valid = row.valid.data();
+
+        cv::Point3f *pts = out.points.data() + offset;
+        size_t written = 0;
+
+        for (int r = r0; r < r1; r += stride) {
+            const float *dRow = disp.ptr<float>(r);
+            if (stride == 1) std::copy(dRow, dRow + n, d);
+            else for (int k = 0; k < n; k++) d[k] = dRow[k * stride];
+
+            // Row-constant part of Q * (u, v, d, 1).
+            const float v = float(r);
+            const float cX = q[0][1] * v + q[0][3], cY = q[1][1] * v + q[1][3];
+            const float cZ = q[2][1] * v + q[2][3], cW = q[3][1] * v + q[3][3];
+            const float su = float(stride);
+            const float minD = minDisparity, maxD = maxDisparity;
+
+            for (int k = 0; k < n; k++) {
+                const float u = su * float(k);
+                const float W = q[3][0] * u + q[3][2] * d[k] + cW;
+                const float inv = 1.0f / W;
+                X[k] = (q[0][0] * u + q[0][2] * d[k] + cX) * inv;
+                Y[k] = (q[1][0] * u + q[1][2] * d[k] + cY) * inv;
+                Z[k] = (q[2][0] * u + q[2][2] * d[k] + cZ) * inv;
+                valid[k] = uint8_t((d[k] > minD) & (d[k] <= maxD) & (W > 0.0f));
+            }
+
+            if (!mask.empty()) {
+                const uint8_t *m = mask.ptr<uint8_t>(r);
+                for (int k = 0; k < n; k++) valid[k] &= uint8_t(m[k * stride] != 0);
+            }
+
+            // Compact the valid points into the output.
+            const uint8_t *cRow = color.empty() ? nullptr : color.ptr<uint8_t>(r);
+            for (int k = 0; k < n; k++) {
+                if (!valid[k]) continue;
+                const size_t i = offset + written;
+                pts[written++] = cv::Point3f(X[k], Y[k], Z[k]);
+
+                if (cRow) {
+                    const uint8_t *px = cRow + size_t(k) * stride * (gray ? 1 : 3);
+                    out.colors[i] = gray ? cv::Vec3b(px[0], px[0], px[0]) : cv::Vec3b(px[0], px[1], px[2]);
+                }
+                if (withPixels) out.pixels[i] = cv::Point2i(k * stride, r);
+            }
+        }
+        return written;
+    }
+
+    size_t DisparityReprojector::reproject(const cv::Mat &disp, PointCloud &out, const cv::Mat &color,
+        const cv::Mat &mask, bool withPixels) const {
+        out.size = 0;
+        if (disp.empty() || disp.type() != CV_32FC1) return 0;
+
+        const bool useColor = !color.empty() && color.rows == disp.rows && color.cols == disp.cols && color.depth() == CV_8U &&
+            (color.channels() == 1 || color.channels() == 3);
+        const bool useMask = !mask.empty() && mask.rows == disp.rows && mask.cols == disp.cols && mask.type() == CV_8UC1;
+
+        const int n = (disp.cols + stride - 1) / stride;
+        const int sampledRows = (disp.rows + stride - 1) / stride;
+        out.reserve(size_t(n) * sampledRows, useColor, withPixels);
+        if (!withPixels) out.pixels.clear();
+
+        const cv::Mat c = useColor ? color : cv::Mat();
+        const cv::Mat m = useMask ? mask : cv::Mat();
+
+        // Stripes start on sampled rows and write to disjoint regions sized for their worst case.
+        const size_t count = pool ? std::max<size_t>(1, std::min<size_t>(stripes, size_t(sampledRows))) : 1;
+        if (scratch.size() < count) scratch.resize(count);
+        for (size_t s = 0; s < count; s++) {
+            RowScratch &row = scratch[s];
+            if (row.d.size() >= size_t(n)) continue;
+            row.d.resize(n);
+            row.X.resize(n);
+            row.Y.resize(n);
+            row.Z.resize(n);
+            row.valid.resize(n);
+        }
+
+        if (count == 1) {
+            out.size = reprojectRows(disp, m, c, 0, disp.rows, out, 0, scratch[0]);
+            return out.size;
+        }
+
+        rowStart.resize(count + 1);
+        for (size_t s = 0; s <= count; s++) rowStart[s] = int(sampledRows * s / count) * stride;
+        rowStart[count] = disp.rows;
+
+        stripeWritten.resize(count);
+        pool->parallelFor(0, count, [&](size_t s) {
+            const size_t offset = size_t(rowStart[s] / stride) * n;
+            stripeWritten[s] = reprojectRows(disp, m, c, rowStart[s], rowStart[s + 1], out, offset, scratch[s]);
+        });
+
+        // Close the gaps between stripes, every move goes towards the front.
+        size_t total = 0;
+        for (size_t s = 0; s < count; s++) {
+            const size_t offset = size_t(rowStart[s] / stride) * n;
+            if (offset != total) {
+                std::copy(out.points.begin() + offset, out.points.begin() + offset + stripeWritten[s], out.points.begin() + total);
+                if (useColor) std::copy(out.colors.begin() + offset, out.colors.begin() + offset + stripeWritten[s], out.colors.begin() + total);
+                if (withPixels) std::copy(out.pixels.begin() + offset, out.pixels.begin() + offset + stripeWritten[s], out.pixels.begin() + total);
+            }
+            total += stripeWritten[s];
+        }
+        out.size = total;
+        return total;
+    }
+
+    size_t DisparityReprojector::reproject(const StereoFrame &sf, PointCloud &out, bool withColor) const {
+        return reproject(sf.depthFrame, out, withColor ? sf.frameLeft.frame : cv::Mat());
+    }
+
+} // namespace StringSLAM
@@ -0,0 +1,51 @@
+#include <StringSLAM/core/Policies.hpp>
+#include <opencv2/calib3d.hpp>
+
+namespace StringSLAM::Policy
+{
+    void BruteForce::match(const cv::Mat &d1, const cv::Mat &d2, std::vector<cv::DMatch> &matches) {
+        matches.clear();
+        if (d1.empty() || d2.empty()) return;
+
+        // Keep a match only when it is clearly better than the runner-up (Lowe ratio).
+        matcher->knnMatch(d1, d2, knnMatches, 2);
+        for (auto &knn : knnMatches) {
+            if (knn.size() == 2 && knn[0].distance < ratio * knn[1].distance)
+                matches.push_back(knn[0]);
+        }
+    }
+
+    bool Essential::estimate(const std::vector<cv::Point2f> &p1, const std::vector<cv::Point2f> &p2, const CameraIntrinsic &cI,
+        SE3 &T_1_2) {
+        if (p1.size() != p2.size() || int(p1.size()) < std::max(5, minInliers)) return false;
+
+        const cv::Mat K = (cv::Mat_<double>(3, 3) << cI.fx, 0, cI.cx, 0, cI.fy, cI.cy, 0, 0, 1);
+        cv::Mat E = cv::findEssentialMat(p1, p2, K, cv::RANSAC, confidence, threshold, mask);
+        if (E.rows != 3 || E.cols != 3) return false;
+
+        // recoverPose gives x2 = R * x1 + t, the pose of view 1 in view 2.
+        cv::Mat R, t;
+        if (cv::recoverPose(E, p1, p2, K, R, t, mask) < minInliers) return false;
+        T_1_2 = SE3::fromCv(R, t).inverse();
+        return true;
+    }
+
+    bool Planar::estimate(const std::vector<cv::Point2f> &p1, const std::vector<cv::Point2f> &p2, const CameraIntrinsic &cI,
+        SE3 &T_1_2) {
+        if (p1.size() != p2.size() || p1.size() < 2) return false;
+
+        // R * x2 + t = x1 on the plane at unit distance.
+        src.resize(p2.size());
+        dst.resize(p1.size());
+        for (size_t i = 0; i < p1.size(); i++) {
+            src[i] = Eigen::Vector2d((p2[i].x - cI.cx) / cI.fx, (p2[i].y - cI.cy) / cI.fy);
+            dst[i] = Eigen::Vector2d((p1[i].x - cI.cx) / cI.fx, (p1[i].y - cI.cy) / cI.fy);
+        }
+
+        Estimation::Poser::Pose2D pose;
+        if (!solver.solvePose2D_GN(src, dst, pose, maxIterations)) return false;
+        T_1_2 = SE3(SO3::exp(Eigen::Vector3d(0.0, 0.0, pose.pos.z())), Eigen::Vector3d(pose.pos.x(), pose.pos.y(), 0.0));
+        return true;
+    }
+
+} // namespace StringSLAM::Policy
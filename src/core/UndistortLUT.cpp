@@ -0,0 +1,29 @@
+#include <StringSLAM/core/UndistortLUT.hpp>
+#include <opencv2/calib3d.hpp>
+
+namespace StringSLAM
+{
+    UndistortLUT::UndistortLUT(const CameraModel &cm, int step_) : size(cm.capSize), step(std::max(1, step_)) {
+        // At least two nodes per axis so every lookup has a full cell.
+        cols = std::max(2, (std::max(size.width, 1) - 1 + step - 1) / step + 1);
+        rows = std::max(2, (std::max(size.height, 1) - 1 + step - 1) / step + 1);
+
+        std::vector<cv::Point2f> nodes;
+        nodes.reserve(size_t(cols) * rows);
+        for (int j = 0; j < rows; j++)
+            for (int i = 0; i < cols; i++) nodes.emplace_back(float(i * step), float(j * step));
+
+        const cv::Mat K = cm.cI.getK();
+        // The default 5 fixed-point iterations leave pixels of error at the corners of
+        // strongly distorted lenses, every lookup would inherit it, so iterate to convergence.
+        cv::undistortPoints(nodes, grid, K, cm.cD.getD(), cm.cD.R, K,
+            cv::TermCriteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, 100, 1e-10));
+        if (grid.size() != nodes.size()) grid = nodes;
+    }
+
+    void UndistortLUT::undistort(const std::vector<cv::KeyPoint> &kp, std::vector<cv::Point2f> &out) const {
+        out.resize(kp.size());
+        for (size_t i = 0; i < kp.size(); i++) out[i] = (*this)(kp[i].pt);
+    }
+
+} // namespace StringSLAM
@@ -0,0 +1,303 @@
+#include <StringSLAM/core/VoxelMap.hpp>
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace StringSLAM
+{
+    VoxelMap::VoxelMap(float voxelSize_, float truncation_, size_t maxBlocks_, std::shared_ptr<Utils::ThreadPool> pool_) :
+        voxelSize(voxelSize_), truncation(truncation_), maxBlocks(std::max<size_t>(maxBlocks_, 1)), pool(pool_) {
+        if (!pool) pool = Utils::ThreadPool::create();
+
+        // Keep the load factor at or below 0.5 so probe sequences stay short.
+        size_t capacity = 1;
+        while (capacity < maxBlocks * 2) capacity <<= 1;
+        table.resize(capacity);
+        mask = capacity - 1;
+    }
+
+    // ------------------ Hash table ------------------
+
+    uint64_t VoxelMap::pack(const Eigen::Vector3i &c) {
+        // 21 bits per axis, +-2^20 blocks covers any realistic map.
+        const uint64_t bias = uint64_t(1) << 20;
+        return ((uint64_t(c.x()) + bias) & 0x1FFFFF) | (((uint64_t(c.y()) + bias) & 0x1FFFFF) << 21) |
+            (((uint64_t(c.z()) + bias) & 0x1FFFFF) << 42);
+    }
+
+    size_t VoxelMap::home(uint64_t key) const {
+        return size_t((key * 0x9E3779B97F4A7C15ULL) >> 17) & mask;
+    }
+
+    int32_t VoxelMap::find(const Eigen::Vector3i &c) const {
+        const uint64_t key = pack(c);
+        for (size_t i = home(key);; i = (i + 1) & mask) {
+            if (table[i].key == key) return table[i].block;
+            if (table[i].key == EMPTY) return -1;
+        }
+    }
+
+    int32_t VoxelMap::allocate(const Eigen::Vector3i &c) {
+        const uint64_t key = pack(c);
+        size_t i = home(key);
+        for (;; i = (i + 1) & mask) {
+            if (table[i].key == key) return table[i].block;
+            if (table[i].key == EMPTY) break;
+        }
+
+        if (freeBlocks.empty() && blocks.size() >= maxBlocks) {
+            if (!evict()) return -1;
+            // Eviction shifted entries, find the insertion slot again.
+            i = home(key);
+            while (table[i].key != EMPTY) i = (i + 1) & mask;
+        }
+
+        int32_t b;
+        if (!freeBlocks.empty()) {
+            b = freeBlocks.back();
+            freeBlocks.pop_back();
+            blocks[b] = Block();
+        } else {
+            b = int32_t(blocks.size());
+            blocks.emplace_back();
+        }
+        blocks[b].coords = c;
+        blocks[b].lastUsed = frameCount;
+
+        table[i].key = key;
+        table[i].block = b;
+        return b;
+    }
+
+    void VoxelMap::erase(size_t slot) {
+        // Backward shift deletion, keeps linear probing free of tombstones.
+        size_t i = slot;
+        for (size_t j = (i + 1) & mask; table[j].key != EMPTY; j = (j + 1) & mask) {
+            const size_t k = home(table[j].key);
+            const bool movable = (i <= j) ? (k <= i || k > j) : (k <= i && k > j);
+            if (movable) {
+                table[i] = table[j];
+                i = j;
+            }
+        }
+        table[i] = Slot();
+    }
+
+    bool VoxelMap::evict() {
+        // Drop the least recently observed eighth of the blocks, never the ones of this frame.
+        std::vector<std::pair<uint64_t, size_t>> candidates;
+        candidates.reserve(blocks.size());
+        for (size_t s = 0; s < table.size(); s++) {
+            if (table[s].key == EMPTY) continue;
+            const uint64_t used = blocks[table[s].block].lastUsed;
+            if (used < frameCount) candidates.emplace_back(used, s);
+        }
+        if (candidates.empty()) return false;
+
+        const size_t n = std::max<size_t>(1, std::min(candidates.size(), maxBlocks / 8));
+        std::nth_element(candidates.begin(), candidates.begin() + (n - 1), candidates.end());
+
+        // Erase by key, backward shifting moves the remaining entries.
+        std::vector<uint64_t> keys(n);
+        for (size_t k = 0; k < n; k++) keys[k] = table[candidates[k].second].key;
+        for (uint64_t key : keys) {
+            for (size_t i = home(key);; i = (i + 1) & mask) {
+                if (table[i].key != key) continue;
+                freeBlocks.push_back(table[i].block);
+                erase(i);
+                break;
+            }
+        }
+        return true;
+    }
+
+    // ------------------ Integration ------------------
+
+    Eigen::Vector3i VoxelMap::blockOf(const Eigen::Vector3d &p) const {
+        const double bs = voxelSize * BLOCK;
+        return Eigen::Vector3i(int(std::floor(p.x() / bs)), int(std::floor(p.y() / bs)), int(std::floor(p.z() / bs)));
+    }
+
+    void VoxelMap::integrateBlock(Block &b, const cv::Mat &depth, const CameraIntrinsic &cI, const SE3 &T_camera_world) {
+        const Eigen::Matrix3d R = T_camera_world.rotation();
+        const Eigen::Vector3d origin = b.coords.cast<double>() * (voxelSize * BLOCK) + Eigen::Vector3d::Constant(0.5 * voxelSize);
+
+        // Voxel centers are an affine lattice, step through it instead of transforming each one.
+        const Eigen::Vector3f base = (T_camera_world * origin).cast<float>();
+        const Eigen::Vector3f ex = (R.col(0) * voxelSize).cast<float>();
+        const Eigen::Vector3f ey = (R.col(1) * voxelSize).cast<float>();
+        const Eigen::Vector3f ez = (R.col(2) * voxelSize).cast<float>();
+
+        const float fx = float(cI.fx), fy = float(cI.fy), cx = float(cI.cx), cy = float(cI.cy);
+        const float invTrunc = 1.0f / truncation;
+        const int w = depth.cols, h = depth.rows;
+
+        Voxel *v = b.voxels;
+        for (int z = 0; z < BLOCK; z++) {
+            for (int y = 0; y < BLOCK; y++) {
+                Eigen::Vector3f p = base + ey * float(y) + ez * float(z);
+                for (int x = 0; x < BLOCK; x++, v++, p += ex) {
+                    if (p.z() < minDepth) continue;
+
+                    const int u = int(fx * p.x() / p.z() + cx + 0.5f);
+                    const int r = int(fy * p.y() / p.z() + cy + 0.5f);
+                    if (u < 0 || r < 0 || u >= w || r >= h) continue;
+
+                    const float d = depth.ptr<float>(r)[u];
+                    if (!(d >= minDepth && d <= maxDepth)) continue;
+
+                    // Distance along the optical axis, cheap and close enough inside the band.
+                    const float sdf = d - p.z();
+                    if (sdf < -truncation) continue;
+
+                    const float tsdf = std::min(1.0f, sdf * invTrunc);
+                    const float weight = v->weight + 1.0f;
+                    v->tsdf = (v->tsdf * v->weight + tsdf) / weight;
+                    v->weight = std::min(weight, maxWeight);
+                }
+            }
+        }
+    }
+
+    void VoxelMap::integrate(const cv::Mat &depth, const CameraIntrinsic &cI, const SE3 &T_world_camera) {
+        if (depth.empty() || depth.type() != CV_32FC1) return;
+
+        std::unique_lock<std::shared_mutex> lock(mtx);
+        frameCount++;
+
+        // Allocate every block crossed by the truncation band around the observed surface.
+        const Eigen::Matrix3d R = T_world_camera.rotation();
+        const Eigen::Vector3d t = T_world_camera.translation();
+        const double step = voxelSize * BLOCK * 0.5;
+
+        for (int r = 0; r < depth.rows; r += stride) {
+            const float *row = depth.ptr<float>(r);
+            for (int c = 0; c < depth.cols; c += stride) {
+                const float d = row[c];
+                if (!(d >= minDepth && d <= maxDepth)) continue;
+
+                const Eigen::Vector3d ray = R * Eigen::Vector3d((c - cI.cx) / cI.fx, (r - cI.cy) / cI.fy, 1.0);
+                for (double s = std::max<double>(minDepth, d - truncation); s <= d + truncation; s += step) {
+                    const int32_t b = allocate(blockOf(t + ray * s));
+                    if (b >= 0) blocks[b].lastUsed = frameCount;
+                }
+            }
+        }
+
+        // Blocks stamped with this frame are the ones the depth image can update.
+        touched.clear();
+        for (size_t b = 0; b < blocks.size(); b++)
+            if (blocks[b].lastUsed == frameCount) touched.push_back(int32_t(b));
+
+        const SE3 T_camera_world = T_world_camera.inverse();
+        pool->parallelFor(0, touched.size(), [&](size_t i) {
+            integrateBlock(blocks[touched[i]], depth, cI, T_camera_world);
+        });
+    }
+
+    bool VoxelMap::integrate(const StereoFrame &sf, const StereoCameraDistortion &scd) {
+        if (scd.Q.empty() || sf.depthFrame.empty()) return false;
+
+        cv::Mat Q;
+        scd.Q.convertTo(Q, CV_64F);
+        const double f = Q.at<double>(2, 3);
+        const double a = Q.at<double>(3, 2), b = Q.at<double>(3, 3);
+        CameraIntrinsic cI(f, f, -Q.at<double>(0, 3), -Q.at<double>(1, 3));
+
+        // Z = f / (a * d + b), invalid disparities become 0.
+        depthBuffer.create(sf.depthFrame.rows, sf.depthFrame.cols, CV_32FC1);
+        for (int r = 0; r < sf.depthFrame.rows; r++) {
+            const float *disp = sf.depthFrame.ptr<float>(r);
+            float *out = depthBuffer.ptr<float>(r);
+            for (int c = 0; c < sf.depthFrame.cols; c++) {
+                const double den = a * disp[c] + b;
+                out[c] = (disp[c] > 0.0f && den > 0.0) ? float(f / den) : 0.0f;
+            }
+        }
+
+        // Points in the rectified frame are R1 * x_camera.
+        SE3 T_world_rect = sf.pose;
+        if (!scd.R1.empty()) {
+            cv::Mat zero = cv::Mat::zeros(3, 1, CV_64F);
+            T_world_rect = sf.pose * SE3::fromCv(scd.R1, zero).inverse();
+        }
+
+        integrate(depthBuffer, cI, T_world_rect);
+        return true;
+    }
+
+    // ------------------ Queries ------------------
+
+    const VoxelMap::Voxel *VoxelMap::voxelAt(const Eigen::Vector3d &p) const {
+        const Eigen::Vector3i bc = blockOf(p);
+        const int32_t b = find(bc);
+        if (b < 0) return nullptr;
+
+        const Eigen::Vector3d local = p / voxelSize - bc.cast<double>() * BLOCK;
+        const int x = std::clamp(int(std::floor(local.x())), 0, BLOCK - 1);
+        const int y = std::clamp(int(std::floor(local.y())), 0, BLOCK - 1);
+        const int z = std::clamp(int(std::floor(local.z())), 0, BLOCK - 1);
+        const Voxel &v = blocks[b].voxels[(z * BLOCK + y) * BLOCK + x];
+        return v.weight > 0.0f ? &v : nullptr;
+    }
+
+    bool VoxelMap::getDistance(const Eigen::Vector3d &p, float &distance) const {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        const Voxel *v = voxelAt(p);
+        if (!v) return false;
+        distance = v->tsdf * truncation;
+        return true;
+    }
+
+    Occupancy VoxelMap::getOccupancy(const Eigen::Vector3d &p) const {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        const Voxel *v = voxelAt(p);
+        if (!v) return Occupancy::UNKNOWN;
+        return v->tsdf * truncation < voxelSize ? Occupancy::OCCUPIED : Occupancy::FREE;
+    }
+
+    bool VoxelMap::isFree(const Eigen::Vector3d &center, double radius, bool unknownIsOccupied) const {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+
+        const int n = int(std::ceil(radius / voxelSize));
+        const double r2 = radius * radius;
+        for (int z = -n; z <= n; z++) {
+            for (int y = -n; y <= n; y++) {
+                for (int x = -n; x <= n; x++) {
+                    const Eigen::Vector3d o(x * voxelSize, y * voxelSize, z * voxelSize);
+                    if (o.squaredNorm() > r2) continue;
+
+                    const Voxel *v = voxelAt(center + o);
+                    if (!v) {
+                        if (unknownIsOccupied) return false;
+                        continue;
+                    }
+                    if (v->tsdf * truncation < voxelSize) return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool VoxelMap::isSegmentFree(const Eigen::Vector3d &a, const Eigen::Vector3d &b, double radius, bool unknownIsOccupied) const {
+        const double length = (b - a).norm();
+        const double step = std::max<double>(voxelSize, radius);
+        const int n = std::max(1, int(std::ceil(length / step)));
+        for (int i = 0; i <= n; i++)
+            if (!isFree(a + (b - a) * (double(i) / n), radius, unknownIsOccupied)) return false;
+        return true;
+    }
+
+    size_t VoxelMap::getBlockCount() const {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        return blocks.size() - freeBlocks.size();
+    }
+
+    void VoxelMap::clear() {
+        std::unique_lock<std::shared_mutex> lock(mtx);
+        blocks.clear();
+        freeBlocks.clear();
+        std::fill(table.begin(), table.end(), Slot());
+    }
+
+} // namespace StringSLAM
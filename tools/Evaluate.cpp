@@ -0,0 +1,298 @@
+/*
+ * StringSLAM_eval: runs the monocular pipeline over a recorded sequence at full
+ * speed and reports accuracy and throughput as a single JSON document.
+ *
+ *   StringSLAM_eval --log run.sslog --gt groundtruth.txt --report report.json
+ *   StringSLAM_eval --images rgbd_dataset_freiburg1_xyz --fx 517.3 --fy 516.5 --cx 318.6 --cy 255.3 --gt groundtruth.txt
+ *
+ * --log        FrameRecorder log (camera model is taken from the log)
+ * --images     Directory with a TUM style rgb.txt (timestamp path per line)
+ * --fx/fy/cx/cy Intrinsics, required for --images and overriding the log
+ * --gt         Ground truth trajectory in TUM format
+ * --traj       Output trajectory in TUM format (default trajectory.txt)
+ * --report     Output report (default stdout)
+ * --frames     Stop after this many frames
+ * --features   ORB features per frame (default 1000)
+ * --threads    Worker threads (default all cores)
+ * --rpe-delta  RPE time delta in seconds (default 1.0)
+ * --no-scale   Align without scale (metric trajectories)
+ * --low-power  Skip frames the motion gate finds static
+ * --semi-direct Track frames between keyframes by sparse image alignment
+ * --compact-map Store keyframes without images and share landmark descriptors
+ * --map-budget Map memory budget in MiB, the map is compacted and then stops growing
+ * --map-stream Stream map changes to this file (MapStream records)
+ * --map-ply    Write the final map as a binary PLY
+ */
+#include <StringSLAM/System.hpp>
+#include <StringSLAM/core/CompactMap.hpp>
+#include <StringSLAM/Tracker/ReplayTracker.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace StringSLAM;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    struct Options {
+        std::string log, images, groundTruth, trajectory = "trajectory.txt", report;
+        double fx = 0.0, fy = 0.0, cx = 0.0, cy = 0.0;
+        size_t maxFrames = 0, threads = 0;
+        int features = 1000;
+        double rpeDelta = 1.0;
+        bool alignScale = true;
+        bool lowPower = false;
+        bool semiDirect = false;
+        bool compactMap = false;
+        double mapBudgetMB = 0.0;
+        std::string mapStream, mapPly;
+    };
+
+    double elapsedMs(Clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+    }
+
+    double seconds(std::chrono::system_clock::time_point t) {
+        return std::chrono::duration<double>(t.time_since_epoch()).count();
+    }
+
+    /*
+     * Frames from a FrameRecorder log or a TUM style image list.
+     */
+    class Source
+    {
+    private:
+        std::shared_ptr<Tracker::ReplayTracker> replay;
+        std::vector<std::pair<double, std::string>> list;
+        std::string dir;
+        size_t cursor = 0;
+
+    public:
+        CameraModel cm{cv::Size()};
+        std::string name;
+
+        bool open(const Options &opt) {
+            if (!opt.log.empty()) {
+                name = opt.log;
+                replay = Tracker::ReplayTracker::create(opt.log, Tracker::ReplayTracker::Playback::MAX_SPEED);
+                if (!replay->open()) return false;
+                cm = replay->getCameraModel(0);
+            } else if (!opt.images.empty()) {
+                name = dir = opt.images;
+                std::ifstream in(dir + "/rgb.txt");
+                std::string line;
+                while (std::getline(in, line)) {
+                    if (line.empty() || line[0] == '#') continue;
+                    std::istringstream ss(line);
+                    double t;
+                    std::string file;
+                    if (ss >> t >> file) list.emplace_back(t, file);
+                }
+                if (list.empty()) return false;
+            } else {
+                return false;
+            }
+
+            if (opt.fx > 0.0) cm.cI = CameraIntrinsic(opt.fx, opt.fy > 0.0 ? opt.fy : opt.fx, opt.cx, opt.cy);
+            return cm.cI.fx > 0.0;
+        }
+
+        bool read(Frame &f) {
+            if (replay) return replay->read(f);
+            if (cursor >= list.size()) return false;
+
+            const auto &[t, file] = list[cursor++];
+            f.frame = cv::imread(dir + "/" + file, cv::IMREAD_GRAYSCALE);
+            f.timestamp = std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::duration<double>(t)));
+            f.raw = RawBuffer();
+            return !f.frame.empty();
+        }
+    };
+
+    void writeStats(std::ostream &out, const Utils::ErrorStats &s) {
+        out << "{\"count\": " << s.count << ", \"rmse\": " << s.rmse << ", \"mean\": " << s.mean << ", \"median\": " << s.median
+            << ", \"max\": " << s.max << "}";
+    }
+
+    std::string escape(const std::string &s) {
+        std::string e;
+        for (char c : s) {
+            if (c == '"' || c == '\\') e += '\\';
+            e += c;
+        }
+        return e;
+    }
+
+    bool parse(int argc, char **argv, Options &opt) {
+        for (int i = 1; i < argc; i++) {
+            const std::string a = argv[i];
+            auto next = [&]() -> std::string { return i + 1 < argc ? argv[++i] : ""; };
+            if (a == "--log") opt.log = next();
+            else if (a == "--images") opt.images = next();
+            else if (a == "--gt") opt.groundTruth = next();
+            else if (a == "--traj") opt.trajectory = next();
+            else if (a == "--report") opt.report = next();
+            else if (a == "--fx") opt.fx = std::stod(next());
+            else if (a == "--fy") opt.fy = std::stod(next());
+            else if (a == "--cx") opt.cx = std::stod(next());
+            else if (a == "--cy") opt.cy = std::stod(next());
+            else if (a == "--frames") opt.maxFrames = std::stoul(next());
+            else if (a == "--features") opt.features = std::stoi(next());
+            else if (a == "--threads") opt.threads = std::stoul(next());
+            else if (a == "--rpe-delta") opt.rpeDelta = std::stod(next());
+            else if (a == "--no-scale") opt.alignScale = false;
+            else if (a == "--low-power") opt.lowPower = true;
+            else if (a == "--semi-direct") opt.semiDirect = true;
+            else if (a == "--compact-map") opt.compactMap = true;
+            else if (a == "--map-budget") opt.mapBudgetMB = std::stod(next());
+            else if (a == "--map-stream") opt.mapStream = next();
+            else if (a == "--map-ply") opt.mapPly = next();
+            else return false;
+        }
+        return !opt.log.empty() || !opt.images.empty();
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    Options opt;
+    try {
+        if (!parse(argc, argv, opt)) {
+            std::cerr << "usage: " << argv[0] << " (--log FILE | --images DIR --fx F --fy F --cx C --cy C) [--gt FILE]"
+                      << " [--traj FILE] [--report FILE] [--frames N] [--features N] [--threads N] [--rpe-delta S] [--no-scale] [--low-power] [--semi-direct] [--compact-map] [--map-budget MB] [--map-stream FILE] [--map-ply FILE]\n";
+            return 2;
+        }
+    } catch (const std::exception &) {
+        std::cerr << "[FATAL] Invalid numeric argument\n";
+        return 2;
+    }
+
+    Source source;
+    if (!source.open(opt)) {
+        std::cerr << "[FATAL] Could not open the sequence or its camera model\n";
+        return 1;
+    }
+
+    auto pool = Utils::ThreadPool::create(opt.threads);
+    System slam(source.cm, pool, opt.features);
+    auto latency = std::make_shared<Utils::LatencyRecorder>();
+    slam.setLatencyRecorder(latency);
+    if (opt.lowPower) slam.setMotionGate(Tracker::MotionGate::create());
+    if (opt.semiDirect) slam.setTrackingMode(TrackingMode::SEMI_DIRECT);
+    if (opt.compactMap) slam.getMap()->setStorage(MapStorage::COMPACT);
+    auto memory = MemoryRegistry::create();
+    if (opt.mapBudgetMB > 0.0) memory->setBudget("map", size_t(opt.mapBudgetMB * 1024.0 * 1024.0));
+    slam.setMemoryRegistry(memory);
+
+    // Deltas during the run and the final snapshot share one writer thread.
+    std::shared_ptr<MapExporter> exporter;
+    if (!opt.mapStream.empty() || !opt.mapPly.empty()) {
+        exporter = opt.mapStream.empty() ? MapExporter::create([](const uint8_t *, size_t) {}) : MapExporter::create(opt.mapStream);
+        if (!exporter->open()) {
+            std::cerr << "[WARN] Could not write " << (opt.mapStream.empty() ? opt.mapPly : opt.mapStream) << "\n";
+            exporter.reset();
+        } else if (!opt.mapStream.empty()) {
+            slam.setMapExporter(exporter);
+        }
+    }
+    std::vector<Utils::StampedPose> estimate;
+
+    size_t frames = 0, tracked = 0;
+    Frame f;
+    const auto start = Clock::now();
+    while (opt.maxFrames == 0 || frames < opt.maxFrames) {
+        auto t = Clock::now();
+        if (!source.read(f)) break;
+        latency->add("read", elapsedMs(t));
+        frames++;
+
+        t = Clock::now();
+        const TrackResult res = slam.track(f);
+        latency->add("frame", elapsedMs(t));
+        if (res.ok()) {
+            tracked++;
+            estimate.push_back({seconds(res.timestamp), res.pose});
+        }
+    }
+    const double wall = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (exporter) {
+        slam.setMapExporter(nullptr);
+        if (!opt.mapPly.empty()) exporter->snapshot(*slam.getMap(), opt.mapPly);
+        exporter->close();
+        if (exporter->hasStreamFailed()) std::cerr << "[WARN] Could not write " << opt.mapStream << "\n";
+        if (!opt.mapPly.empty() && !exporter->getSnapshots()) std::cerr << "[WARN] Could not write " << opt.mapPly << "\n";
+    }
+
+    if (!opt.trajectory.empty() && !Utils::TrajectoryEvaluator::saveTUM(opt.trajectory, estimate))
+        std::cerr << "[WARN] Could not write " << opt.trajectory << "\n";
+
+    Utils::TrajectoryErrors errors;
+    bool scored = false;
+    if (!opt.groundTruth.empty()) {
+        std::vector<Utils::StampedPose> gt;
+        if (!Utils::TrajectoryEvaluator::loadTUM(opt.groundTruth, gt)) std::cerr << "[WARN] Could not read " << opt.groundTruth << "\n";
+
+        Utils::TrajectoryEvaluator evaluator;
+        evaluator.setAlignScale(opt.alignScale);
+        evaluator.setRpeDelta(opt.rpeDelta);
+        scored = evaluator.evaluate(estimate, gt, errors);
+    }
+
+    std::ofstream file;
+    if (!opt.report.empty()) file.open(opt.report);
+    std::ostream &out = opt.report.empty() ? std::cout : file;
+
+    out << std::fixed << std::setprecision(6);
+    out << "{\n";
+    out << "  \"source\": \"" << escape(source.name) << "\",\n";
+    out << "  \"frames\": " << frames << ",\n";
+    out << "  \"tracked\": " << tracked << ",\n";
+    const Tracker::MotionGateStats gate = slam.getMotionGateStats();
+    out << "  \"skipped\": " << gate.skipped << ",\n";
+    out << "  \"keyframes\": " << slam.getKeyframeCount() << ",\n";
+    out << "  \"landmarks\": " << slam.getLandmarkCount() << ",\n";
+    out << "  \"throughput\": {\"wall_s\": " << wall << ", \"fps\": " << (wall > 0.0 ? frames / wall : 0.0) << "},\n";
+
+    out << "  \"latency_ms\": {";
+    const auto stages = latency->stages();
+    for (size_t i = 0; i < stages.size(); i++) {
+        const auto s = latency->summary(stages[i]);
+        out << (i ? ",\n" : "\n") << "    \"" << stages[i] << "\": {\"count\": " << s.count << ", \"mean\": " << s.mean
+            << ", \"p50\": " << s.p50 << ", \"p90\": " << s.p90 << ", \"p99\": " << s.p99 << ", \"max\": " << s.max << "}";
+    }
+    out << "\n  },\n";
+    const MapMemory live = slam.getMap()->getMemoryUsage();
+    CompactMap encoded;
+    encoded.build(*slam.getMap());
+    const MapMemory packed = encoded.getMemoryUsage();
+    out << "  \"memory\": {\"peak_rss_kb\": " << Utils::getPeakMemoryKB() << ", \"map_bytes\": " << live.totalBytes()
+        << ", \"bytes_per_landmark\": " << live.bytesPerLandmark() << ", \"bytes_per_keyframe\": " << live.bytesPerKeyframe()
+        << ",\n    \"encoded_bytes\": " << packed.totalBytes() << ", \"encoded_bytes_per_landmark\": " << packed.bytesPerLandmark()
+        << ", \"encoded_bytes_per_keyframe\": " << packed.bytesPerKeyframe() << ",\n    \"subsystems\": {";
+    const auto usage = memory->getUsage();
+    for (size_t i = 0; i < usage.size(); i++) {
+        const MemoryUsage &u = usage[i];
+        out << (i ? ",\n" : "\n") << "      \"" << u.name << "\": {\"bytes\": " << u.bytes << ", \"peak\": " << u.peak
+            << ", \"budget\": " << u.budget << ", \"overruns\": " << u.overruns << "}";
+    }
+    out << "\n    }},\n";
+
+    out << "  \"accuracy\": ";
+    if (!scored) {
+        out << "null\n";
+    } else {
+        out << "{\n    \"matched\": " << errors.matched << ",\n    \"scale\": " << errors.alignment.scale() << ",\n    \"ate_m\": ";
+        writeStats(out, errors.ate);
+        out << ",\n    \"rpe_delta_s\": " << opt.rpeDelta << ",\n    \"rpe_translation_m\": ";
+        writeStats(out, errors.rpeTranslation);
+        out << ",\n    \"rpe_rotation_deg\": ";
+        writeStats(out, errors.rpeRotation);
+        out << "\n  }\n";
+    }
+    out << "}\n";
+    return 0;
+}